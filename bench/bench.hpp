@@ -0,0 +1,33 @@
+#pragma once
+
+// varlisp-bench 的各项测试；不注册为內建函数，不进入主程序。
+// 参数同main()，argv[0]为测试名；结果逐行打印到标准输出，返回值作为退出码。
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace varlisp {
+namespace bench {
+
+typedef int (*bench_func_t)(int argc, char* argv[]);
+
+int json_bench(int argc, char* argv[]);
+int string_bench(int argc, char* argv[]);
+int html2md_bench(int argc, char* argv[]);
+int codec_bench(int argc, char* argv[]);
+int enc_bench(int argc, char* argv[]);
+int read_line_bench(int argc, char* argv[]);
+
+using clock_t = std::chrono::steady_clock;
+
+inline double to_ms(clock_t::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// 读取整个文件；失败时抛出std::runtime_error
+std::string read_file(const std::string& path);
+
+} // namespace bench
+} // namespace varlisp
@@ -0,0 +1,72 @@
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "bench.hpp"
+
+namespace {
+
+struct bench_entry_t {
+    const char*                  name;
+    const char*                  usage;
+    varlisp::bench::bench_func_t func;
+};
+
+const bench_entry_t bench_entries[] = {
+    {"json", "json file.json [times]", varlisp::bench::json_bench},
+    {"string", "string [bytes [times]]", varlisp::bench::string_bench},
+    {"html2md", "html2md file.html [times]", varlisp::bench::html2md_bench},
+    {"codec", "codec gzip|zstd file [level [threads]]", varlisp::bench::codec_bench},
+    {"enc", "enc [bytes [times]]", varlisp::bench::enc_bench},
+    {"read-line", "read-line file", varlisp::bench::read_line_bench},
+};
+
+void usage(const char* prog)
+{
+    std::cerr << "usage:" << std::endl;
+    for (const auto& e : bench_entries) {
+        std::cerr << "  " << prog << " " << e.usage << std::endl;
+    }
+}
+
+} // namespace
+
+namespace varlisp {
+namespace bench {
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream ifs(path.c_str(), std::ios_base::binary);
+    if (!ifs.good()) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    return std::string(std::istreambuf_iterator<char>(ifs),
+                       std::istreambuf_iterator<char>());
+}
+
+} // namespace bench
+} // namespace varlisp
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (const auto& e : bench_entries) {
+        if (std::strcmp(e.name, argv[1]) == 0) {
+            try {
+                return e.func(argc - 1, argv + 1);
+            }
+            catch (std::exception& ex) {
+                std::cerr << argv[1] << ": " << ex.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+    usage(argv[0]);
+    return 1;
+}
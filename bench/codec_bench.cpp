@@ -0,0 +1,87 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "bench.hpp"
+
+#include "detail/codec.hpp"
+
+namespace varlisp {
+namespace bench {
+
+// 压缩算法的吞吐：对file的内容压缩、解压各一次，并校验结果；
+// level、threads 同gzip-stream、zstd-stream
+int codec_bench(int argc, char* argv[])
+{
+    namespace codec = varlisp::detail::codec;
+    if (argc < 3) {
+        std::cerr << "codec: need gzip|zstd and file" << std::endl;
+        return 1;
+    }
+    const bool is_zstd = std::strcmp(argv[1], "zstd") == 0;
+    if (!is_zstd && std::strcmp(argv[1], "gzip") != 0) {
+        std::cerr << "codec: codec must be gzip or zstd; but " << argv[1] << std::endl;
+        return 1;
+    }
+    const std::string data = read_file(argv[2]);
+
+    codec::gzip_option_t gzip_opt;
+    int zstd_level = codec::zstd_default_level();
+    if (argc >= 4) {
+        const int level = std::atoi(argv[3]);
+        const bool valid = is_zstd
+                               ? (level >= codec::zstd_min_level() && level <= codec::zstd_max_level())
+                               : (level >= 0 && level <= 9);
+        if (!valid) {
+            std::cerr << "codec: level out of range; " << argv[3] << std::endl;
+            return 1;
+        }
+        (is_zstd ? zstd_level : gzip_opt.level) = level;
+    }
+    const size_t threads = argc >= 5 ? size_t(std::atoll(argv[4])) : 0;
+    gzip_opt.threads = threads;
+
+    std::string compressed;
+    std::string decompressed;
+    auto beg = clock_t::now();
+    if (is_zstd) {
+        codec::zstd_compress(codec::memory_source(data), codec::memory_sink(compressed),
+                             zstd_level, threads);
+    }
+    else {
+        codec::gzip_compress(codec::memory_source(data), codec::memory_sink(compressed), gzip_opt);
+    }
+    const double compress_ms = to_ms(clock_t::now() - beg);
+
+    decompressed.reserve(data.size());
+    beg = clock_t::now();
+    if (is_zstd) {
+        codec::zstd_decompress(codec::memory_source(compressed), codec::memory_sink(decompressed));
+    }
+    else {
+        codec::gzip_decompress(codec::memory_source(compressed), codec::memory_sink(decompressed));
+    }
+    const double decompress_ms = to_ms(clock_t::now() - beg);
+
+    if (decompressed != data) {
+        std::cerr << "codec: " << argv[1] << " round trip mismatch" << std::endl;
+        return 1;
+    }
+
+    const double mb = double(data.size()) / 1e6;
+    std::cout << "bytes " << data.size() << "\n"
+              << "compressed " << compressed.size() << "\n"
+              << "ratio " << (data.empty() ? 0.0 : double(compressed.size()) / double(data.size())) << "\n"
+              << "compress-ms " << compress_ms << "\n"
+              << "compress-mbps " << (compress_ms > 0 ? mb * 1000.0 / compress_ms : 0.0) << "\n"
+              << "decompress-ms " << decompress_ms << "\n"
+              << "decompress-mbps " << (decompress_ms > 0 ? mb * 1000.0 / decompress_ms : 0.0)
+              << std::endl;
+    return 0;
+}
+
+} // namespace bench
+} // namespace varlisp
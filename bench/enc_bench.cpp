@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "detail/enc_kernel.hpp"
+#include "detail/string_kernel.hpp"
+
+namespace varlisp {
+namespace bench {
+
+namespace {
+
+namespace enckernel = varlisp::detail::enckernel;
+namespace strkernel = varlisp::detail::strkernel;
+
+// 各项耗时(毫秒)与吞吐(MB/s，按原文字节数计)，打印为一行；输出缓冲区在各次间复用；
+// 编解码结果不一致时返回false
+bool enc_bench_one(const std::string& data, int64_t times, strkernel::isa_t isa)
+{
+    strkernel::set_isa(isa);
+
+    std::string base64;
+    std::string hex;
+    std::string decoded;
+    enckernel::base64_encode(base64, data, enckernel::alphabet_std);
+    enckernel::hex_encode(hex, data);
+
+    auto start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        base64.clear();
+        enckernel::base64_encode(base64, data, enckernel::alphabet_std);
+    }
+    const double en_base64_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        decoded.clear();
+        enckernel::base64_decode(decoded, base64, enckernel::alphabet_std);
+    }
+    const double de_base64_ms = to_ms(clock_t::now() - start);
+    if (decoded != data) {
+        std::cerr << "enc: base64 round trip mismatch; isa " << strkernel::isa_name(isa) << std::endl;
+        return false;
+    }
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        hex.clear();
+        enckernel::hex_encode(hex, data);
+    }
+    const double en_hex_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        decoded.clear();
+        enckernel::hex_decode(decoded, hex);
+    }
+    const double de_hex_ms = to_ms(clock_t::now() - start);
+    if (decoded != data) {
+        std::cerr << "enc: hex round trip mismatch; isa " << strkernel::isa_name(isa) << std::endl;
+        return false;
+    }
+
+    const double total_mb = double(data.size()) * double(times) / 1e6;
+    auto mbps = [total_mb](double ms) { return ms > 0 ? total_mb * 1000.0 / ms : 0.0; };
+
+    std::cout << data.size() << '\t' << strkernel::isa_name(isa) << '\t' << times
+              << '\t' << en_base64_ms << '\t' << de_base64_ms
+              << '\t' << en_hex_ms << '\t' << de_hex_ms
+              << '\t' << mbps(en_base64_ms) << '\t' << mbps(de_base64_ms)
+              << '\t' << mbps(en_hex_ms) << '\t' << mbps(de_hex_ms) << std::endl;
+    return true;
+}
+
+} // namespace
+
+// base64、hex 编解码的耗时(毫秒)与吞吐(MB/s)；
+// 对当前CPU支持的每种实现(scalar、sse2、avx2)，分别重复times次；
+// 不指定bytes时，依次测试1KB、64KB、1MB、16MB；
+// times默认按256MB总量折算，至少1次
+int enc_bench(int argc, char* argv[])
+{
+    std::vector<int64_t> sizes{1LL << 10, 64LL << 10, 1LL << 20, 16LL << 20};
+    if (argc >= 2) {
+        const int64_t bytes = std::atoll(argv[1]);
+        if (bytes <= 0) {
+            std::cerr << "enc: bytes must be positive; but " << argv[1] << std::endl;
+            return 1;
+        }
+        sizes.assign(1, bytes);
+    }
+    const int64_t times = argc >= 3 ? std::atoll(argv[2]) : 0;
+
+    std::cout << "bytes\tisa\ttimes\ten_base64_ms\tde_base64_ms\ten_hex_ms\tde_hex_ms"
+                 "\ten_base64_mbps\tde_base64_mbps\ten_hex_mbps\tde_hex_mbps"
+              << std::endl;
+    bool ok = true;
+    for (auto bytes : sizes) {
+        // 伪随机字节；覆盖全部取值
+        std::string data(size_t(bytes), '\0');
+        uint32_t seed = 2166136261U;
+        for (auto& c : data) {
+            seed = seed * 1664525U + 1013904223U;
+            c = char(seed >> 24);
+        }
+        const int64_t n =
+            times > 0 ? times : std::max<int64_t>(1, (256LL << 20) / bytes);
+        for (int isa = strkernel::isa_scalar; ok && isa <= strkernel::best_isa(); ++isa) {
+            ok = enc_bench_one(data, n, strkernel::isa_t(isa));
+        }
+    }
+    strkernel::set_isa(strkernel::best_isa());
+    return ok ? 0 : 1;
+}
+
+} // namespace bench
+} // namespace varlisp
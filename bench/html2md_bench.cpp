@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "bench.hpp"
+
+#include "gumboNode.hpp"
+#include "detail/html2md.hpp"
+
+namespace varlisp {
+namespace bench {
+
+// file.html 解析(gumbo)、转换(html2md) 各times次；dps 为每秒文档数
+int html2md_bench(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "html2md: need file.html" << std::endl;
+        return 1;
+    }
+    const std::string html = read_file(argv[1]);
+    const int times = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+    auto start = clock_t::now();
+    for (int i = 0; i < times; ++i) {
+        gumboNode doc{std::string(html)};
+    }
+    const double parse_ms = to_ms(clock_t::now() - start);
+
+    gumboNode doc{std::string(html)};
+    size_t md_bytes = 0;
+    start = clock_t::now();
+    for (int i = 0; i < times; ++i) {
+        md_bytes = detail::html2md::convert(doc).size();
+    }
+    const double convert_ms = to_ms(clock_t::now() - start);
+
+    auto dps = [&](double ms) { return ms > 0 ? double(times) * 1000.0 / ms : 0.0; };
+
+    std::cout << "html-bytes " << html.size() << "\n"
+              << "md-bytes " << md_bytes << "\n"
+              << "times " << times << "\n"
+              << "parse-ms " << parse_ms << "\n"
+              << "convert-ms " << convert_ms << "\n"
+              << "parse-dps " << dps(parse_ms) << "\n"
+              << "convert-dps " << dps(convert_ms) << "\n"
+              << "total-dps " << dps(parse_ms + convert_ms) << std::endl;
+    return 0;
+}
+
+} // namespace bench
+} // namespace varlisp
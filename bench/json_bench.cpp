@@ -0,0 +1,52 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/variant.hpp>
+
+#include "bench.hpp"
+
+#include "json/parser.hpp"
+#include "json/writer.hpp"
+#include "json_print_visitor.hpp"
+
+namespace varlisp {
+namespace bench {
+
+// json序列化的耗时(毫秒)：json_print_visitor(std::ostream) 对比 json::Writer；
+// 各自重复序列化 file.json 解析出的对象 times 次(默认100)
+int json_bench(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "json: need file.json" << std::endl;
+        return 1;
+    }
+    const std::string content = read_file(argv[1]);
+    const Object obj = json::parse(content);
+    const int64_t times = argc >= 3 ? std::atoll(argv[2]) : 100;
+
+    size_t visitor_bytes = 0;
+    auto start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        std::ostringstream oss;
+        boost::apply_visitor(json_print_visitor(oss, false), obj);
+        visitor_bytes += oss.str().size();
+    }
+    const double visitor_ms = to_ms(clock_t::now() - start);
+
+    size_t writer_bytes = 0;
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        writer_bytes += json::to_string(obj, false).size();
+    }
+    const double writer_ms = to_ms(clock_t::now() - start);
+
+    std::cout << "times " << times << "\n"
+              << "visitor-ms " << visitor_ms << " (" << visitor_bytes << " bytes)\n"
+              << "writer-ms " << writer_ms << " (" << writer_bytes << " bytes)" << std::endl;
+    return 0;
+}
+
+} // namespace bench
+} // namespace varlisp
@@ -0,0 +1,86 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "bench.hpp"
+
+#include "detail/buffered_reader.hpp"
+#include "detail/file.hpp"
+#include "detail/io.hpp"
+
+namespace varlisp {
+namespace bench {
+
+namespace {
+
+int open_path(const char* path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error(std::string("open `") + path + "` failed; " + std::strerror(errno));
+    }
+    return fd;
+}
+
+} // namespace
+
+// 对比逐字节read(2)与读缓冲，读完file各行的速度；lps 为每秒行数
+int read_line_bench(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "read-line: need file" << std::endl;
+        return 1;
+    }
+
+    // 逐字节：detail::readline() 在文件结尾返回空串，以文件偏移判断是否读完
+    int fd = open_path(argv[1]);
+    const int64_t fsize = ::lseek(fd, 0, SEEK_END);
+    ::lseek(fd, 0, SEEK_SET);
+    int64_t unbuffered_lines = 0;
+    auto start = clock_t::now();
+    while (::lseek(fd, 0, SEEK_CUR) < fsize) {
+        detail::readline(fd);
+        ++unbuffered_lines;
+    }
+    const double unbuffered_ms = to_ms(clock_t::now() - start);
+    ::close(fd);
+
+    fd = open_path(argv[1]);
+    int64_t buffered_lines = 0;
+    start = clock_t::now();
+    {
+        detail::buffered_reader_t reader(fd, detail::file::reader_buffer_size());
+        sss::string_view line;
+        while (reader.next_line(line)) {
+            ++buffered_lines;
+        }
+    }
+    const double buffered_ms = to_ms(clock_t::now() - start);
+    ::close(fd);
+
+    if (unbuffered_lines != buffered_lines) {
+        std::cerr << "read-line: line count mismatch; " << unbuffered_lines << " vs "
+                  << buffered_lines << std::endl;
+        return 1;
+    }
+    auto lps = [&](double ms) {
+        return ms > 0 ? double(buffered_lines) * 1000.0 / ms : 0.0;
+    };
+
+    std::cout << "lines " << buffered_lines << "\n"
+              << "unbuffered-ms " << unbuffered_ms << "\n"
+              << "buffered-ms " << buffered_ms << "\n"
+              << "unbuffered-lps " << lps(unbuffered_ms) << "\n"
+              << "buffered-lps " << lps(buffered_ms) << std::endl;
+    return 0;
+}
+
+} // namespace bench
+} // namespace varlisp
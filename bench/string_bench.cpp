@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sss/string_view.hpp>
+
+#include "bench.hpp"
+
+#include "detail/string_kernel.hpp"
+
+namespace varlisp {
+namespace bench {
+
+namespace {
+
+namespace strkernel = varlisp::detail::strkernel;
+
+// 混合ASCII单词、分隔符、中文的文本；needle只出现在末尾
+std::string gen_bench_text(size_t bytes, sss::string_view needle)
+{
+    static const char * const words[] = {
+        "alpha", "beta,", "gamma ", "\xe4\xb8\xad\xe6\x96\x87", "delta\t",
+        "epsilon, ", "\xe5\xad\x97\xe7\xac\xa6\xe4\xb8\xb2 ", "zeta",
+    };
+    std::string text;
+    text.reserve(bytes + 64);
+    for (size_t i = 0; text.size() + needle.size() < bytes; ++i) {
+        text += words[(i * 7 + i / 3) % (sizeof(words) / sizeof(words[0]))];
+        text += ' ';
+    }
+    text.resize(bytes > needle.size() ? bytes - needle.size() : 0);
+    // 避免截断出不完整的utf8序列
+    while (!text.empty() && static_cast<unsigned char>(text.back()) >= 0x80U) {
+        text.back() = ' ';
+    }
+    text.append(needle.data(), needle.size());
+    return text;
+}
+
+// 各项耗时(毫秒)，打印为一行
+void string_bench_one(const std::string& text, const std::string& blank,
+                      sss::string_view needle, int64_t times,
+                      strkernel::isa_t isa)
+{
+    strkernel::set_isa(isa);
+    size_t sink = 0;
+
+    auto start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        sss::string_view rest(text);
+        while (!rest.empty()) {
+            size_t pos = strkernel::find_char(rest, ',');
+            if (pos == strkernel::npos) {
+                break;
+            }
+            ++sink;
+            rest = rest.substr(pos + 1);
+        }
+    }
+    const double find_char_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        sink += strkernel::find(text, needle);
+        sink += strkernel::rfind(text, sss::string_view("alphx"));
+    }
+    const double strstr_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        sink += strkernel::space_prefix(blank);
+        sink += strkernel::space_suffix(blank);
+    }
+    const double trim_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        sink += strkernel::utf8_count(text);
+    }
+    const double strlen_ms = to_ms(clock_t::now() - start);
+
+    start = clock_t::now();
+    for (int64_t i = 0; i < times; ++i) {
+        sink += strkernel::utf8_valid(text) ? 1 : 0;
+    }
+    const double valid_ms = to_ms(clock_t::now() - start);
+
+    std::cout << text.size() << '\t' << strkernel::isa_name(isa) << '\t' << times
+              << '\t' << find_char_ms << '\t' << strstr_ms << '\t' << trim_ms
+              << '\t' << strlen_ms << '\t' << valid_ms << '\t' << (sink & 1U)
+              << std::endl;
+}
+
+} // namespace
+
+// 字符串核心扫描(detail::strkernel)的耗时(毫秒)；
+// 对当前CPU支持的每种实现(scalar、sse2、avx2)，分别重复times次；
+// 不指定bytes时，依次测试1KB、64KB、1MB、16MB、100MB；
+// times默认按256MB总量折算，至少1次
+int string_bench(int argc, char* argv[])
+{
+    std::vector<int64_t> sizes{1LL << 10, 64LL << 10, 1LL << 20, 16LL << 20, 100LL << 20};
+    if (argc >= 2) {
+        const int64_t bytes = std::atoll(argv[1]);
+        if (bytes <= 0) {
+            std::cerr << "string: bytes must be positive; but " << argv[1] << std::endl;
+            return 1;
+        }
+        sizes.assign(1, bytes);
+    }
+    const int64_t times = argc >= 3 ? std::atoll(argv[2]) : 0;
+
+    const sss::string_view needle("needle!");
+    std::cout << "bytes\tisa\ttimes\tfind_char_ms\tstrstr_ms\ttrim_ms\tstrlen_ms\tutf8_valid_ms\tsink"
+              << std::endl;
+    for (auto bytes : sizes) {
+        const std::string text = gen_bench_text(bytes, needle);
+        std::string blank(bytes, ' ');
+        blank[bytes / 2] = 'x';
+        const int64_t n =
+            times > 0 ? times : std::max<int64_t>(1, (256LL << 20) / bytes);
+        for (int isa = strkernel::isa_scalar; isa <= strkernel::best_isa(); ++isa) {
+            string_bench_one(text, blank, needle, n, strkernel::isa_t(isa));
+        }
+    }
+    strkernel::set_isa(strkernel::best_isa());
+    return 0;
+}
+
+} // namespace bench
+} // namespace varlisp
@@ -20,6 +20,7 @@
 #include "src/interpreter.hpp"
 #include "src/tokenizer.hpp"
 #include "src/String.hpp"
+#include "src/detail/heap_image.hpp"
 
 //http://stackoverflow.com/questions/6364681/how-to-handle-control-c-in-a-boost-tcp-udp-server
 #include <signal.h> // or <csignal> in C++
@@ -125,10 +126,25 @@ const char * gen_prompt_continue(varlisp::Interpreter& i)
 }
 
 int Interpret(bool echo_in_load, bool quit_on_load_complete,
-              bool load_init_script, int argc, char* argv[])
+              bool load_init_script, const std::string& image_path,
+              int argc, char* argv[])
 {
     varlisp::Interpreter& interpreter = varlisp::Interpreter::get_instance();
 
+    // NOTE 镜像先于初始化脚本载入；脚本中的定义，可以覆盖镜像
+    if (!image_path.empty()) {
+        std::string full_path = sss::path::full_of_copy(image_path);
+        // NOTE 镜像损坏、版本不符时，restore不会改动env；报错后，按全新的环境继续
+        try {
+            auto cnt = varlisp::detail::image::restore(interpreter.get_env(), full_path);
+            COLOG_INFO("(image", sss::raw_string(full_path), cnt, "items restored)");
+        }
+        catch (const std::exception& e) {
+            std::cerr << "image " << sss::raw_string(full_path)
+                      << " not restored: " << e.what() << std::endl;
+        }
+    }
+
     if (load_init_script) {
         std::string preload_script = sss::path::dirname(sss::path::getbin());
         sss::path::append(preload_script, "init.varlisp");
@@ -291,6 +307,7 @@ void help_msg()
         << app << " [(--echo | -e) (1 | 0)]\n"
         << "\t\t" << " [--quit | -q]\n"
         << "\t\t" << " [--init | -i]\n"
+        << "\t\t" << " [(--image | -m) /path/to/image]\n"
         << "\t\t" << " [/path/to/script]\n\n"
         << "\t" << " 如果不提供脚步路径的话，则直接进入交互模式；"
         << "\t" << "-q "
@@ -350,6 +367,7 @@ int main(int argc, char* argv[])
     sss::CMLParser::RuleSingleValue cp_init;
     sss::CMLParser::RuleSingleValue cp_no_init;
     sss::CMLParser::RuleSingleValue cp_help;
+    sss::CMLParser::RuleSingleValue cp_image;
 
     sss::CMLParser::Exclude cmlparser;
 
@@ -365,6 +383,9 @@ int main(int argc, char* argv[])
     cmlparser.add_rule("--no-init", sss::CMLParser::ParseBase::r_option, cp_no_init);
     cmlparser.add_rule("-n",        sss::CMLParser::ParseBase::r_option, cp_no_init);
 
+    cmlparser.add_rule("--image",   sss::CMLParser::ParseBase::r_parameter, cp_image);
+    cmlparser.add_rule("-m",        sss::CMLParser::ParseBase::r_parameter, cp_image);
+
     cmlparser.add_rule("--help",    sss::CMLParser::ParseBase::r_option, cp_help);
     cmlparser.add_rule("-h",        sss::CMLParser::ParseBase::r_option, cp_help);
 
@@ -373,6 +394,7 @@ int main(int argc, char* argv[])
     bool echo_in_load          = false;
     bool quit_on_load_complete = false;
     bool load_init_script      = true;
+    std::string image_path;
 
     if (cp_echo.size()) {
         echo_in_load = bool(sss::string_cast<int>(cp_echo.get(0)));
@@ -390,6 +412,10 @@ int main(int argc, char* argv[])
         load_init_script = false;
     }
 
+    if (cp_image.size()) {
+        image_path = cp_image.get(0);
+    }
+
     if (cp_help.size()) {
         help_msg();
         return EXIT_SUCCESS;
@@ -401,6 +427,7 @@ int main(int argc, char* argv[])
     return Interpret(echo_in_load,
                      quit_on_load_complete,
                      load_init_script,
+                     image_path,
                      argc - 1, argv + 1);
 #elif (CONDTION==2)
     return test_construct();
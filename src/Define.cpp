@@ -8,6 +8,7 @@
 #include "builtin_helper.hpp"
 
 #include "environment.hpp"
+#include "detail/buitin_info_t.hpp"
 
 namespace varlisp {
 void Define::print(std::ostream& o) const
@@ -28,7 +29,10 @@ Object Define::eval(Environment& env) const
     // 这里与一般的语义不符，需要修改。
     // 但是，后续赋值的时候，又使用的是operator[] ——这个是json-accessor版的！
     // 两者矛盾。
-    if (top_env->find(this->name.name())) {
+    // NOTE 内建函数不在top_env的map中，须另外检查
+    if (top_env->find(this->name.name()) ||
+        detail::find_builtin(this->name.name()) >= 0)
+    {
         Object tmp;
         const auto& forceRefer = getAtomicValue(env, this->force_rewrite, tmp);
         bool force = boost::apply_visitor(cast2bool_visitor(env), forceRefer);
@@ -1,15 +1,123 @@
 #include "String.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 
 #include <sss/colorlog.hpp>
 
+#include "detail/string_kernel.hpp"
+
 namespace varlisp {
 
+namespace {
+
+// 驻留池；值为weak_ptr，不延长字符串的生命期；
+// 键指向池中std::string的内容，随其一起释放。
+struct intern_pool_t
+{
+    std::mutex                                                   m_mutex;
+    std::unordered_map<std::string_view, std::weak_ptr<string_buffer_t>> m_items;
+};
+
+intern_pool_t& intern_pool()
+{
+    // NOTE 故意不析构：全局环境中的驻留串，可能晚于静态对象释放
+    static auto * pool = new intern_pool_t;
+    return *pool;
+}
+
+struct intern_deleter_t
+{
+    void operator()(string_buffer_t* p) const
+    {
+        auto& pool = intern_pool();
+        {
+            std::lock_guard<std::mutex> lock(pool.m_mutex);
+            auto it = pool.m_items.find(std::string_view(p->text.data(), p->text.size()));
+            // NOTE 可能已被同内容的新串替换
+            if (it != pool.m_items.end() && it->second.expired()) {
+                pool.m_items.erase(it);
+            }
+        }
+        delete p;
+    }
+};
+
+}  // namespace
+
+String String::intern(sss::string_view s)
+{
+    if (s.empty()) {
+        return String{};
+    }
+    // NOTE 短串存放在对象内部即可，不必进池——进池反而要一次堆分配
+    if (s.size() <= local_capacity) {
+        String ret;
+        ret.destroy();
+        ret.init_local(s);
+        return ret;
+    }
+    auto& pool = intern_pool();
+    std::lock_guard<std::mutex> lock(pool.m_mutex);
+    auto it = pool.m_items.find(std::string_view(s.data(), s.size()));
+    if (it != pool.m_items.end()) {
+        if (auto ref = it->second.lock()) {
+            return String{sss::string_view(ref->text), ref};
+        }
+        pool.m_items.erase(it);
+    }
+    std::shared_ptr<string_buffer_t> ref(
+        new string_buffer_t(std::string(s.data(), s.size())), intern_deleter_t{});
+    pool.m_items.emplace(std::string_view(ref->text.data(), ref->text.size()), ref);
+    return String{sss::string_view(ref->text), ref};
+}
+
+String String::external(sss::string_view s, std::shared_ptr<const void> owner)
+{
+    if (s.size() <= local_capacity) {
+        String ret;
+        if (!s.empty()) {
+            ret.destroy();
+            ret.init_local(s);
+        }
+        return ret;
+    }
+    return String{s, std::make_shared<string_buffer_t>(s, std::move(owner))};
+}
+
+// NOTE share()得到的子串，仍引用驻留缓冲区，但不是驻留串本身；
+// 须覆盖整个缓冲区，否则operator==的指针比较，会把不同偏移的等值子串判为不等
+bool String::is_interned() const
+{
+    return !this->is_local() && this->m_refer &&
+           std::get_deleter<intern_deleter_t>(this->m_refer) != nullptr &&
+           this->data() == this->m_refer->text.data() &&
+           this->size() == this->m_refer->text.size();
+}
+
+String String::share(sss::string_view sub) const
+{
+    if (sub.empty()) {
+        return String{};
+    }
+    if (this->is_local()) {
+        String ret;
+        ret.destroy();
+        ret.init_local(sub);
+        return ret;
+    }
+    return String{sub, m_refer};
+}
+
 std::shared_ptr<std::string> String::gen_shared() const
 {
-    if (this->m_refer && this->data() == this->m_refer->data() && this->size() == this->m_refer->size()) {
-        return this->m_refer;
+    if (!this->is_local() && this->m_refer &&
+        this->data() == this->m_refer->text.data() && this->size() == this->m_refer->text.size()) {
+        // NOTE 别名构造：与缓冲区共享所有权，不复制
+        return std::shared_ptr<std::string>(this->m_refer, &this->m_refer->text);
     }
     return std::make_shared<std::string>(this->to_string());
 }
@@ -17,18 +125,30 @@ std::shared_ptr<std::string> String::gen_shared() const
 String& String::operator=(const std::string& s)
 {
     this->clear();
-    if (!s.empty()) {
-        this->m_refer = std::make_shared<std::string>(s);
-        sss::string_view::operator=(*m_refer);
+    if (s.size() <= local_capacity) {
+        if (!s.empty()) {
+            this->destroy();
+            this->init_local(s);
+        }
+    }
+    else {
+        this->m_refer = std::make_shared<string_buffer_t>(s);
+        sss::string_view::operator=(m_refer->text);
     }
     return *this;
 }
 String& String::operator=(std::string&& s)
 {
     this->clear();
-    if (!s.empty()) {
-        this->m_refer = std::make_shared<std::string>(std::move(s));
-        sss::string_view::operator=(*m_refer);
+    if (s.size() <= local_capacity) {
+        if (!s.empty()) {
+            this->destroy();
+            this->init_local(s);
+        }
+    }
+    else {
+        this->m_refer = std::make_shared<string_buffer_t>(std::move(s));
+        sss::string_view::operator=(m_refer->text);
     }
     return *this;
 }
@@ -36,8 +156,11 @@ String& String::operator=(std::string&& s)
 // 判断是否以end结尾——即，
 const char * String::safe_c_str() const
 {
+    if (this->is_local()) {
+        return this->data();
+    }
     if (this->m_refer &&
-        this->m_refer->c_str() + this->m_refer->size() ==
+        this->m_refer->text.c_str() + this->m_refer->text.size() ==
             this->data() + this->size())
     {
         return this->data();
@@ -45,6 +168,132 @@ const char * String::safe_c_str() const
     return nullptr;
 }
 
+namespace {
+
+std::unique_ptr<utf8_index_t> build_utf8_index(sss::string_view text)
+{
+    namespace strkernel = varlisp::detail::strkernel;
+    auto index = std::make_unique<utf8_index_t>();
+    const sss::string_view s(text);
+    if (!strkernel::utf8_valid(s)) {
+        return index;
+    }
+    index->is_valid = true;
+    if (strkernel::ascii_prefix(s) == s.size()) {
+        index->is_ascii = true;
+        index->count = s.size();
+        return index;
+    }
+    index->marks.reserve(s.size() / utf8_index_t::stride + 1);
+    size_t count = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if ((static_cast<unsigned char>(text.data()[i]) & 0xC0U) == 0x80U) {
+            continue;
+        }
+        if (count % utf8_index_t::stride == 0) {
+            index->marks.push_back(i);
+        }
+        ++count;
+    }
+    index->count = count;
+    return index;
+}
+
+// 合法utf8中，首字节对应的序列长度
+inline size_t utf8_lead_length(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return u < 0x80U ? 1 : u < 0xE0U ? 2 : u < 0xF0U ? 3 : 4;
+}
+
+// 字节偏移off之前的码点数
+size_t index_cp_of(const utf8_index_t& index, sss::string_view text, size_t off)
+{
+    auto it = std::upper_bound(index.marks.begin(), index.marks.end(), off);
+    const size_t k = (it - index.marks.begin()) - 1;
+    const size_t from = index.marks[k];
+    return k * utf8_index_t::stride +
+           varlisp::detail::strkernel::utf8_count(
+               sss::string_view(text.data() + from, off - from));
+}
+
+// 第cp个码点的字节偏移；cp不超过index.count
+size_t index_byte_of(const utf8_index_t& index, sss::string_view text, size_t cp)
+{
+    if (cp >= index.count) {
+        return text.size();
+    }
+    const size_t k = cp / utf8_index_t::stride;
+    size_t off = index.marks[k];
+    for (size_t left = cp - k * utf8_index_t::stride; left > 0; --left) {
+        off += utf8_lead_length(text.data()[off]);
+    }
+    return off;
+}
+
+}  // namespace
+
+const utf8_index_t* String::utf8_index() const
+{
+    if (this->is_local() || !this->m_refer ||
+        this->m_refer->content().size() < utf8_index_threshold || !this->own_text()) {
+        return nullptr;
+    }
+    const string_buffer_t* buf = this->m_refer.get();
+    std::call_once(buf->index_once,
+                   [buf]() { buf->index = build_utf8_index(buf->content()); });
+    return buf->index->is_valid ? buf->index.get() : nullptr;
+}
+
+size_t String::utf8_length() const
+{
+    const utf8_index_t* index = this->utf8_index();
+    if (index == nullptr) {
+        return varlisp::detail::strkernel::utf8_count(this->to_string_view());
+    }
+    if (index->is_ascii) {
+        return this->size();
+    }
+    const sss::string_view text = this->m_refer->content();
+    const size_t v0 = this->data() - text.data();
+    if (v0 == 0 && this->size() == text.size()) {
+        return index->count;
+    }
+    return index_cp_of(*index, text, v0 + this->size()) - index_cp_of(*index, text, v0);
+}
+
+size_t String::utf8_offset(size_t nth) const
+{
+    const utf8_index_t* index = this->utf8_index();
+    if (index == nullptr) {
+        const char * p = this->data();
+        const size_t n = this->size();
+        size_t off = 0;
+        for (; nth > 0 && off < n; --nth) {
+            const size_t len = varlisp::detail::strkernel::utf8_seq_len(p + off, n - off);
+            if (len == 0) {
+                return npos;
+            }
+            off += len;
+        }
+        return nth == 0 ? off : npos;
+    }
+    if (index->is_ascii) {
+        return nth <= this->size() ? nth : npos;
+    }
+    const sss::string_view text = this->m_refer->content();
+    const size_t v0 = this->data() - text.data();
+    const size_t cp = index_cp_of(*index, text, v0) + nth;
+    if (cp > index->count) {
+        return npos;
+    }
+    const size_t off = index_byte_of(*index, text, cp);
+    if (off > v0 + this->size()) {
+        return npos;
+    }
+    return off - v0;
+}
+
 void String::print(std::ostream&o) const
 {
     o << static_cast<const sss::string_view&>(*this);
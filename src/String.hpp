@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstring>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
 
 #include <sss/string_view.hpp>
 #include <utility>
@@ -10,33 +15,106 @@
 
 namespace varlisp {
 
+// 稀疏的utf8码点索引：每stride个码点，记录一次字节偏移；
+// 定位第n个码点时，从marks[n/stride]开始，最多前进stride-1个码点。
+struct utf8_index_t {
+    static constexpr size_t stride = 64;
+
+    bool                is_valid = false;   // 非法utf8串，不建立索引
+    bool                is_ascii = false;   // 纯ASCII，码点即字节，无需marks
+    size_t              count    = 0;       // 码点总数
+    std::vector<size_t> marks;              // marks[i]: 第i*stride个码点的字节偏移
+};
+
+// 堆上的字符串缓冲区；同一缓冲区上的各个substr视图，共享utf8索引。
+// 也可以引用外部存储(如mmap的文件)：此时text为空，内容由owner持有，
+// 最后一个视图释放时，owner随之释放。
+struct string_buffer_t {
+    explicit string_buffer_t(std::string s) : text(std::move(s)) {}
+    string_buffer_t(sss::string_view s, std::shared_ptr<const void> o)
+        : external(s), owner(std::move(o))
+    {
+    }
+
+    // 缓冲区的全部内容
+    sss::string_view content() const
+    {
+        return owner ? external : sss::string_view(text);
+    }
+
+    std::string text;
+
+    sss::string_view            external;
+    std::shared_ptr<const void> owner;
+
+    // 首次按码点访问时建立；见String::utf8_offset()
+    mutable std::once_flag                 index_once;
+    mutable std::unique_ptr<utf8_index_t>  index;
+};
+
+// String 带引用计数的字符串视图。
+//
+// 不超过local_capacity字节的短串，直接存放在对象内部(复用m_refer的空间)，
+// 不分配堆内存；此时视图指向m_local。
+// 较长的串，由m_refer持有；substr()共享同一缓冲区。
+// intern()得到的串，相同内容共享同一缓冲区；两个驻留串比较时，只需比较指针。
+// 按码点的定位(utf8_offset)，对较长的缓冲区，使用其上的稀疏索引。
 struct String : public sss::string_view {
 public:
-    String() = default;
-    ~String() = default;
+    static constexpr size_t local_capacity = sizeof(std::shared_ptr<string_buffer_t>) - 1;
+
+    // 短于此长度的缓冲区，直接扫描，不建立索引
+    static constexpr size_t utf8_index_threshold = 256;
 
-    explicit String(const std::string& s)
+    String() : m_refer() {}
+    ~String()
     {
-        if (!s.empty()) {
-            m_refer = std::make_shared<std::string>(s);
-            sss::string_view::operator=(*m_refer);
-        }
+        this->destroy();
+    }
+
+    explicit String(const std::string& s) : m_refer()
+    {
+        *this = s;
+    }
+    explicit String(std::string&& s) : m_refer()
+    {
+        *this = std::move(s);
     }
     template <size_t N>
-    String(const char (&s)[N]) : sss::string_view(s)
+    String(const char (&s)[N]) : sss::string_view(s), m_refer()
     {
     }
 
-    String(const String& ref) = default;
-    String& operator=(const String& ref) = default;
-    String(String&& ref) = default;
-    String& operator=(String&& ref) = default;
+    String(const String& ref) : sss::string_view()
+    {
+        this->init_copy(ref);
+    }
+    String& operator=(const String& ref)
+    {
+        if (this != &ref) {
+            this->destroy();
+            this->init_copy(ref);
+        }
+        return *this;
+    }
+    String(String&& ref) noexcept : sss::string_view()
+    {
+        this->init_move(ref);
+    }
+    String& operator=(String&& ref) noexcept
+    {
+        if (this != &ref) {
+            this->destroy();
+            this->init_move(ref);
+        }
+        return *this;
+    }
 
     String& operator=(const std::string&);
     String& operator=(std::string&&);
 
     String(sss::string_view s, bool  /*unused*/)
-        : sss::string_view(s)
+        : sss::string_view(s), m_refer()
     {
     }
 
@@ -47,8 +125,17 @@ public:
         return *this;
     }
 
+    // 从驻留池获取；相同内容，共享同一缓冲区。
+    // 驻留池不延长生命期——最后一个引用释放时，从池中移除。
+    // 不超过local_capacity的短串，同普通短串，存放在对象内部，不进池。
+    static String intern(sss::string_view s);
+
+    // 外部存储上的视图，不复制；owner 持有s所指的内存，
+    // 随最后一个引用(含substr)释放。短串仍复制到对象内部。
+    static String external(sss::string_view s, std::shared_ptr<const void> owner);
+
 protected:
-    String(sss::string_view s, std::shared_ptr<std::string> ref)
+    String(sss::string_view s, std::shared_ptr<string_buffer_t> ref)
         : sss::string_view(s), m_refer(std::move(ref))
     {
     }
@@ -57,9 +144,13 @@ public:
     std::shared_ptr<std::string> gen_shared() const;
 
     bool own_text() const {
+        if (this->is_local()) {
+            return true;
+        }
         if (this->m_refer) {
-            const char * buf = this->m_refer->data();
-            size_t len = this->m_refer->length();
+            const sss::string_view content = this->m_refer->content();
+            const char * buf = content.data();
+            size_t len = content.size();
             return ((buf != nullptr) && this->data() >= buf && this->data() < (buf + len));
         }
         return false;
@@ -72,24 +163,17 @@ public:
     void print(std::ostream& o) const;
     void clear()
     {
+        this->destroy();
         sss::string_view::clear();
-        m_refer.reset();
+        new (&m_refer) std::shared_ptr<string_buffer_t>();
     }
     String substr(size_t offset) const
     {
-        String ret{sss::string_view::substr(offset), m_refer};
-        if (ret.empty()) {
-            ret.clear();
-        }
-        return ret;
+        return this->share(sss::string_view::substr(offset));
     }
     String substr(size_t offset, size_t len) const
     {
-        String ret{sss::string_view::substr(offset, len), m_refer};
-        if (ret.empty()) {
-            ret.clear();
-        }
-        return ret;
+        return this->share(sss::string_view::substr(offset, len));
     }
 
     String substr(const sss::string_view& s) const
@@ -109,13 +193,91 @@ public:
 
     size_t use_count() const
     {
-        return this->m_refer.use_count();
+        return this->is_local() ? 1 : this->m_refer.use_count();
+    }
+
+    bool is_local() const
+    {
+        return this->data() == m_local;
+    }
+
+    // intern()得到的串；驻留缓冲区上的真子串不算
+    bool is_interned() const;
+
+    // 以码点计的长度；不校验utf8，只统计非后续字节
+    size_t utf8_length() const;
+
+    // 第nth个码点，相对本视图开头的字节偏移；nth等于码点数时，返回size()；
+    // 超出范围，或者遇到非法utf8时，返回npos
+    size_t utf8_offset(size_t nth) const;
+
+private:
+    // 以下init_xxx，调用前m_refer/m_local均处于未构造状态
+    void init_local(sss::string_view s)
+    {
+        std::memcpy(m_local, s.data(), s.size());
+        m_local[s.size()] = '\0';
+        sss::string_view::operator=(sss::string_view(m_local, s.size()));
+    }
+    void init_copy(const String& ref)
+    {
+        if (ref.is_local()) {
+            this->init_local(ref.to_string_view());
+            return;
+        }
+        new (&m_refer) std::shared_ptr<string_buffer_t>(ref.m_refer);
+        sss::string_view::operator=(ref.to_string_view());
+    }
+    void init_move(String& ref)
+    {
+        if (ref.is_local()) {
+            this->init_local(ref.to_string_view());
+            return;
+        }
+        new (&m_refer) std::shared_ptr<string_buffer_t>(std::move(ref.m_refer));
+        sss::string_view::operator=(ref.to_string_view());
+        ref.sss::string_view::clear();
     }
+    void destroy()
+    {
+        if (!this->is_local()) {
+            m_refer.~shared_ptr();
+        }
+    }
+
+    // 同缓冲区上的子串；短串则复制到对象内部
+    String share(sss::string_view sub) const;
+
+    // 可用时，返回所在缓冲区的utf8索引(按需建立)；否则返回nullptr
+    const utf8_index_t* utf8_index() const;
 
 private:
-    std::shared_ptr<std::string> m_refer;
+    union {
+        std::shared_ptr<string_buffer_t> m_refer;
+        char                         m_local[local_capacity + 1];
+    };
 };
 
+// 长度不同，或者两个驻留串的指针不同，都不必比较内容
+inline bool operator==(const String& lhs, const String& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    if (lhs.data() == rhs.data()) {
+        return true;
+    }
+    if (lhs.is_interned() && rhs.is_interned()) {
+        return false;
+    }
+    return std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+inline bool operator!=(const String& lhs, const String& rhs)
+{
+    return !(lhs == rhs);
+}
+
 using string_t = String;
 
 inline std::ostream& operator<<(std::ostream& o, const String& s)
@@ -14,17 +14,13 @@ namespace varlisp {
 
 typedef Object (*eval_func_t)(varlisp::Environment& env, const varlisp::List& args);
 
-// 既然有常量的存在，那么我干脆……
-// 将常亮孤立到额外的全局的map、vector变量中；
-// 然后，让Environment，在按名字取Object对象的时候，
-// 先询问这些全局对象。
+// NOTE 内建函数本身不再插入env；Environment::deep_find()在环境链上都找不到时，
+// 由 detail::find_builtin_object() 按完美hash表查找。
+// 这里只注册常量。
 void Builtin::regist_builtin_function(Environment& env)
 {
-    const std::vector<varlisp::detail::builtin_info_t>& info_vec
-        = varlisp::detail::get_builtin_infos();
-    for (size_t i = 0; i != info_vec.size() ; ++i) {
-        env.insert(info_vec[i].name, varlisp::Builtin(i), true);
-    }
+    // 启动时即建立完美hash表；内建函数重名、hash冲突，在此报错
+    varlisp::detail::find_builtin("");
 #define CONSTANT_INT(i) (env.insert(#i, varlisp::Object{int64_t(i)}, true))
     CONSTANT_INT(O_RDONLY);
     CONSTANT_INT(O_WRONLY);
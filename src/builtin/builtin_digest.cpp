@@ -1,17 +1,85 @@
-#include <sss/path.hpp>
-#include <sss/utlstring.hpp>
+#include <array>
+#include <vector>
 
-#include <ss1x/uuid/sha1.hpp>
+#include <sss/path.hpp>
 
 #include "../builtin_helper.hpp"
 #include "../object.hpp"
 
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
+#include "../detail/digest.hpp"
+#include "../detail/enc_kernel.hpp"
 #include "../environment.hpp"
 
 namespace varlisp {
 
+namespace detail {
+
+// "algo" 或者 '("algo"...)；单个算法时，返回true
+inline bool parseDigestAlgos(varlisp::Environment& env, const Object& arg, Object& tmp,
+                             const char* funcName, int index,
+                             std::vector<digest::algo_t>& algos)
+{
+    auto parse_one = [&](const varlisp::string_t& name) {
+        digest::algo_t algo;
+        if (!digest::parse_algo(name.to_string_view(), algo)) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": unknown digest `", name,
+                               "`; support md5 sha1 sha256 xxh64 xxh3 blake3)");
+        }
+        algos.push_back(algo);
+    };
+
+    const Object& ref = getAtomicValue(env, arg, tmp);
+    if (const auto* p_name = boost::get<varlisp::string_t>(&ref)) {
+        parse_one(*p_name);
+        return true;
+    }
+    const varlisp::List* p_list = varlisp::getQuotedList(env, arg, tmp);
+    if (p_list == nullptr) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": need digest name or quote list as ",
+                           readableIndex(index), " argument; but ", ref, ")");
+    }
+    for (const auto& it : *p_list) {
+        Object item_tmp;
+        const auto* p_name = getTypedValue<varlisp::string_t>(env, it, item_tmp);
+        if (p_name == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": digest name must be string; but ", it, ")");
+        }
+        parse_one(*p_name);
+    }
+    if (algos.empty()) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": empty digest list)");
+    }
+    return false;
+}
+
+inline varlisp::string_t toHexString(const std::string& bytes)
+{
+    std::string out;
+    enckernel::hex_encode(out, bytes);
+    varlisp::string_t ret;
+    ret = std::move(out);
+    return ret;
+}
+
+// 单个算法：十六进制串；多个：{algo "hex"...}
+inline Object digestsToObject(const std::vector<digest::algo_t>& algos,
+                              const std::vector<std::string>& digests, bool is_single)
+{
+    if (is_single) {
+        return toHexString(digests.front());
+    }
+    varlisp::Environment ret;
+    for (size_t i = 0; i < algos.size(); ++i) {
+        ret[digest::algo_name(algos[i])] = toHexString(digests[i]);
+    }
+    return Object(std::move(ret));
+}
+
+}  // namespace detail
+
 REGIST_BUILTIN("digest-sha1-file", 1, 1, eval_digest_sha1_file,
                "(digest-sha1-file \"path/to/file\") -> \"sha1-string\" | nil");
 
@@ -24,7 +92,9 @@ Object eval_digest_sha1_file(varlisp::Environment& env,
         env, detail::car(args), tmp, funcName, 0, DEBUG_INFO);
     try {
         std::string path = sss::path::full_of_copy(*p_fname->gen_shared());
-        return string_t(ss1x::uuid::sha1::fromFile(path));
+        auto digests = detail::digest::digest_file(path, {detail::digest::algo_sha1});
+        // NOTE 同以前的ss1x::uuid::sha1，返回原始字节；十六进制见digest-file
+        return string_t(std::move(digests.front()));
     }
     catch (...) {
         return varlisp::Nill{};
@@ -43,8 +113,9 @@ Object eval_digest_sha1_string(varlisp::Environment& env,
     const auto* p_string = varlisp::requireTypedValue<varlisp::string_t>(
         env, detail::car(args), tmp, funcName, 0, DEBUG_INFO);
 
-    return string_t(
-        ss1x::uuid::sha1::fromBytes(p_string->data(), p_string->size()));
+    auto digests = detail::digest::digest_view(p_string->to_string_view(),
+                                               {detail::digest::algo_sha1});
+    return string_t(std::move(digests.front()));
 }
 
 REGIST_BUILTIN(
@@ -59,7 +130,167 @@ Object eval_digest_hex_string(varlisp::Environment& env,
     const auto* p_string = varlisp::requireTypedValue<varlisp::string_t>(
         env, detail::car(args), tmp, funcName, 0, DEBUG_INFO);
 
-    return string_t(sss::to_hex(*p_string->gen_shared()));
+    std::string out;
+    detail::enckernel::hex_encode(out, p_string->to_string_view());
+    string_t ret;
+    ret = std::move(out);
+    return ret;
+}
+
+REGIST_BUILTIN("digest", 2, 2, eval_digest,
+               "; digest 计算摘要；可同时计算多种，只遍历一次\n"
+               "; 算法: md5 sha1 sha256 xxh64 xxh3 blake3\n"
+               "(digest \"content\" \"algo\") -> \"hex-string\"\n"
+               "(digest \"content\" '(\"algo\"...)) -> {algo \"hex-string\"...}");
+
+/**
+ * @brief
+ *      (digest "content" "algo") -> "hex-string"
+ *      (digest "content" '("algo"...)) -> {algo "hex-string"...}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_digest(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "digest";
+    std::array<Object, 2> objs;
+    const auto* p_content = varlisp::requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    std::vector<detail::digest::algo_t> algos;
+    bool is_single = detail::parseDigestAlgos(env, args.nth(1), objs[1], funcName, 1, algos);
+
+    std::vector<std::string> digests;
+    try {
+        digests = detail::digest::digest_view(p_content->to_string_view(), algos);
+    }
+    catch (std::exception& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+    return detail::digestsToObject(algos, digests, is_single);
+}
+
+REGIST_BUILTIN("digest-file", 2, 2, eval_digest_file,
+               "; digest-file 流式计算文件(路径或fd)的摘要；普通文件mmap后计算，\n"
+               "; 其余按块读取；可同时计算多种；失败返回nil\n"
+               "(digest-file \"path\"|fd \"algo\") -> \"hex-string\" | nil\n"
+               "(digest-file \"path\"|fd '(\"algo\"...)) -> {algo \"hex-string\"...} | nil");
+
+/**
+ * @brief
+ *      (digest-file "path"|fd "algo") -> "hex-string" | nil
+ *      (digest-file "path"|fd '("algo"...)) -> {algo "hex-string"...} | nil
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_digest_file(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "digest-file";
+    std::array<Object, 2> objs;
+    std::vector<detail::digest::algo_t> algos;
+    bool is_single = detail::parseDigestAlgos(env, args.nth(1), objs[1], funcName, 1, algos);
+
+    const Object& target = getAtomicValue(env, args.nth(0), objs[0]);
+    std::vector<std::string> digests;
+    try {
+        if (const auto* p_fd = boost::get<int64_t>(&target)) {
+            detail::file::sync_reader(int(*p_fd));
+            digests = detail::digest::digest_fd(int(*p_fd), algos);
+        }
+        else if (const auto* p_path = boost::get<varlisp::string_t>(&target)) {
+            digests = detail::digest::digest_file(
+                sss::path::full_of_copy(*p_path->gen_shared()), algos);
+        }
+        else {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": require fd:int or path:string as 1st argument; but ",
+                               target, ")");
+        }
+    }
+    catch (std::runtime_error&) {
+        return varlisp::Nill{};
+    }
+    return detail::digestsToObject(algos, digests, is_single);
+}
+
+REGIST_BUILTIN("digest-files", 2, 3, eval_digest_files,
+               "; digest-files 多个文件，多线程并行计算摘要；每个文件只读取一次\n"
+               "; threads: 0表示按CPU核数(默认)；结果顺序同paths；\n"
+               "; 失败的文件，结果为 {path error}\n"
+               "(digest-files '(\"path\"...) \"algo\"|'(\"algo\"...)) -> '({path size algo...}...)\n"
+               "(digest-files '(\"path\"...) \"algo\"|'(\"algo\"...) threads) -> '({path size algo...}...)");
+
+/**
+ * @brief
+ *      (digest-files '("path"...) "algo"|'("algo"...)) -> '({path size algo...}...)
+ *      (digest-files '("path"...) "algo"|'("algo"...) threads) -> '({path size algo...}...)
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_digest_files(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "digest-files";
+    std::array<Object, 3> objs;
+    const varlisp::List* p_paths = varlisp::getQuotedList(env, args.nth(0), objs[0]);
+    if (p_paths == nullptr) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                           ": need quote list as the 1st argument)");
+    }
+    std::vector<varlisp::string_t> names;
+    std::vector<std::string> paths;
+    for (const auto& it : *p_paths) {
+        Object tmp;
+        const auto* p_path = getTypedValue<varlisp::string_t>(env, it, tmp);
+        if (p_path == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": path must be string; but ", it, ")");
+        }
+        names.push_back(*p_path);
+        paths.push_back(sss::path::full_of_copy(*p_path->gen_shared()));
+    }
+
+    std::vector<detail::digest::algo_t> algos;
+    detail::parseDigestAlgos(env, args.nth(1), objs[1], funcName, 1, algos);
+
+    size_t threads = 0;
+    if (args.length() >= 3) {
+        int64_t in_threads = *requireTypedValue<int64_t>(env, args.nth(2), objs[2],
+                                                         funcName, 2, DEBUG_INFO);
+        if (in_threads < 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": threads must not be negative; but ", in_threads, ")");
+        }
+        threads = size_t(in_threads);
+    }
+
+    auto results = detail::digest::digest_files(paths, algos, threads);
+
+    varlisp::List ret = varlisp::List::makeSQuoteList();
+    auto * p_ret = ret.get_slist();
+    for (size_t i = 0; i < results.size(); ++i) {
+        varlisp::Environment item;
+        item["path"] = names[i];
+        if (results[i].ok) {
+            item["size"] = results[i].size;
+            for (size_t j = 0; j < algos.size(); ++j) {
+                item[detail::digest::algo_name(algos[j])] =
+                    detail::toHexString(results[i].digests[j]);
+            }
+        }
+        else {
+            item["error"] = string_t(results[i].error);
+        }
+        p_ret->append(Object(std::move(item)));
+    }
+    return ret;
 }
 
 }  // namespace varlisp
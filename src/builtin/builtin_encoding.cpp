@@ -1,10 +1,11 @@
 #include <cctype>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstring>
 #include <stdexcept>
 
-#include <uchardet/uchardet.h>
-
 #include <sss/colorlog.hpp>
 #include <sss/encoding.hpp>
 #include <sss/iConvpp.hpp>
@@ -14,28 +15,15 @@
 #include <sss/utlstring.hpp>
 
 #include "../object.hpp"
+#include "../arithmetic_cast_visitor.hpp"
+#include "../arithmetic_t.hpp"
 #include "../builtin_helper.hpp"
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
-
-inline void encoding_normalize(std::string& encoding)
-{
-    sss::to_lower(encoding);
-    // utf-8, utf-16be utf-32le
-    if (sss::is_begin_with(encoding, "utf-") ||
-        sss::is_begin_with(encoding, "ucs-")) {
-        encoding.erase(encoding.begin() + 3);
-    }
-    if (encoding.empty() || encoding == "none") {
-        encoding.assign("ascii");
-    }
-    // ucs-2     16 bit UCS-2 encoded Unicode (ISO/IEC 10646-1)
-    // ucs-2le   like ucs-2, little endian
-    // utf-16    ucs-2 extended with double-words for more characters
-    // utf-16le  like utf-16, little endian
-    // ucs-4     32 bit UCS-4 encoded Unicode (ISO/IEC 10646-1)
-    // ucs-4le   like ucs-4, little endian
-}
+#include "../detail/charset.hpp"
+#include "../detail/regex_stream.hpp"
+#include "../detail/stream_fd.hpp"
+#include "../environment.hpp"
 
 //   uchardet content
 //   pychardet content
@@ -45,6 +33,8 @@ inline void encoding_normalize(std::string& encoding)
 namespace varlisp {
 
 REGIST_BUILTIN("uchardet", 1, 1, eval_uchardet,
+               "; uchardet 检测编码；ASCII、合法utf8直接返回，\n"
+               "; 较长的内容，只检测采样(见charset-detect)\n"
                "(uchardet \"content\") -> \"utf8\"");
 
 /**
@@ -63,30 +53,83 @@ Object eval_uchardet(varlisp::Environment& env, const varlisp::List& args)
     const auto * p_content =
         requireTypedValue<varlisp::string_t>(env, args.nth(0), obj, funcName, 0, DEBUG_INFO);
 
-    uchardet_t ud = uchardet_new();
-    std::string encoding;
-    int err = uchardet_handle_data(ud, p_content->c_str(), p_content->length());
-    if (err == 0)
-    {
-        uchardet_data_end(ud);
-        encoding = uchardet_get_charset(ud);
-        encoding_normalize(encoding);
+    try {
+        return string_t(detail::charset::detect(p_content->to_string_view()).encoding);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error,
+                          "(", funcName, ": analyze coding faild！", e.what(), ")");
     }
+}
+
+REGIST_BUILTIN("charset-detect", 1, 3, eval_charset_detect,
+               "; charset-detect 检测编码：\n"
+               ";   1. 不含'\\0'时，先做向量化的ASCII、utf8校验，命中即返回；\n"
+               ";   2. 超过sample-bytes(默认64K，0表示不采样)的内容，用uchardet检测三段采样\n"
+               ";      (首个非ASCII字节所在行起、中部、尾部)；\n"
+               ";   3. 各段结果的一致度低于confidence(默认0.6)时，再检测全文\n"
+               "; method: \"ascii\" \"utf8\" \"sample\" \"full\"\n"
+               "(charset-detect \"content\") -> {encoding confidence method}\n"
+               "(charset-detect \"content\" sample-bytes) -> {encoding confidence method}\n"
+               "(charset-detect \"content\" sample-bytes confidence) -> {encoding confidence method}");
 
-    uchardet_delete(ud);
+/**
+ * @brief
+ *      (charset-detect "content") -> {encoding confidence method}
+ *      (charset-detect "content" sample-bytes) -> {encoding confidence method}
+ *      (charset-detect "content" sample-bytes confidence) -> {encoding confidence method}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_charset_detect(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "charset-detect";
+    std::array<Object, 3> objs;
+    const auto * p_content = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
-    if (encoding.empty()) {
-        encoding.assign("ascii");
+    detail::charset::detect_option_t opt;
+    if (args.length() >= 2) {
+        int64_t sample_size = *requireTypedValue<int64_t>(env, args.nth(1), objs[1],
+                                                          funcName, 1, DEBUG_INFO);
+        if (sample_size < 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": sample-bytes must not be negative; but ", sample_size, ")");
+        }
+        opt.sample_size = size_t(sample_size);
+    }
+    if (args.length() >= 3) {
+        const Object& confidence_ref = getAtomicValue(env, args.nth(2), objs[2]);
+        arithmetic_t confidence =
+            boost::apply_visitor(arithmetic_cast_visitor(env), confidence_ref);
+        if (confidence.which() == 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": need number as 3rd argument)");
+        }
+        opt.confidence = arithmetic2double(confidence);
     }
 
-    if (err != 0) {
-        SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": analyze coding faild！)");
+    detail::charset::detect_result_t result;
+    try {
+        result = detail::charset::detect(p_content->to_string_view(), opt);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
     }
-    return string_t(encoding);
+
+    varlisp::Environment ret;
+    ret["encoding"] = string_t(result.encoding);
+    ret["confidence"] = result.confidence;
+    ret["method"] = string_t(std::string(result.method));
+    return Object(std::move(ret));
 }
 
 REGIST_BUILTIN("pychardet", 1, 1, eval_pychardet,
+               "; pychardet 调用外部的chardet检测编码；ASCII、合法utf8直接返回，\n"
+               "; 其余只传入开头的采样(至多64K)\n"
                "(pychardet \"content\") -> \"utf8\"");
 
 /**
@@ -105,6 +148,13 @@ Object eval_pychardet(varlisp::Environment& env, const varlisp::List& args)
     const auto * p_content =
         requireTypedValue<varlisp::string_t>(env, args.nth(0), obj, funcName, 0, DEBUG_INFO);
 
+    detail::charset::detect_result_t fast;
+    if (detail::charset::detect_fast(p_content->to_string_view(), fast)) {
+        return string_t(fast.encoding);
+    }
+    sss::string_view sample = detail::charset::head_sample(
+        p_content->to_string_view(), detail::charset::detect_option_t().sample_size);
+
     // Python 支持两种使用方式：
     //
     // 1. 外部文件；
@@ -132,15 +182,18 @@ Object eval_pychardet(varlisp::Environment& env, const varlisp::List& args)
     // 不定长的编码，那么，判断行（或者任意一个ascii字符），为结尾，比较安全；
     //
     // 那么，麻烦了——这是一个死循环；因为ucs2，将很难与不定长类的编码，区分开！
-    size_t w_cnt = write(rwepipe_data[0], p_content->data(), p_content->size());
-    if (w_cnt != p_content->size()) {
+    //
+    // NOTE 现在只传入按行对齐的采样，规避了上述问题的大部分
+    ssize_t w_cnt = write(rwepipe_data[0], sample.data(), sample.size());
+    if (w_cnt != ssize_t(sample.size())) {
+        pcloseRWE(pid, rwepipe_data);
         return Object{Nill{}};
     }
     close(rwepipe_data[0]);
     rwepipe_data[0] = -1;
     char out_buf[1024];
-    size_t cnt = read(rwepipe_data[1], out_buf, sizeof(out_buf));
-    out_buf[cnt] = '\0';
+    ssize_t cnt = read(rwepipe_data[1], out_buf, sizeof(out_buf) - 1);
+    out_buf[cnt > 0 ? cnt : 0] = '\0';
     pcloseRWE(pid, rwepipe_data);
     if (!sss::is_begin_with(out_buf, "<stdin>: ")) {
         return Object{Nill{}};
@@ -150,7 +203,7 @@ Object eval_pychardet(varlisp::Environment& env, const varlisp::List& args)
         next_space[0] = '\0';
         std::string encoding(out_buf + 9);
 
-        encoding_normalize(encoding);
+        detail::charset::normalize(encoding);
         return string_t(std::move(encoding));
     }
     return Object{Nill{}};
@@ -170,6 +223,7 @@ void trim(sss::string_view& s)
 } // namespace detail
 
 REGIST_BUILTIN("ivchardet", 2, 2, eval_ivchardet,
+               "; ivchardet 返回encodings中，第一个能完整解码content的编码\n"
                "(ivchardet \"encodings\" \"content\") -> \"utf8\"");
 
 /**
@@ -190,25 +244,15 @@ Object eval_ivchardet(varlisp::Environment& env, const varlisp::List& args)
     const auto * p_content = requireTypedValue<varlisp::string_t>(
         env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
+    // 逐个尝试；utf8、ascii 用向量化校验，其余按块交给iconv，不保存转换结果
     sss::string_view encoding;
     bool has_found = false;
     sss::ViewSpliter<char> sp(*p_encodings, ',');
-    std::string out;
     while (sp.fetch_next(encoding)) {
         detail::trim(encoding);
-        try {
-            auto encoding_str = encoding.to_string();
-            sss::iConv ic(encoding_str, encoding_str);
-            if (!ic.is_ok()) {
-                continue;
-            }
-            if (ic.convert(out, *p_content->gen_shared()) != 0) {
-                has_found = true;
-                break;
-            }
-        }
-        catch (...) {
-            continue;
+        if (detail::charset::is_decodable(p_content->to_string_view(), encoding.to_string())) {
+            has_found = true;
+            break;
         }
     }
 
@@ -254,6 +298,7 @@ Object eval_iconv(varlisp::Environment& env, const varlisp::List& args)
 }
 
 REGIST_BUILTIN("ensure-utf8", 1, 2, eval_ensure_utf8,
+               "; ensure-utf8 转换为utf8；ASCII、合法utf8的内容，直接返回原串\n"
                "(ensure-utf8 \"content\") -> \"utf8-content\"\n"
                "(ensure-utf8 \"content\" \"fencodings\") -> \"utf8-content\"");
 
@@ -280,31 +325,124 @@ Object eval_ensure_utf8(varlisp::Environment& env, const varlisp::List& args)
             requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
     }
 
-    std::string encodings;
-    std::string to_encoding = "utf8";
-    if (p_encodings != nullptr) {
-        encodings = *p_encodings->gen_shared();
+    // ASCII、合法utf8，直接返回原串
+    detail::charset::detect_result_t fast;
+    if (detail::charset::detect_fast(p_content->to_string_view(), fast)) {
+        return *p_content;
     }
+
+    std::string to_encoding = "utf8";
     std::string from_encoding;
-    auto content = p_content->gen_shared();
+    try {
+        if (p_encodings == nullptr) {
+            from_encoding = detail::charset::detect(p_content->to_string_view()).encoding;
+        }
+        else {
+            auto content = p_content->gen_shared();
+            from_encoding = sss::Encoding::encodings(*content, *p_encodings->gen_shared());
+        }
 
-    if (encodings.empty()) {
-        from_encoding = sss::Encoding::detect(*content);
+        if (detail::charset::is_compatible(from_encoding, to_encoding)) {
+            return *p_content;
+        }
+        std::string out;
+        out.reserve(p_content->size() + p_content->size() / 2);
+        detail::charset::transcode(detail::codec::memory_source(p_content->to_string_view()),
+                                   detail::codec::memory_sink(out), from_encoding, to_encoding);
+        string_t ret;
+        ret = std::move(out);
+        return ret;
     }
-    else {
-        from_encoding = sss::Encoding::encodings(*content, encodings);
+    catch (std::runtime_error& e) {
+        COLOG_ERROR("(", funcName, ":", from_encoding, "to", to_encoding, e.what());
     }
+    return {Nill{}};
+}
 
-    if (sss::Encoding::isCompatibleWith(from_encoding, to_encoding)) {
-        return *p_content;
+REGIST_BUILTIN("iconv-stream", 4, 4, eval_iconv_stream,
+               "; iconv-stream 从in流式读取，按块转换编码后写到out；in、out为fd或者路径\n"
+               "; enc-from 为\"auto\"时，按开头64K检测(见charset-detect)；\n"
+               "; 源、目标编码兼容(如utf8 -> utf8)时，直接复制；\n"
+               "; 返回统计：bytes-in bytes-out ms mbps encoding(实际的源编码)\n"
+               "(iconv-stream in out \"enc-from\" \"enc-to\") -> {stat}\n"
+               "(iconv-stream in out \"auto\" \"enc-to\") -> {stat}");
+
+/**
+ * @brief
+ *      (iconv-stream in out "enc-from" "enc-to") -> {stat}
+ *      (iconv-stream in out "auto" "enc-to") -> {stat}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_iconv_stream(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "iconv-stream";
+    std::array<Object, 4> objs;
+    const auto * p_enc_from =
+        requireTypedValue<varlisp::string_t>(env, args.nth(2), objs[2], funcName, 2, DEBUG_INFO);
+    const auto * p_enc_to =
+        requireTypedValue<varlisp::string_t>(env, args.nth(3), objs[3], funcName, 3, DEBUG_INFO);
+
+    detail::stream_fd_t in(getAtomicValue(env, args.nth(0), objs[0]), false, funcName, 0);
+    detail::stream_fd_t out(getAtomicValue(env, args.nth(1), objs[1]), true, funcName, 1);
+    detail::fd_writer_t writer(out.fd());
+
+    auto beg = std::chrono::steady_clock::now();
+    std::string enc_from = *p_enc_from->gen_shared();
+    detail::codec::stat_t stat;
+    try {
+        auto source = detail::codec::fd_source(in.fd());
+        // 检测用的开头部分，转换时先交出，再继续读取
+        std::string head;
+        if (enc_from == "auto") {
+            detail::charset::detect_option_t opt;
+            opt.partial = true;
+            head.resize(opt.sample_size);
+            size_t got = 0;
+            while (got < head.size()) {
+                size_t cnt = source(&head[got], head.size() - got);
+                if (cnt == 0) {
+                    break;
+                }
+                got += cnt;
+            }
+            head.resize(got);
+            enc_from = detail::charset::detect(head, opt).encoding;
+        }
+        size_t head_offset = 0;
+        auto chained = [&](char* buf, size_t size) -> size_t {
+            if (head_offset < head.size()) {
+                size_t len = std::min(size, head.size() - head_offset);
+                std::memcpy(buf, head.data() + head_offset, len);
+                head_offset += len;
+                return len;
+            }
+            return source(buf, size);
+        };
+        stat = detail::charset::transcode(
+            chained,
+            [&writer](const char* data, size_t size) {
+                writer.write(sss::string_view(data, size));
+            },
+            enc_from, *p_enc_to->gen_shared());
+        writer.flush();
     }
-    std::string out;
-    sss::iConv ic(to_encoding, from_encoding);
-    if (ic.convert(out, *content) != 0) {
-        return string_t(out);
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
     }
-    COLOG_ERROR("(", funcName, ":", from_encoding, "to", to_encoding);
-    return {Nill{}};
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - beg).count();
+
+    varlisp::Environment ret;
+    ret["bytes-in"]  = stat.bytes_in;
+    ret["bytes-out"] = stat.bytes_out;
+    ret["ms"]        = double(us) / 1000.0;
+    ret["mbps"]      = us > 0 ? double(stat.bytes_in) / double(us) : 0.0;
+    ret["encoding"]  = string_t(enc_from);
+    return Object(std::move(ret));
 }
 
 } // namespace varlisp
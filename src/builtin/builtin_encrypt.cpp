@@ -1,103 +1,147 @@
 #include <array>
+#include <chrono>
+#include <vector>
 
 #include <zlib.h>
 
-#include <boost/iostreams/copy.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/filtering_streambuf.hpp>
-
-#include <sss/enc/base64.hpp>
-
 #include "../builtin_helper.hpp"
 #include "../object.hpp"
 
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
+#include "../detail/codec.hpp"
+#include "../detail/enc_kernel.hpp"
+#include "../detail/regex_stream.hpp"
+#include "../detail/stream_fd.hpp"
 #include "../environment.hpp"
 
 namespace varlisp {
-REGIST_BUILTIN("en-base64", 1, 1, eval_en_base64,
-               "(en-base64 \"string\") -> \"enc\"");
 
-Object eval_en_base64(varlisp::Environment& env, const varlisp::List& args)
+namespace detail {
+
+// 结果移入String；String::operator=(std::string&&) 移动缓冲区，内容不复制
+inline Object moveToString(std::string&& s)
+{
+    varlisp::string_t ret;
+    ret = std::move(s);
+    return Object(std::move(ret));
+}
+
+inline Object evalBase64Encode(varlisp::Environment& env, const varlisp::List& args,
+                               const char* funcName, enckernel::alphabet_t alphabet)
 {
-    const char* funcName = "en-base64";
     std::array<Object, 1> objs;
     const auto* p_str = requireTypedValue<varlisp::string_t>(
         env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
-    sss::enc::Base64 b;
-    return varlisp::string_t(b.encode(*p_str->gen_shared()));
+    std::string out;
+    enckernel::base64_encode(out, p_str->to_string_view(), alphabet);
+    return moveToString(std::move(out));
 }
 
-REGIST_BUILTIN("de-base64", 1, 1, eval_de_base64,
-               "(de-base64 \"string\") -> \"decode\"");
-
-Object eval_de_base64(varlisp::Environment& env, const varlisp::List& args)
+inline Object evalBase64Decode(varlisp::Environment& env, const varlisp::List& args,
+                               const char* funcName, enckernel::alphabet_t alphabet)
 {
-    const char* funcName = "de-base64";
     std::array<Object, 1> objs;
     const auto* p_str = requireTypedValue<varlisp::string_t>(
         env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
-    sss::enc::Base64 b;
-    return varlisp::string_t(b.decode(*p_str->gen_shared()));
+    std::string out;
+    if (!enckernel::base64_decode(out, p_str->to_string_view(), alphabet)) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": invalid base64 input)");
+    }
+    return moveToString(std::move(out));
 }
 
-REGIST_BUILTIN("en-gzip", 1, 1, eval_en_gzip,
-               "(en-gzip \"string\") -> \"enc\"");
+}  // namespace detail
 
-// https://en.wikipedia.org/wiki/Gzip
-Object eval_en_gzip(varlisp::Environment& env, const varlisp::List& args)
+REGIST_BUILTIN("en-base64", 1, 1, eval_en_base64,
+               "; en-base64 标准base64编码(\"+/\"，以'='补齐)\n"
+               "(en-base64 \"string\") -> \"enc\"");
+
+Object eval_en_base64(varlisp::Environment& env, const varlisp::List& args)
 {
-    const char* funcName = "en-gzip";
-    std::array<Object, 1> objs;
-    const auto* p_str = requireTypedValue<varlisp::string_t>(
-        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    return detail::evalBase64Encode(env, args, "en-base64", detail::enckernel::alphabet_std);
+}
 
-    boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
-    in.push(boost::iostreams::gzip_compressor());
-    std::istringstream iss(p_str->to_string());
-    std::ostringstream oss;
-    in.push(iss);
-    boost::iostreams::copy(in, oss);
+REGIST_BUILTIN("de-base64", 1, 1, eval_de_base64,
+               "; de-base64 标准base64解码；忽略空白，'='可省略；非法输入抛出异常\n"
+               "(de-base64 \"string\") -> \"decode\"");
 
-    return varlisp::string_t(oss.str());
+Object eval_de_base64(varlisp::Environment& env, const varlisp::List& args)
+{
+    return detail::evalBase64Decode(env, args, "de-base64", detail::enckernel::alphabet_std);
 }
 
-// #include <fstream>
-// #include <iostream>
-// #include <boost/iostreams/filtering_streambuf.hpp>
-// #include <boost/iostreams/copy.hpp>
-// #include <boost/iostreams/filter/gzip.hpp>
-//
-// int main()
-// {
-//     using namespace std;
-//
-//     ifstream file("hello.gz", ios_base::in | ios_base::binary);
-//     filtering_streambuf<input> in;
-//     in.push(gzip_decompressor());
-//     in.push(file);
-//     boost::iostreams::copy(in, cout);
-// }
+REGIST_BUILTIN("en-base64url", 1, 1, eval_en_base64url,
+               "; en-base64url URL安全的base64编码(\"-_\"，不补'=')\n"
+               "(en-base64url \"string\") -> \"enc\"");
 
-REGIST_BUILTIN("de-gzip", 1, 1, eval_de_gzip,
-               "(de-gzip \"string\") -> \"dec\"");
+Object eval_en_base64url(varlisp::Environment& env, const varlisp::List& args)
+{
+    return detail::evalBase64Encode(env, args, "en-base64url", detail::enckernel::alphabet_url);
+}
 
-Object eval_de_gzip(varlisp::Environment& env, const varlisp::List& args)
+REGIST_BUILTIN("de-base64url", 1, 1, eval_de_base64url,
+               "; de-base64url URL安全的base64解码；忽略空白，'='可省略；非法输入抛出异常\n"
+               "(de-base64url \"string\") -> \"decode\"");
+
+Object eval_de_base64url(varlisp::Environment& env, const varlisp::List& args)
 {
-    const char* funcName = "de-gzip";
-    std::array<Object, 1> objs;
+    return detail::evalBase64Decode(env, args, "de-base64url", detail::enckernel::alphabet_url);
+}
+
+REGIST_BUILTIN("en-hex", 1, 2, eval_en_hex,
+               "; en-hex 十六进制编码；upper为真时，使用大写字母\n"
+               "(en-hex \"string\") -> \"hex-string\"\n"
+               "(en-hex \"string\" upper) -> \"HEX-STRING\"");
+
+/**
+ * @brief
+ *      (en-hex "string") -> "hex-string"
+ *      (en-hex "string" upper) -> "HEX-STRING"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_en_hex(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "en-hex";
+    std::array<Object, 2> objs;
     const auto* p_str = requireTypedValue<varlisp::string_t>(
         env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    bool upper = false;
+    if (args.length() >= 2) {
+        upper = *requireTypedValue<bool>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
+    }
+    std::string out;
+    detail::enckernel::hex_encode(out, p_str->to_string_view(), upper);
+    return detail::moveToString(std::move(out));
+}
 
-    boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
-    in.push(boost::iostreams::gzip_decompressor());
-    std::istringstream iss(p_str->to_string());
-    std::ostringstream oss;
-    in.push(iss);
-    boost::iostreams::copy(in, oss);
-
-    return varlisp::string_t(oss.str());
+REGIST_BUILTIN("de-hex", 1, 1, eval_de_hex,
+               "; de-hex 十六进制解码；大小写均可；非法输入抛出异常\n"
+               "(de-hex \"hex-string\") -> \"string\"");
+
+/**
+ * @brief (de-hex "hex-string") -> "string"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_de_hex(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "de-hex";
+    std::array<Object, 1> objs;
+    const auto* p_str = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    std::string out;
+    if (!detail::enckernel::hex_decode(out, p_str->to_string_view())) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": invalid hex input)");
+    }
+    return detail::moveToString(std::move(out));
 }
 
 namespace detail {
@@ -128,8 +172,123 @@ inline void calcLevel(int& level, int in_level, const char* funcName)
     level = in_level;
 }
 
+inline void calcZstdLevel(int& level, int64_t in_level, const char* funcName)
+{
+    if (in_level < codec::zstd_min_level() || in_level > codec::zstd_max_level()) {
+        SSS_POSITION_THROW(std::runtime_error, "wrong ", funcName,
+                           " level; out of range [", codec::zstd_min_level(), ", ",
+                           codec::zstd_max_level(), "], ", in_level);
+    }
+    level = int(in_level);
+}
+
+inline void calcThreads(size_t& threads, int64_t in_threads, const char* funcName)
+{
+    if (in_threads < 0) {
+        SSS_POSITION_THROW(std::runtime_error, "wrong ", funcName,
+                           " threads; must not be negative, ", in_threads);
+    }
+    threads = size_t(in_threads);
+}
+
+// 统计：输入、输出字节数，耗时，以及按输入计的吞吐(MB/s)
+inline Object codecStat(const codec::stat_t& stat, int64_t us)
+{
+    varlisp::Environment ret;
+    ret["bytes-in"]  = stat.bytes_in;
+    ret["bytes-out"] = stat.bytes_out;
+    ret["ms"]        = double(us) / 1000.0;
+    ret["mbps"]      = us > 0 ? double(stat.bytes_in) / double(us) : 0.0;
+    return Object(std::move(ret));
+}
+
+using codec_func_t =
+    std::function<codec::stat_t(const codec::source_t&, const codec::sink_t&)>;
+
+// (xxx-stream in out ...)：in、out为fd，或者路径
+inline Object runCodecStream(varlisp::Environment& env, const varlisp::List& args,
+                             Object& in_obj, Object& out_obj,
+                             const char* funcName, const codec_func_t& func)
+{
+    stream_fd_t in(getAtomicValue(env, args.nth(0), in_obj), false, funcName, 0);
+    stream_fd_t out(getAtomicValue(env, args.nth(1), out_obj), true, funcName, 1);
+    fd_writer_t writer(out.fd());
+
+    auto beg = std::chrono::steady_clock::now();
+    codec::stat_t stat;
+    try {
+        stat = func(codec::fd_source(in.fd()), [&writer](const char* data, size_t size) {
+            writer.write(sss::string_view(data, size));
+        });
+        writer.flush();
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - beg).count();
+    return codecStat(stat, us);
+}
+
 }  // namespace detail
 
+REGIST_BUILTIN("en-gzip", 1, 2, eval_en_gzip,
+               "; en-gzip gzip压缩；较长的串，分块并行压缩(pigz风格)，结果仍是标准gzip\n"
+               "; level: 0-9\n"
+               "(en-gzip \"string\") -> \"enc\"\n"
+               "(en-gzip \"string\" level) -> \"enc\"");
+
+// https://en.wikipedia.org/wiki/Gzip
+Object eval_en_gzip(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "en-gzip";
+    std::array<Object, 2> objs;
+    const auto* p_str = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    detail::codec::gzip_option_t opt;
+    if (args.length() >= 2) {
+        detail::calcLevel(opt.level,
+                          *requireTypedValue<int64_t>(env, args.nth(1), objs[1],
+                                                      funcName, 1, DEBUG_INFO),
+                          funcName);
+    }
+
+    std::string out;
+    try {
+        detail::codec::gzip_compress(detail::codec::memory_source(p_str->to_string_view()),
+                                     detail::codec::memory_sink(out), opt);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+
+    return varlisp::string_t(std::move(out));
+}
+
+REGIST_BUILTIN("de-gzip", 1, 1, eval_de_gzip,
+               "; de-gzip gzip解压；支持多个member拼接的gzip\n"
+               "(de-gzip \"string\") -> \"dec\"");
+
+Object eval_de_gzip(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "de-gzip";
+    std::array<Object, 1> objs;
+    const auto* p_str = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    std::string out;
+    try {
+        detail::codec::gzip_decompress(detail::codec::memory_source(p_str->to_string_view()),
+                                       detail::codec::memory_sink(out));
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+
+    return varlisp::string_t(std::move(out));
+}
+
 REGIST_BUILTIN("deflate", 2, 3, eval_deflate,
                "; deflate 算法压缩\n"
                "; 参考： $Node.js/node-deflate/src/deflate.cc\n"
@@ -304,4 +463,208 @@ Object eval_inflate(varlisp::Environment& env, const varlisp::List& args)
     return ret;
 }
 
+REGIST_BUILTIN("gzip-stream", 2, 4, eval_gzip_stream,
+               "; gzip-stream 从in流式读取，gzip压缩后写到out；in、out为fd或者路径\n"
+               "; 分块并行压缩(pigz风格)，结果仍是标准gzip；\n"
+               "; level: 0-9；threads: 压缩线程数，0表示按CPU核数(默认)\n"
+               "; 返回统计：bytes-in bytes-out ms mbps\n"
+               "(gzip-stream in out) -> {stat}\n"
+               "(gzip-stream in out level) -> {stat}\n"
+               "(gzip-stream in out level threads) -> {stat}");
+
+/**
+ * @brief
+ *      (gzip-stream in out) -> {stat}
+ *      (gzip-stream in out level) -> {stat}
+ *      (gzip-stream in out level threads) -> {stat}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_gzip_stream(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "gzip-stream";
+    std::array<Object, 4> objs;
+    detail::codec::gzip_option_t opt;
+    if (args.length() >= 3) {
+        detail::calcLevel(opt.level,
+                          *requireTypedValue<int64_t>(env, args.nth(2), objs[2],
+                                                      funcName, 2, DEBUG_INFO),
+                          funcName);
+    }
+    if (args.length() >= 4) {
+        detail::calcThreads(opt.threads,
+                            *requireTypedValue<int64_t>(env, args.nth(3), objs[3],
+                                                        funcName, 3, DEBUG_INFO),
+                            funcName);
+    }
+    return detail::runCodecStream(
+        env, args, objs[0], objs[1], funcName,
+        [&opt](const detail::codec::source_t& source, const detail::codec::sink_t& sink) {
+            return detail::codec::gzip_compress(source, sink, opt);
+        });
+}
+
+REGIST_BUILTIN("gunzip-stream", 2, 2, eval_gunzip_stream,
+               "; gunzip-stream 从in流式读取，gzip解压后写到out；in、out为fd或者路径\n"
+               "; 返回统计：bytes-in bytes-out ms mbps\n"
+               "(gunzip-stream in out) -> {stat}");
+
+/**
+ * @brief (gunzip-stream in out) -> {stat}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_gunzip_stream(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "gunzip-stream";
+    std::array<Object, 2> objs;
+    return detail::runCodecStream(env, args, objs[0], objs[1], funcName,
+                                  detail::codec::gzip_decompress);
+}
+
+REGIST_BUILTIN("en-zstd", 1, 2, eval_en_zstd,
+               "; en-zstd zstd压缩；比gzip快得多\n"
+               "; level: 默认3；范围见zstd，负数为更快的压缩\n"
+               "(en-zstd \"string\") -> \"enc\"\n"
+               "(en-zstd \"string\" level) -> \"enc\"");
+
+/**
+ * @brief
+ *      (en-zstd "string") -> "enc"
+ *      (en-zstd "string" level) -> "enc"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_en_zstd(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "en-zstd";
+    std::array<Object, 2> objs;
+    const auto* p_str = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    int level = detail::codec::zstd_default_level();
+    if (args.length() >= 2) {
+        detail::calcZstdLevel(level,
+                              *requireTypedValue<int64_t>(env, args.nth(1), objs[1],
+                                                          funcName, 1, DEBUG_INFO),
+                              funcName);
+    }
+
+    std::string out;
+    try {
+        detail::codec::zstd_compress(detail::codec::memory_source(p_str->to_string_view()),
+                                     detail::codec::memory_sink(out), level, 1);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+
+    return varlisp::string_t(std::move(out));
+}
+
+REGIST_BUILTIN("de-zstd", 1, 1, eval_de_zstd,
+               "; de-zstd zstd解压；支持多个frame拼接\n"
+               "(de-zstd \"string\") -> \"dec\"");
+
+/**
+ * @brief (de-zstd "string") -> "dec"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_de_zstd(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "de-zstd";
+    std::array<Object, 1> objs;
+    const auto* p_str = requireTypedValue<varlisp::string_t>(
+        env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    std::string out;
+    try {
+        detail::codec::zstd_decompress(detail::codec::memory_source(p_str->to_string_view()),
+                                       detail::codec::memory_sink(out));
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+
+    return varlisp::string_t(std::move(out));
+}
+
+REGIST_BUILTIN("zstd-stream", 2, 4, eval_zstd_stream,
+               "; zstd-stream 从in流式读取，zstd压缩后写到out；in、out为fd或者路径\n"
+               "; level: 默认3；threads: 压缩线程数，0表示按CPU核数(默认)\n"
+               "; 返回统计：bytes-in bytes-out ms mbps\n"
+               "(zstd-stream in out) -> {stat}\n"
+               "(zstd-stream in out level) -> {stat}\n"
+               "(zstd-stream in out level threads) -> {stat}");
+
+/**
+ * @brief
+ *      (zstd-stream in out) -> {stat}
+ *      (zstd-stream in out level) -> {stat}
+ *      (zstd-stream in out level threads) -> {stat}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_zstd_stream(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "zstd-stream";
+    std::array<Object, 4> objs;
+    int level = detail::codec::zstd_default_level();
+    size_t threads = 0;
+    if (args.length() >= 3) {
+        detail::calcZstdLevel(level,
+                              *requireTypedValue<int64_t>(env, args.nth(2), objs[2],
+                                                          funcName, 2, DEBUG_INFO),
+                              funcName);
+    }
+    if (args.length() >= 4) {
+        detail::calcThreads(threads,
+                            *requireTypedValue<int64_t>(env, args.nth(3), objs[3],
+                                                        funcName, 3, DEBUG_INFO),
+                            funcName);
+    }
+    return detail::runCodecStream(
+        env, args, objs[0], objs[1], funcName,
+        [level, threads](const detail::codec::source_t& source, const detail::codec::sink_t& sink) {
+            return detail::codec::zstd_compress(source, sink, level, threads);
+        });
+}
+
+REGIST_BUILTIN("unzstd-stream", 2, 2, eval_unzstd_stream,
+               "; unzstd-stream 从in流式读取，zstd解压后写到out；in、out为fd或者路径\n"
+               "; 返回统计：bytes-in bytes-out ms mbps\n"
+               "(unzstd-stream in out) -> {stat}");
+
+/**
+ * @brief (unzstd-stream in out) -> {stat}
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_unzstd_stream(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "unzstd-stream";
+    std::array<Object, 2> objs;
+    return detail::runCodecStream(env, args, objs[0], objs[1], funcName,
+                                  detail::codec::zstd_decompress);
+}
+
 }  // namespace varlisp
@@ -22,11 +22,44 @@
 #include "../detail/car.hpp"
 #include "../detail/list_iterator.hpp"
 #include "../detail/file.hpp"
+#include "../detail/mmap_file.hpp"
 #include "../detail/varlisp_env.hpp"
 
 namespace varlisp {
 
+namespace detail {
+
+// 不小于此大小的普通文件，read-all 改用mmap
+const int64_t read_all_mmap_threshold = 64 * 1024;
+
+// 映射整个文件；返回的串(及其substr)持有映射，最后一个释放时unmap。
+// 不能映射的(管道等)，读入内存
+template <typename T>
+string_t mapFile(const T& path_or_fd)
+{
+    auto file = std::make_shared<mmap_file_t>(path_or_fd);
+    const sss::string_view view = file->view();
+    return string_t::external(view, std::move(file));
+}
+
+bool isLargeFile(int fd)
+{
+    struct stat st;
+    return ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+           st.st_size >= read_all_mmap_threshold;
+}
+
+bool isLargeFile(const std::string& path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+           st.st_size >= read_all_mmap_threshold;
+}
+
+}  // namespace detail
+
 REGIST_BUILTIN("read-all", 1, 1, eval_read_all,
+               "; read-all 读取整个文件；较大的普通文件，用mmap映射，不复制内容\n"
                "(read-all fd) -> string\n"
                "(read-all \"path/to/file\") -> string");
 
@@ -52,16 +85,64 @@ Object eval_read_all(varlisp::Environment& env, const varlisp::List& args)
             SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
                                "` not to file)");
         }
+        if (detail::isLargeFile(full_path)) {
+            return detail::mapFile(full_path);
+        }
         sss::path::file2string(full_path, content);
 
     } else if (const int64_t* p_fd = boost::get<int64_t>(&resRef)) {
+        detail::file::sync_reader(*p_fd);
+        if (detail::isLargeFile(int(*p_fd))) {
+            return detail::mapFile(int(*p_fd));
+        }
         content = detail::readall(*p_fd);
     } else {
         SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", resRef,
                            "` must be path/to/file:string or fd:int to already opened file)");
     }
 
-    return string_t(content);
+    string_t ret;
+    ret = std::move(content);
+    return ret;
+}
+
+REGIST_BUILTIN("mmap-file", 1, 1, eval_mmap_file,
+               "; mmap-file 只读映射整个文件，返回其内容；不复制。\n"
+               "; substr、split、regex-search 等的结果共享该映射，最后一个释放时解除映射。\n"
+               "; NOTE 映射期间，文件被截断，访问会触发SIGBUS\n"
+               "(mmap-file \"path/to/file\") -> string\n"
+               "(mmap-file fd) -> string");
+
+/**
+ * @brief
+ *    (mmap-file "path/to/file") -> string
+ *    (mmap-file fd) -> string
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return 文件内容；空文件、管道等，读入内存
+ */
+Object eval_mmap_file(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "mmap-file";
+    Object tmp;
+
+    const Object& resRef = varlisp::getAtomicValue(env, args.nth(0), tmp);
+    if (const string_t* p_path = boost::get<varlisp::string_t>(&resRef)) {
+        std::string full_path = sss::path::full_of_copy(*p_path->gen_shared());
+        if (sss::path::file_exists(full_path) != sss::PATH_TO_FILE) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
+                               "` not to file)");
+        }
+        return detail::mapFile(full_path);
+    }
+    if (const int64_t* p_fd = boost::get<int64_t>(&resRef)) {
+        detail::file::sync_reader(*p_fd);
+        return detail::mapFile(int(*p_fd));
+    }
+    SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", resRef,
+                       "` must be path/to/file:string or fd:int to already opened file)");
 }
 
 /**
@@ -157,6 +238,7 @@ Object eval_opentmp(varlisp::Environment& env, const varlisp::List& args)
     char tpl[] = "prefixXXXXXX";
     int64_t fd = ::mkstemp(tpl);
     if (fd != -1) {
+        varlisp::detail::file::drop_reader(fd);
         varlisp::detail::file::register_fd(fd);
     }
     return fd == -1 ? Object{varlisp::Nill{}} : Object{fd};
@@ -206,10 +288,15 @@ Object eval_open(varlisp::Environment& env, const varlisp::List& args)
     if (fd == -1) {
         COLOG_ERROR(std::strerror(errno));
     }
+    else {
+        // 同号的fd，可能未经close关闭过；旧的读缓冲作废
+        varlisp::detail::file::drop_reader(fd);
+    }
     return fd == -1 ? Object{varlisp::Nill{}} : Object{fd};
 }
 
 REGIST_BUILTIN("lseek", 3, 3, eval_lseek,
+               "; lseek 读缓冲中未消费的数据，先退回给fd；SEEK_CUR 相对于已读取的位置\n"
                "(lseek fd offset whence) -> offset | nil");
 
 /**
@@ -217,6 +304,7 @@ REGIST_BUILTIN("lseek", 3, 3, eval_lseek,
  *     (lseek fd offset whence) -> offset | nil
  *
  *     whence: SEEK_SET | SEEK_CUR | SEEK_END
+ *     丢弃fd的读缓冲；SEEK_CUR 相对于read-line等已读取的位置
  *
  * @param[in] env
  * @param[in] args
@@ -232,6 +320,7 @@ Object eval_lseek(varlisp::Environment& env, const varlisp::List& args)
     int64_t offset = *requireTypedValue<int64_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
     int64_t whence = *requireTypedValue<int64_t>(env, args.nth(2), objs[2], funcName, 2, DEBUG_INFO);
 
+    detail::file::sync_reader(fd);
     int64_t res = ::lseek(fd, offset, whence);
     COLOG_DEBUG(SSS_VALUE_MSG(res));
     if (res == -1) {
@@ -308,6 +397,7 @@ Object eval_close(varlisp::Environment& env, const varlisp::List& args)
 
     COLOG_DEBUG(SSS_VALUE_MSG(*p_fd));
     if (*p_fd != -1) {
+        varlisp::detail::file::drop_reader(*p_fd);
         varlisp::detail::file::unregister_fd(*p_fd);
     }
 
@@ -319,6 +409,7 @@ Object eval_close(varlisp::Environment& env, const varlisp::List& args)
 
 REGIST_BUILTIN("read-line", 0, 1, eval_read_line,
                "; read-line 从stdin，或者文件描述符中读取一行数据，并返回字符串；如果遇到流结尾，返回nil\n"
+               "; 文件描述符经读缓冲读取(见fd-buffer-size)；stdin 仍按行交互读取\n"
                "(read-line) -> \"string\" | nil\n"
                "(read-line file-descriptor) -> \"string\" | nil");
 
@@ -337,16 +428,16 @@ Object eval_read_line(varlisp::Environment& env, const varlisp::List& args)
         fd = int(*requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO));
     }
 
-    std::string line;
-
     if (fd != 0)
     {
-        line = detail::readline(fd);
-    }
-    else
-    {
-        line = detail::readline_stdin();
+        sss::string_view line;
+        if (!detail::file::get_reader(fd).next_line(line)) {
+            return varlisp::Nill{};
+        }
+        return varlisp::string_t{line.to_string()};
     }
+
+    std::string line = detail::readline_stdin();
     if (line.empty() && errno) {
         return varlisp::Nill{};
     }
@@ -373,8 +464,9 @@ Object eval_read_char(varlisp::Environment& env, const varlisp::List& args)
         fd = int(*requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO));
     }
 
-    int64_t ch = detail::readchar(fd);
-    if (ch == -1 || errno) {
+    // stdin 不缓冲：与read-line的行编辑共用终端
+    int64_t ch = fd != 0 ? detail::file::read_char(fd) : detail::readchar(fd);
+    if (ch == -1) {
         return varlisp::Nill{};
     }
 
@@ -401,14 +493,143 @@ Object eval_read_byte(varlisp::Environment& env, const varlisp::List& args)
         fd = int(*requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO));
     }
 
-    int64_t ch = detail::readbyte(fd);
-    if (ch == -1 || errno) {
+    // stdin 不缓冲：与read-line的行编辑共用终端
+    int64_t ch = fd != 0 ? detail::file::read_byte(fd) : detail::readbyte(fd);
+    if (ch == -1) {
         return varlisp::Nill{};
     }
 
     return ch;
 }
 
+REGIST_BUILTIN("fd-buffer-size", 0, 1, eval_fd_buffer_size,
+               "; fd-buffer-size 获取、设置read-line、read-char、read-byte 读缓冲的大小(字节)；\n"
+               "; 只影响之后首次读取的fd\n"
+               "(fd-buffer-size) -> int64_t\n"
+               "(fd-buffer-size size) -> int64_t");
+
+/**
+ * @brief
+ *    (fd-buffer-size) -> int64_t
+ *    (fd-buffer-size size) -> int64_t
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return 当前设置
+ */
+Object eval_fd_buffer_size(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "fd-buffer-size";
+    if (args.length() != 0U) {
+        std::array<Object, 1> objs;
+        int64_t size = *requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+        if (size < 1) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": size must be positive; but ",
+                               size, ")");
+        }
+        detail::file::reader_buffer_size() = size_t(size);
+    }
+    return int64_t(detail::file::reader_buffer_size());
+}
+
+namespace detail {
+
+// 按行惰性读取：每次产生一行(不含'\n')。
+// 自行打开的文件，独占读缓冲，生成器释放时关闭；
+// 外部传入的fd，与read-line等共用该fd的读缓冲(见detail::file::get_reader)。
+struct file_lines_generator_t : public varlisp::LazySeq::generator_t
+{
+    file_lines_generator_t(int fd, bool own_fd, std::string name)
+        : m_fd(fd),
+          m_own_fd(own_fd),
+          m_name(std::move(name))
+    {
+        if (m_own_fd) {
+            m_reader.reset(new buffered_reader_t(fd));
+        }
+    }
+
+    ~file_lines_generator_t() override
+    {
+        if (m_own_fd) {
+            ::close(m_fd);
+        }
+    }
+
+    bool next(Object& out) override
+    {
+        buffered_reader_t& reader = m_reader ? *m_reader : file::get_reader(m_fd);
+        sss::string_view line;
+        if (!reader.next_line(line)) {
+            return false;
+        }
+        ++m_line_no;
+        string_t str;
+        str = std::string(line.data(), line.size());
+        out = std::move(str);
+        return true;
+    }
+
+    void print(std::ostream& o) const override
+    {
+        o << "file-lines:" << m_name << ":" << m_line_no;
+    }
+
+    int                                 m_fd;
+    bool                                m_own_fd;
+    std::string                         m_name;
+    std::unique_ptr<buffered_reader_t>  m_reader;
+    int64_t                             m_line_no = 0;
+};
+
+}  // namespace detail
+
+REGIST_BUILTIN("file-lines", 1, 1, eval_file_lines,
+               "; file-lines 按行惰性读取文件，返回lazy-seq；每个元素是一行(不含换行符)；\n"
+               "; 以大块缓冲读取，内存占用与文件大小无关；\n"
+               "; 可用于for、map、filter、reduce、is-any等；只能遍历一遍，提前结束即不再读取\n"
+               "(file-lines \"path/to/file\") -> lazy-seq\n"
+               "(file-lines fd) -> lazy-seq");
+
+/**
+ * @brief
+ *    (file-lines "path/to/file") -> lazy-seq
+ *    (file-lines fd) -> lazy-seq
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return lazy-seq
+ */
+Object eval_file_lines(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "file-lines";
+    Object tmp;
+
+    const Object& resRef = varlisp::getAtomicValue(env, args.nth(0), tmp);
+    if (const string_t* p_path = boost::get<varlisp::string_t>(&resRef)) {
+        std::string full_path = sss::path::full_of_copy(*p_path->gen_shared());
+        if (sss::path::file_exists(full_path) != sss::PATH_TO_FILE) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
+                               "` not to file)");
+        }
+        int fd = ::open(full_path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
+                               "` ", std::strerror(errno), ")");
+        }
+        return varlisp::LazySeq(
+            std::make_shared<detail::file_lines_generator_t>(fd, true, full_path));
+    }
+    if (const int64_t* p_fd = boost::get<int64_t>(&resRef)) {
+        return varlisp::LazySeq(std::make_shared<detail::file_lines_generator_t>(
+            int(*p_fd), false, "fd" + std::to_string(*p_fd)));
+    }
+    SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", resRef,
+                       "` must be path/to/file:string or fd:int to already opened file)");
+}
+
 REGIST_BUILTIN("write-char", 2, 2, eval_write_char,
                "(write-char file_descriptor int64_t) -> int64_t | nill");
 
@@ -430,6 +651,7 @@ Object eval_write_char(varlisp::Environment& env, const varlisp::List& args)
     const auto* p_ch =
         requireTypedValue<int64_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
+    detail::file::sync_reader(*p_fd);
     int64_t ec = detail::writechar(*p_fd, *p_ch);
     return (ec == -1) ? Object{varlisp::Nill{}} : Object{ec};
 }
@@ -455,12 +677,14 @@ Object eval_write_byte(varlisp::Environment& env, const varlisp::List& args)
     const auto* p_ch =
         requireTypedValue<int64_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
+    detail::file::sync_reader(*p_fd);
     int64_t ec = detail::writebyte(*p_fd, *p_ch);
     return (ec == -1) ? Object{varlisp::Nill{}} : Object{ec};
 }
 
 REGIST_BUILTIN("write-string", 2, 2, eval_write_string,
-               "(write-string file_descriptor string) -> int64_t | nill");
+               "(write-string file_descriptor string) -> int64_t | nill\n"
+               "(write-string file_descriptor string-builder) -> int64_t | nill");
 
 /**
  * @brief (write-string file_descriptor int64_t) -> int64_t | nill
@@ -477,10 +701,19 @@ Object eval_write_string(varlisp::Environment& env, const varlisp::List& args)
     const auto* p_fd =
         requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
-    const auto* p_str =
-        requireTypedValue<string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
+    const Object& strRef = getAtomicValue(env, args.nth(1), objs[1]);
+    sss::string_view content;
+    if (const auto* p_sb = boost::get<varlisp::StringBuilder>(&strRef)) {
+        content = p_sb->to_string_view();
+    }
+    else {
+        const auto* p_str = boost::get<string_t>(&strRef);
+        requireOnFaild<string_t>(p_str, funcName, 1, DEBUG_INFO);
+        content = p_str->to_string_view();
+    }
 
-    int64_t ec = detail::writestring(*p_fd, p_str->to_string_view());
+    detail::file::sync_reader(*p_fd);
+    int64_t ec = detail::writestring(*p_fd, content);
     return (ec == -1) ? Object{varlisp::Nill{}} : Object{ec};
 }
 
@@ -1,4 +1,7 @@
 #include <array>
+#include <chrono>
+#include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
@@ -22,9 +25,11 @@
 #include "../detail/car.hpp"
 #include "../detail/file.hpp"
 #include "../detail/html.hpp"
+#include "../detail/html2md.hpp"
 #include "../detail/http.hpp"
 #include "../detail/io.hpp"
 #include "../detail/list_iterator.hpp"
+#include "../detail/selector_cache.hpp"
 
 namespace varlisp {
 
@@ -57,7 +62,7 @@ Object eval_gumbo(varlisp::Environment& env, const varlisp::List& args)
     if (p_content->empty()) {
         return Object{Nill{}};
     }
-    gumboNode doc{p_content->gen_shared()};
+    gumboNode doc{*p_content};
     if (doc.valid()) {
         if (p_query && p_query->length()) {
             std::vector<gumboNode> vec = doc.find(*p_query->gen_shared());
@@ -174,6 +179,82 @@ Object eval_gumbo_query(varlisp::Environment& env, const varlisp::List& args)
     return ret_nodes;
 }
 
+REGIST_BUILTIN("gumbo-query-batch", 2, 2, eval_gumbo_query_batch,
+               "; gumbo-query-batch 一次遍历，同时执行多个选择器；\n"
+               "; 结果与对各选择器分别gumbo-query相同，按选择器的顺序返回\n"
+               "(gumbo-query-batch gumboNode '(\"selector-string\"...))\n"
+               " -> '('(gumboNodes)...)");
+
+/**
+ * @brief
+ *      (gumbo-query-batch gumboNode '("selector-string"...))
+ *           -> '('(gumboNodes)...)
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_gumbo_query_batch(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "gumbo-query-batch";
+    std::array<Object, 2> objs;
+    const auto* p_node =
+        requireTypedValue<gumboNode>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    const varlisp::List * p_list = varlisp::getQuotedList(env, args.nth(1), objs[1]);
+    if (p_list == nullptr) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                           ": need quote list as the 2nd argument)");
+    }
+    std::vector<std::string> queries;
+    queries.reserve(p_list->size());
+    for (const auto& it : *p_list) {
+        Object tmp;
+        const auto* p_query = getTypedValue<varlisp::string_t>(env, it, tmp);
+        if (p_query == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": selector must be string; but ", it, ")");
+        }
+        queries.emplace_back(p_query->data(), p_query->size());
+    }
+
+    std::vector<std::vector<gumboNode>> results;
+    try {
+        results = p_node->find_batch(queries);
+    }
+    catch (const std::string& msg) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", msg, ")");
+    }
+
+    varlisp::List ret = varlisp::List::makeSQuoteList();
+    auto * p_ret = ret.get_slist();
+    for (auto& nodes : results) {
+        varlisp::List ret_nodes;
+        for (auto& item : nodes) {
+            ret_nodes.append(Object(std::move(item)));
+        }
+        p_ret->append(Object(varlisp::List::makeSQuoteObj(ret_nodes)));
+    }
+    return ret;
+}
+
+REGIST_BUILTIN("gumbo-selector-cache-stat", 0, 0, eval_gumbo_selector_cache_stat,
+               "; gumbo-selector-cache-stat 已解析选择器的LRU缓存统计\n"
+               "(gumbo-selector-cache-stat) -> {(hits int) (misses int) (evictions int) (size int) (capacity int)}");
+
+Object eval_gumbo_selector_cache_stat(varlisp::Environment& /*env*/, const varlisp::List& /*args*/)
+{
+    const auto stat = detail::selector_cache::get_stat();
+    Environment ret;
+    ret["hits"] = stat.hits;
+    ret["misses"] = stat.misses;
+    ret["evictions"] = stat.evictions;
+    ret["size"] = int64_t(detail::selector_cache::size());
+    ret["capacity"] = int64_t(detail::selector_cache::get_capacity());
+    return Object(std::move(ret));
+}
+
 REGIST_BUILTIN("gumbo-children", 1, 1, eval_gumbo_children,
                "; gumbo-children 枚举子节点；"
                "; 相当于更快的(gumbo-query gnode \"*\")\n"
@@ -274,6 +355,7 @@ Object eval_gqnode_hasAttr(varlisp::Environment& env, const varlisp::List& args)
 }
 
 using gbNodeMethod_t = std::string (gumboNode::*)() const;
+using gbNodeViewMethod_t = String (gumboNode::*)() const;
 
 struct gumboNodeMethodWrapper {
     gumboNodeMethodWrapper(const char* funcName, gbNodeMethod_t m)
@@ -281,6 +363,12 @@ struct gumboNodeMethodWrapper {
     {
     }
 
+    // 返回源文本视图的方法
+    gumboNodeMethodWrapper(const char* funcName, gbNodeViewMethod_t m)
+        : m_funcName(funcName), m_view_method(m)
+    {
+    }
+
 public:
     Object operator()(varlisp::Environment& env, const varlisp::List& args)
     {
@@ -288,6 +376,9 @@ public:
         const auto* p_gqnode =
             requireTypedValue<gumboNode>(env, args.nth(0), gqnode, m_funcName, 0, DEBUG_INFO);
         if (p_gqnode->valid()) {
+            if (m_view_method != nullptr) {
+                return (p_gqnode->*m_view_method)();
+            }
             return string_t((p_gqnode->*m_method)());
         }
         return Object{Nill{}};
@@ -295,7 +386,8 @@ public:
 
 private:
     const char* m_funcName;
-    gbNodeMethod_t m_method;
+    gbNodeMethod_t m_method = nullptr;
+    gbNodeViewMethod_t m_view_method = nullptr;
 };
 
 REGIST_BUILTIN("gqnode-valid", 1, 1, eval_gqnode_valid,
@@ -345,6 +437,8 @@ Object eval_gqnode_isText(varlisp::Environment& env, const varlisp::List& args)
 }
 
 REGIST_BUILTIN("gqnode-text", 1, 1, eval_gqnode_text,
+               "; gqnode-text 节点的文本；源文本中连续、无需转换时，\n"
+               "; 直接返回源文本的视图，不复制\n"
                "(gqnode-text gumboNode) -> \"text\"");
 
 /**
@@ -359,7 +453,7 @@ REGIST_BUILTIN("gqnode-text", 1, 1, eval_gqnode_text,
 Object eval_gqnode_text(varlisp::Environment& env, const varlisp::List& args)
 {
     const char* funcName = "gqnode-text";
-    return gumboNodeMethodWrapper(funcName, &gumboNode::text)(env, args);
+    return gumboNodeMethodWrapper(funcName, &gumboNode::textView)(env, args);
     // Object gqnode;
     // const gumboNode* p_gqnode =
     //     varlisp::getTypedValue<gumboNode>(env, detail::car(args), gqnode);
@@ -521,6 +615,46 @@ Object eval_gqnode_outerHtml(varlisp::Environment& env,
     // return Object{Nill{}};
 }
 
+REGIST_BUILTIN("gqnode-innerSource", 1, 1, eval_gqnode_innerSource,
+               "; gqnode-innerSource 源文本中，节点标签之间的原始html；\n"
+               "; 返回源文本的视图，不复制；标签是解析时补全的，则同gqnode-innerHtml\n"
+               "(gqnode-innerSource gumboNode) -> \"html\"");
+
+/**
+ * @brief
+ *      (gqnode-innerSource gumboNode) -> "html"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_gqnode_innerSource(varlisp::Environment& env,
+                               const varlisp::List& args)
+{
+    return gumboNodeMethodWrapper("gqnode-innerSource", &gumboNode::innerSource)(env, args);
+}
+
+REGIST_BUILTIN("gqnode-outerSource", 1, 1, eval_gqnode_outerSource,
+               "; gqnode-outerSource 源文本中，节点(含标签)的原始html；\n"
+               "; 返回源文本的视图，不复制；标签是解析时补全的，则同gqnode-outerHtml\n"
+               "(gqnode-outerSource gumboNode) -> \"html\"");
+
+/**
+ * @brief
+ *      (gqnode-outerSource gumboNode) -> "html"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_gqnode_outerSource(varlisp::Environment& env,
+                               const varlisp::List& args)
+{
+    return gumboNodeMethodWrapper("gqnode-outerSource", &gumboNode::outerSource)(env, args);
+}
+
 REGIST_BUILTIN("gumbo-query-text",2,  2,  eval_gumbo_query_text,
                "(gumbo-query-text \"<html>\" \"selector-string\") \"node->text\"");
 
@@ -547,12 +681,49 @@ Object eval_gumbo_query_text(varlisp::Environment& env,
     const auto* p_query =
         requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
+    // NOTE 同ss1x::util::html::queryText()；选择器经selector_cache复用
     std::ostringstream oss;
-    ss1x::util::html::queryText(oss, *p_content->gen_shared(), *p_query->gen_shared());
+    gumboNode doc{*p_content};
+    for (const auto& node : doc.find(*p_query->gen_shared())) {
+        oss << node.textNeat();
+    }
 
     return string_t(oss.str());
 }
 
+REGIST_BUILTIN("html2md", 1, 1, eval_html2md,
+               "; html2md 把html转换为markdown文本；规则大致同html2text\n"
+               "; 支持标题、段落、列表、链接、图片、代码、引用、表格\n"
+               "(html2md gumboNode) -> \"markdown\"\n"
+               "(html2md \"<html>\") -> \"markdown\"");
+
+/**
+ * @brief
+ *      (html2md gumboNode) -> "markdown"
+ *      (html2md "<html>") -> "markdown"
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_html2md(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "html2md";
+    Object tmp;
+    const Object& obj = varlisp::getAtomicValue(env, args.nth(0), tmp);
+    if (const auto * p_gp = boost::get<gumboNode>(&obj)) {
+        return string_t(detail::html2md::convert(*p_gp));
+    }
+    if (const auto * p_content = boost::get<varlisp::string_t>(&obj)) {
+        gumboNode doc{*p_content};
+        return string_t(detail::html2md::convert(doc));
+    }
+    SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                       ": requires gumboNode or html string as 1st argument; but ",
+                       obj, ")");
+}
+
 REGIST_BUILTIN("gumbo-original-rewrite", 0, 1, eval_gumbo_original_rewrite,
                "; gumbo-original-rewrite 是否按原始格式，重写html文本\n"
                "; 获取该设定值，或者修改该值；默认否(#f)\n"
@@ -572,14 +743,46 @@ Object eval_gumbo_original_rewrite(varlisp::Environment& env, const varlisp::Lis
     return detail::html::get_rewrite_original();
 }
 
+REGIST_BUILTIN("gumbo-prefetch-concurrency", 0, 1, eval_gumbo_prefetch_concurrency,
+               "; gumbo-prefetch-concurrency gumbo-rewrite并发下载资源时，最多使用的线程数\n"
+               "; 获取该设定值，或者修改该值；默认8\n"
+               "(gumbo-prefetch-concurrency) -> int\n"
+               "(gumbo-prefetch-concurrency int) -> int");
+
+Object eval_gumbo_prefetch_concurrency(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "gumbo-prefetch-concurrency";
+    if (args.length() != 0U) {
+        std::array<Object, 1> objs;
+        const auto* p_cnt =
+            requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+        if (*p_cnt <= 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": concurrency must be positive; but ", *p_cnt, ")");
+        }
+        detail::html::get_prefetch_concurrency() = size_t(*p_cnt);
+    }
+
+    return int64_t(detail::html::get_prefetch_concurrency());
+}
+
 REGIST_BUILTIN("gumbo-rewrite", 2,  -1,  eval_gumbo_rewrite,
                "gumbo-rewrite 重写gumbo-node到指定文件描述符中\n"
                "注意，链接等会被改写\n"
                "文件名，如何确定？\n"
-               "(gumbo-rewrite int-fd '(gq-node) "") -> nil\n"
-               "(gumbo-rewrite int-fd {request_header} '(gq-node) "") -> nil"
-               "(gumbo-rewrite [int-fd proxy-domain proxy-port] '(gq-node) "") -> nil\n"
-               "(gumbo-rewrite [int-fd proxy-domain proxy-port] {request_header} '(gq-node) "") -> nil"
+               "引用的图片、脚本、样式表等，先收集url并发下载，再重写；\n"
+               "返回下载、重写的统计(以前返回nil)：\n"
+               ";   urls       需要下载的url数(已去重)\n"
+               ";   fetched    成功取得的url数\n"
+               ";   failed     下载失败的url数\n"
+               ";   fetch-ms   并发下载的总耗时\n"
+               ";   total-ms   各url下载耗时之和\n"
+               ";   slowest-ms 最慢的一个url的耗时\n"
+               ";   rewrite-ms 重写输出的耗时\n"
+               "(gumbo-rewrite int-fd '(gq-node) \"\") -> {stat}\n"
+               "(gumbo-rewrite int-fd {request_header} '(gq-node) \"\") -> {stat}\n"
+               "(gumbo-rewrite [int-fd proxy-domain proxy-port] '(gq-node) \"\") -> {stat}\n"
+               "(gumbo-rewrite [int-fd proxy-domain proxy-port] {request_header} '(gq-node) \"\") -> {stat}"
                );
 
 Object eval_gumbo_rewrite(varlisp::Environment& env, const varlisp::List& args)
@@ -629,13 +832,17 @@ Object eval_gumbo_rewrite(varlisp::Environment& env, const varlisp::List& args)
     // 在重写的时候，如何处理重复的url？
     // 需要建立一个url与本地path的对应关系；同时，需要备注上下载状态；
 
-    detail::html::resource_manager_t rs_mgr;
+    // NOTE 分两遍：先收集所有待输出的节点及其引用的资源url，并发下载；
+    // 再逐个重写输出——此时资源都已在rs_mgr中，不必边遍历边下载。
+    std::vector<Object> items;      // gumboNode，或者原样输出的对象
+    std::vector<std::string> urls;
     for (size_t i = 1; i < args.length(); ++i) {
         const auto& secondRef = varlisp::getAtomicValue(env, args.nth(i), objs[1]);
         if (i == 1) {
-            if (const auto * p_request_header = boost::get<varlisp::Environment>(&secondRef)) {
+            Object tmpHeader;
+            if (const auto request_info = varlisp::getEnvironmentOrDict(env, secondRef, tmpHeader)) {
                 varlisp::detail::http::Environment2ss1x_header(
-                    request_header, env, *p_request_header);
+                    request_header, env, request_info);
                 continue;
             }
         }
@@ -646,35 +853,61 @@ Object eval_gumbo_rewrite(varlisp::Environment& env, const varlisp::List& args)
             for (const auto & it : *p_list) {
                 const auto * p_gp = varlisp::getTypedValue<gumboNode>(env, it, gpNodeObj);
                 if (p_gp == nullptr) {
-                    std::ostringstream oss;
-                    boost::apply_visitor(raw_stream_visitor(oss, env), it);
-                    detail::writestring(fd, oss.str());
+                    items.emplace_back(it);
                 }
                 else {
-                    detail::html::gumbo_rewrite_impl(fd, *p_gp, output_dir,
-                                                     rs_mgr, request_header,
-                                                     proxy_domain, proxy_port);
+                    detail::html::collect_resource_urls(*p_gp, urls);
+                    items.emplace_back(*p_gp);
                 }
             }
         }
         else if (const auto * p_gp = varlisp::getTypedValue<gumboNode>(env, secondRef, gpNodeObj)) {
+            detail::html::collect_resource_urls(*p_gp, urls);
+            items.emplace_back(*p_gp);
+        }
+        else {
+            items.emplace_back(secondRef);
+        }
+    }
+
+    detail::html::resource_manager_t rs_mgr;
+    auto stat = detail::html::prefetch_resources(urls, output_dir, rs_mgr, request_header);
+
+    auto rewrite_beg = std::chrono::steady_clock::now();
+    for (const auto& item : items) {
+        if (const auto * p_gp = boost::get<gumboNode>(&item)) {
             detail::html::gumbo_rewrite_impl(fd, *p_gp, output_dir, rs_mgr,
                                              request_header,
                                              proxy_domain, proxy_port);
         }
         else {
             std::ostringstream oss;
-            boost::apply_visitor(raw_stream_visitor(oss, env), secondRef);
+            boost::apply_visitor(raw_stream_visitor(oss, env), item);
             detail::writestring(fd, oss.str());
         }
     }
+    auto rewrite_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - rewrite_beg).count();
+
+    int64_t failed = 0;
     for (const auto& kv : rs_mgr) {
         if (!kv.second.is_ok()) {
             COLOG_ERROR(sss::raw_string(kv.first), kv.second);
+            ++failed;
         }
     }
-
-    return Nill{};
+    COLOG_INFO(funcName, SSS_VALUE_MSG(stat.urls), SSS_VALUE_MSG(stat.wall_us / 1000.0),
+               SSS_VALUE_MSG(stat.slowest_us / 1000.0), SSS_VALUE_MSG(rewrite_us / 1000.0));
+
+    varlisp::Environment ret;
+    ret["urls"]       = stat.urls;
+    ret["fetched"]    = stat.fetched;
+    ret["failed"]     = failed;
+    ret["fetch-ms"]   = double(stat.wall_us) / 1000.0;
+    ret["total-ms"]   = double(stat.total_us) / 1000.0;
+    ret["slowest-ms"] = double(stat.slowest_us) / 1000.0;
+    ret["rewrite-ms"] = double(rewrite_us) / 1000.0;
+    return Object(std::move(ret));
 }
 
 }  // namespace varlisp
@@ -121,9 +121,9 @@ Object eval_http_get(varlisp::Environment& env, const varlisp::List& args)
     }
     if (args.length() == 2 || args.length() == 4) {
         auto rh_index = args.length() - 1;
-        const auto * p_request_header =
-            requireTypedValue<varlisp::Environment>(env, args.nth(rh_index), objs[rh_index], funcName, rh_index, DEBUG_INFO);
-        varlisp::detail::http::Environment2ss1x_header(request_header, env, *p_request_header);
+        const auto request_info =
+            requireEnvironmentOrDict(env, args.nth(rh_index), objs[rh_index], funcName, rh_index, DEBUG_INFO);
+        varlisp::detail::http::Environment2ss1x_header(request_header, env, request_info);
     }
 
     ss1x::http::Headers headers;
@@ -233,9 +233,9 @@ Object eval_http_post(varlisp::Environment& env, const varlisp::List& args)
     }
     if (args.length() == 3 || args.length() == 5) {
         auto rh_index = args.length() - 1;
-        const auto * p_request_header =
-            requireTypedValue<varlisp::Environment>(env, args.nth(rh_index), objs[rh_index], funcName, rh_index, DEBUG_INFO);
-        varlisp::detail::http::Environment2ss1x_header(request_header, env, *p_request_header);
+        const auto request_info =
+            requireEnvironmentOrDict(env, args.nth(rh_index), objs[rh_index], funcName, rh_index, DEBUG_INFO);
+        varlisp::detail::http::Environment2ss1x_header(request_header, env, request_info);
     }
 
     ss1x::http::Headers headers;
@@ -1,39 +1,52 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
+#include <sss/colorlog.hpp>
+#include <sss/path.hpp>
+#include <sss/utlstring.hpp>
 #include <sss/util/PostionThrow.hpp>
 
 #include "../object.hpp"
 
 #include "../builtin_helper.hpp"
+#include "../detail/buffered_reader.hpp"
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
+#include "../detail/file.hpp"
 #include "../detail/json.hpp"
+#include "../detail/list_iterator.hpp"
 #include "../json/parser.hpp"
+#include "../json/writer.hpp"
 #include "../json_print_visitor.hpp"
 
 namespace varlisp {
 
 namespace detail {
-void json_object2stream(std::ostream& o, varlisp::Environment& env,
-                        const Object& obj, const char* funcName, bool indent)
+const Object& json_object_ref(varlisp::Environment& env, const Object& obj,
+                              Object& tmp, const char* funcName)
 {
-    Object tmp;
     const Object& objRef = varlisp::getAtomicValue(env, obj, tmp);
     if ((boost::get<varlisp::Environment>(&objRef) == nullptr) &&
+        (boost::get<varlisp::Dict>(&objRef) == nullptr) &&
         (boost::get<varlisp::List>(&objRef) == nullptr))
     {
         SSS_POSITION_THROW(std::runtime_error,
-                           "(", funcName, ": only Environment type or s-list type is valid; but ",
+                           "(", funcName, ": only Environment, dict or s-list type is valid; but ",
                            objRef, ")");
     }
-    boost::apply_visitor(json_print_visitor(o, indent), objRef);
+    return objRef;
 }
 
 } // namespace detail
 
 REGIST_BUILTIN("json-print", 1, 2, eval_json_print,
                "; json-print 用json格式，打印內建对象；\n"
-               "; 注意，仅支持list和env\n"
+               "; 注意，仅支持list、dict和env\n"
                "(json-print obj boolean) -> nil");
 
 Object eval_json_print(varlisp::Environment& env, const varlisp::List& args)
@@ -45,42 +58,93 @@ Object eval_json_print(varlisp::Environment& env, const varlisp::List& args)
         indent = *requireTypedValue<bool>(env, args.nth(1), objs[0], funcName,
                                           1, DEBUG_INFO);
     }
-    detail::json_object2stream(std::cout, env, detail::car(args), funcName, indent);
+    Object tmp;
+    const Object& objRef = detail::json_object_ref(env, detail::car(args), tmp, funcName);
+    std::string out = json::to_string(objRef, indent);
+    std::cout.write(out.data(), out.size());
     return Nill{};
 }
 
-REGIST_BUILTIN("json-string", 1, 2, eval_json_string,
+REGIST_BUILTIN("json-string", 1, 3, eval_json_string,
                "; json-string 用json格式，序列化內建对象；\n"
-               "; 注意，仅支持list和env\n"
-               "(json-string obj boolean) -> nil");
+               "; 注意，仅支持list、dict和env\n"
+               "; 提供string-builder时，直接追加到其末尾，并返回它\n"
+               "(json-string obj boolean) -> nil\n"
+               "(json-string obj boolean string-builder) -> string-builder");
 
 Object eval_json_string(varlisp::Environment& env, const varlisp::List& args)
 {
     const char * funcName = "json-string";
-    std::ostringstream oss;
     bool indent = false;
     if (args.length() >= 2) {
         std::array<Object, 1> objs;
         indent = *requireTypedValue<bool>(env, args.nth(1), objs[0], funcName,
                                           1, DEBUG_INFO);
     }
-    detail::json_object2stream(oss, env, detail::car(args), funcName, indent);
-    return string_t{oss.str()};
+    Object tmp;
+    const Object& objRef = detail::json_object_ref(env, detail::car(args), tmp, funcName);
+    if (args.length() >= 3) {
+        Object sbTmp;
+        const auto* p_sb = requireTypedValue<varlisp::StringBuilder>(
+            env, args.nth(2), sbTmp, funcName, 2, DEBUG_INFO);
+        p_sb->reserve_more(json::estimate_size(objRef, indent));
+        // NOTE 借用builder的缓冲区作为Writer的输出，避免中间字符串
+        json::Writer w(indent);
+        w.buffer().swap(p_sb->buffer());
+        try {
+            w.write(objRef);
+        }
+        catch (...) {
+            w.buffer().swap(p_sb->buffer());
+            throw;
+        }
+        w.buffer().swap(p_sb->buffer());
+        return *p_sb;
+    }
+    return string_t{json::to_string(objRef, indent)};
 }
 
-REGIST_BUILTIN("json-parse", 1, 1, eval_json_parse,
+REGIST_BUILTIN("json-write", 2, 3, eval_json_write,
+               "; json-write 用json格式，序列化內建对象，并直接写入fd；\n"
+               "; 分块写出，适用于超大输出；返回写出的字节数\n"
+               "(json-write fd obj) -> int64_t\n"
+               "(json-write fd obj boolean) -> int64_t");
+
+Object eval_json_write(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "json-write";
+    std::array<Object, 3> objs;
+    int fd = *requireTypedValue<int64_t>(env, args.nth(0), objs[0], funcName,
+                                         0, DEBUG_INFO);
+    const Object& objRef = detail::json_object_ref(env, args.nth(1), objs[1], funcName);
+    bool indent = false;
+    if (args.length() >= 3) {
+        indent = *requireTypedValue<bool>(env, args.nth(2), objs[2], funcName,
+                                          2, DEBUG_INFO);
+    }
+    return json::write_fd(fd, objRef, indent);
+}
+
+REGIST_BUILTIN("json-parse", 1, 2, eval_json_parse,
                "; json-parse 用json格式，解释字符串参数，并返回解析后的对象；\n"
-               "; 如果解析成功返回list或者env；如果失败，返回nil\n"
-               "(json-parse \"string\") -> list | env | nil");
+               "; 如果解析成功返回list或者dict；如果失败，返回nil\n"
+               "; intern为true时，相同的字符串值共享同一缓冲区(见string-intern)\n"
+               "(json-parse \"string\") -> list | dict | nil\n"
+               "(json-parse \"string\" intern) -> list | dict | nil");
 
 Object eval_json_parse(varlisp::Environment& env, const varlisp::List& args)
 {
     const char * funcName = "json-parse";
-    Object obj;
+    std::array<Object, 2> objs;
     const auto * p_s =
-        requireTypedValue<string_t>(env, args.nth(0), obj, funcName, 0, DEBUG_INFO);
+        requireTypedValue<string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    bool intern = false;
+    if (args.length() >= 2) {
+        intern = *requireTypedValue<bool>(env, args.nth(1), objs[1], funcName,
+                                          1, DEBUG_INFO);
+    }
 
-    return json::parse(p_s->to_string_view());
+    return json::parse(p_s->to_string_view(), intern);
 }
 
 REGIST_BUILTIN("json-indent", 1, 1, eval_json_indent,
@@ -100,4 +164,182 @@ Object eval_json_indent(varlisp::Environment& env, const varlisp::List& args)
     return string_t(varlisp::detail::json::get_json_indent());
 }
 
+namespace detail {
+
+// NDJSON(json-lines)生成器：每次从fd读入一行，并解析为一个对象；
+// 空行跳过。
+// 同file-lines：自行打开的文件，独占读缓冲；外部传入的fd，与read-line等
+// 共用该fd的读缓冲(见detail::file::get_reader)，交替读取时不丢数据。
+struct json_lines_generator_t : public varlisp::LazySeq::generator_t
+{
+    json_lines_generator_t(int fd, bool own_fd, std::string name,
+                           std::vector<std::string> fields)
+        : m_fd(fd),
+          m_own_fd(own_fd),
+          m_name(std::move(name)),
+          m_fields(std::move(fields))
+    {
+        if (m_own_fd) {
+            m_reader.reset(new buffered_reader_t(fd));
+        }
+    }
+
+    ~json_lines_generator_t() override
+    {
+        if (m_own_fd) {
+            ::close(m_fd);
+        }
+    }
+
+    bool next(Object& out) override
+    {
+        buffered_reader_t& reader = m_reader ? *m_reader : file::get_reader(m_fd);
+        sss::string_view line;
+        while (reader.next_line(line)) {
+            ++m_line_no;
+            sss::trim(line);
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                out = m_fields.empty() ? varlisp::json::parse(line)
+                                       : varlisp::json::parse(line, m_fields);
+            }
+            catch (std::exception& e) {
+                SSS_POSITION_THROW(std::runtime_error, "(json-lines: ", m_name,
+                                   ":", m_line_no, " ", e.what(), ")");
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void print(std::ostream& o) const override
+    {
+        o << "json-lines:" << m_name << ":" << m_line_no;
+    }
+
+    int                                 m_fd;
+    bool                                m_own_fd;
+    std::string                         m_name;
+    std::vector<std::string>            m_fields;
+    std::unique_ptr<buffered_reader_t>  m_reader;
+    int64_t                             m_line_no = 0;
+};
+
+// 从{options}中，提取(fields [...])投影设置
+std::vector<std::string> json_lines_fields(varlisp::Environment& env,
+                                           const Object& obj,
+                                           const char* funcName, size_t index)
+{
+    std::vector<std::string> fields;
+    Object tmp;
+    const auto opt = requireEnvironmentOrDict(
+        env, obj, tmp, funcName, index, DEBUG_INFO);
+    const Object* p_fields = opt.find("fields");
+    if (p_fields == nullptr) {
+        return fields;
+    }
+    Object tmpList;
+    const auto* p_list = varlisp::getQuotedList(env, *p_fields, tmpList);
+    varlisp::requireOnFaild<varlisp::QuoteList>(p_list, funcName, index, DEBUG_INFO);
+    for (const auto& item : *p_list) {
+        const auto* p_name = boost::get<varlisp::string_t>(&item);
+        if (p_name == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": fields must be string list; but ", item, ")");
+        }
+        fields.push_back(p_name->to_string());
+    }
+    return fields;
+}
+
+varlisp::LazySeq make_json_lines(const Object& source,
+                                 std::vector<std::string>&& fields,
+                                 const char* funcName)
+{
+    if (const auto* p_path = boost::get<varlisp::string_t>(&source)) {
+        std::string full_path = sss::path::full_of_copy(p_path->to_string());
+        if (sss::path::file_exists(full_path) != sss::PATH_TO_FILE) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
+                               "` not to file)");
+        }
+        int fd = ::open(full_path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", *p_path,
+                               "` ", std::strerror(errno), ")");
+        }
+        return varlisp::LazySeq(std::make_shared<json_lines_generator_t>(
+            fd, true, full_path, std::move(fields)));
+    }
+    if (const auto* p_fd = boost::get<int64_t>(&source)) {
+        return varlisp::LazySeq(std::make_shared<json_lines_generator_t>(
+            int(*p_fd), false, "fd" + std::to_string(*p_fd), std::move(fields)));
+    }
+    SSS_POSITION_THROW(std::runtime_error, "(", funcName, " `", source,
+                       "` must be path/to/file:string or fd:int to already opened file)");
+}
+
+} // namespace detail
+
+REGIST_BUILTIN("json-lines", 1, 2, eval_json_lines,
+               "; json-lines 按行(NDJSON)惰性解析文件；每行一个json对象；\n"
+               "; 以大块缓冲读取，不会一次性载入整个文件；\n"
+               "; 返回的lazy-seq，可用于for循环，或者json-lines-fold；只能遍历一遍\n"
+               "; options 目前支持：\n"
+               ";   (fields [\"key\"...]) 仅解码最外层对象中，列出的键\n"
+               "; fd参数与read-line等共用该fd的读缓冲，可交替读取\n"
+               "(json-lines fd) -> lazy-seq\n"
+               "(json-lines \"path/to/file\") -> lazy-seq\n"
+               "(json-lines \"path/to/file\" {options}) -> lazy-seq");
+
+Object eval_json_lines(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "json-lines";
+    std::array<Object, 1> objs;
+    const Object& source = varlisp::getAtomicValue(env, args.nth(0), objs[0]);
+
+    std::vector<std::string> fields;
+    if (args.length() >= 2) {
+        fields = detail::json_lines_fields(env, args.nth(1), funcName, 1);
+    }
+    return detail::make_json_lines(source, std::move(fields), funcName);
+}
+
+REGIST_BUILTIN("json-lines-fold", 3, 4, eval_json_lines_fold,
+               "; json-lines-fold 对json-lines中的每条记录，累积调用func；\n"
+               "; 即 (func (func init rec1) rec2) ...；\n"
+               "; 记录逐条解析，用完即弃，内存占用与文件大小无关\n"
+               "(json-lines-fold func init lazy-seq) -> result\n"
+               "(json-lines-fold func init fd|\"path/to/file\") -> result\n"
+               "(json-lines-fold func init fd|\"path/to/file\" {options}) -> result");
+
+Object eval_json_lines_fold(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "json-lines-fold";
+    std::array<Object, 3> objs;
+    const Object& callable = detail::car(args);
+    Object result = varlisp::getAtomicValue(env, args.nth(1), objs[0]);
+    const Object& source = varlisp::getAtomicValue(env, args.nth(2), objs[1]);
+
+    varlisp::LazySeq seq;
+    if (const auto* p_seq = boost::get<varlisp::LazySeq>(&source)) {
+        seq = *p_seq;
+    }
+    else {
+        std::vector<std::string> fields;
+        if (args.length() >= 4) {
+            fields = detail::json_lines_fields(env, args.nth(3), funcName, 3);
+        }
+        seq = detail::make_json_lines(source, std::move(fields), funcName);
+    }
+
+    Object record;
+    while (seq.next(record)) {
+        varlisp::List expr = varlisp::List({callable, result, record});
+        result = expr.eval(env);
+    }
+    return result;
+}
+
 } // namespace varlisp
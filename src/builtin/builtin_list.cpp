@@ -172,6 +172,11 @@ Object eval_length(varlisp::Environment& env, const varlisp::List& args)
                                                               obj)) {
         return int64_t(p_env->size());
     }
+    if (const auto* p_dict =
+                 varlisp::getTypedValue<varlisp::Dict>(env, detail::car(args),
+                                                       obj)) {
+        return int64_t(p_dict->size());
+    }
     SSS_POSITION_THROW(std::runtime_error, "(", funcName,
                        ": not support on this object ", detail::car(args), ")");
 }
@@ -200,6 +205,11 @@ Object eval_empty_q(varlisp::Environment& env, const varlisp::List& args)
                                                               obj)) {
         return p_env->empty();
     }
+    if (const auto* p_dict =
+                 varlisp::getTypedValue<varlisp::Dict>(env, detail::car(args),
+                                                       obj)) {
+        return p_dict->empty();
+    }
     SSS_POSITION_THROW(std::runtime_error, "(", funcName,
                        ": not support on this object ", detail::car(args), ")");
 }
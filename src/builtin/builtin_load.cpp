@@ -14,6 +14,8 @@
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
 #include "../detail/json_accessor.hpp"
+#include "../detail/ast_cache.hpp"
+#include "../detail/heap_image.hpp"
 #include "../detail/varlisp_env.hpp"
 
 namespace varlisp {
@@ -98,15 +100,13 @@ Object eval_load(varlisp::Environment& env, const varlisp::List& args)
                           "` not to file)");
     }
 
-    std::string content;
-    sss::path::file2string(full_path, content);
     detail::load_guard_t guard(detail::get_script_stack(), varlisp::string_t(full_path));
     try {
         // NOTE FIXME 我这里的困境在于，我都是从一个地方，获取的parser实例。而parser在内部，完成的eval（传入了env，content）
         // 同一个stack。这就导致了，内部load的时候，实际也是往一个stack里面加东西——嵌套。
         // 所以，最终的 detail::load_guard_t 执行结果，不如人意。
         varlisp::Parser& parser = varlisp::Interpreter::get_instance().get_parser();
-        parser.parse(env, content, true);
+        detail::ast_cache::load(parser, env, full_path, true);
         COLOG_INFO("(", funcName, sss::raw_string(*p_path), " complete)");
         return Object{Nill{}};
     }
@@ -115,6 +115,22 @@ Object eval_load(varlisp::Environment& env, const varlisp::List& args)
     }
 }
 
+REGIST_BUILTIN("ast-cache-stat", 0, 0, eval_ast_cache_stat,
+               "; ast-cache-stat load的ast缓存统计\n"
+               "(ast-cache-stat) -> {(hits int) (misses int) (stores int) (hit_ms double) (miss_ms double)}");
+
+Object eval_ast_cache_stat(varlisp::Environment&  /*env*/, const varlisp::List&  /*args*/)
+{
+    const auto& stat = detail::ast_cache::get_stat();
+    Environment ret;
+    ret["hits"] = stat.hits;
+    ret["misses"] = stat.misses;
+    ret["stores"] = stat.stores;
+    ret["hit_ms"] = double(stat.hit_us) / 1000.0;
+    ret["miss_ms"] = double(stat.miss_us) / 1000.0;
+    return Object(std::move(ret));
+}
+
 REGIST_BUILTIN("save", 1, 1, eval_save,
                "(save \"path/to/lisp\") -> item-count");
 
@@ -194,6 +210,45 @@ Object eval_depth(varlisp::Environment&  /*env*/, const varlisp::List&  /*args*/
     return int64_t(detail::get_script_stack().size());
 }
 
+REGIST_BUILTIN("save-image", 1, 1, eval_save_image,
+               "; save-image 将当前全局环境，以二进制镜像保存\n"
+               "; 不同于save，不需要重新解析；启动时用 --image 载入\n"
+               "(save-image \"path/to/image\") -> item-count");
+
+Object eval_save_image(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "save-image";
+    std::array<Object, 1> objs;
+    const auto* p_path =
+        requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    std::string full_path = sss::path::full_of_copy(*p_path->gen_shared());
+    if (sss::path::file_exists(full_path) == sss::PATH_TO_DIRECTORY) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, "`", *p_path,
+                          "` is a dir!)");
+    }
+    return detail::image::save(*env.ceiling(), full_path);
+}
+
+REGIST_BUILTIN("load-image", 1, 1, eval_load_image,
+               "; load-image 载入save-image保存的镜像，到全局环境\n"
+               "(load-image \"path/to/image\") -> item-count");
+
+Object eval_load_image(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char* funcName = "load-image";
+    std::array<Object, 1> objs;
+    const auto* p_path =
+        requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    std::string full_path = sss::path::full_of_copy(*p_path->gen_shared());
+    if (sss::path::file_exists(full_path) != sss::PATH_TO_FILE) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, "`", *p_path,
+                          "` not to file)");
+    }
+    return detail::image::restore(*env.ceiling(), full_path);
+}
+
 REGIST_BUILTIN("clear", 0, 1, eval_clear,
                "(clear) -> item-count");
 
@@ -211,10 +266,13 @@ Object eval_clear(varlisp::Environment& env, const varlisp::List& args)
 
         auto jc = detail::json_accessor{p_sym->name()};
         auto location = jc.locate(env);
-        if (location.env == nullptr) {
+        if (location.env == nullptr && location.dict == nullptr) {
             SSS_POSITION_THROW(std::runtime_error,
                                "(", funcName, ": sym ", *p_sym, " not exist)");
         }
+        if (auto * p_dict = boost::get<varlisp::Dict>(location.obj)) {
+            return static_cast<int64_t>(p_dict->clear());
+        }
         p_target = boost::get<varlisp::Environment>(const_cast<Object*>(location.obj));
         if (p_target == nullptr) {
             SSS_POSITION_THROW(std::runtime_error,
@@ -35,6 +35,10 @@ REGIST_BUILTIN("for", 1, -1, eval_for,
                "; numeric变量的循环。\n"
                "1. (for (var s-list) expr...) ->\n"
                "\tresult-of-last-expr\n"
+               "   (for (var lazy-seq) expr...) ->\n"
+               "\tresult-of-last-expr\n"
+               "   (for (var dict) expr...) ; var = [key value]\n"
+               "\tresult-of-last-expr\n"
                "2. (for (var ini-value end-value) expr...) ->\n"
                "\tresult-of-last-expr\n"
                "3. (for (var ini-value end-value step) expr...) ->\n"
@@ -47,6 +51,16 @@ Object eval_loop_list(varlisp::Environment& env,
                       const varlisp::List& slist,
                       const varlisp::List& exprs);
 
+Object eval_loop_seq(varlisp::Environment& env,
+                     const varlisp::symbol& sym,
+                     const varlisp::LazySeq& seq,
+                     const varlisp::List& exprs);
+
+Object eval_loop_dict(varlisp::Environment& env,
+                      const varlisp::symbol& sym,
+                      const varlisp::Dict& dict,
+                      const varlisp::List& exprs);
+
 Object eval_loop_step(varlisp::Environment& env,
                       const varlisp::symbol& sym,
                       const varlisp::Object& start,
@@ -98,9 +112,18 @@ Object eval_for(varlisp::Environment& env, const varlisp::List& args)
                                ": a symbol is_needed as iterator arg; but",
                                detail::car(*p_loop_ctrl), ")");
         }
+        Object tmpRange;
+        const Object& range =
+            varlisp::getAtomicValue(env, detail::cadr(*p_loop_ctrl), tmpRange);
+        if (const auto* p_seq = boost::get<varlisp::LazySeq>(&range)) {
+            return eval_loop_seq(env, *p_sym, *p_seq, args.tail());
+        }
+        if (const auto* p_dict = boost::get<varlisp::Dict>(&range)) {
+            return eval_loop_dict(env, *p_sym, *p_dict, args.tail());
+        }
         Object tmpSList;
         const varlisp::List* p_slist = varlisp::getQuotedList(
-            env, detail::cadr(*p_loop_ctrl), tmpSList);
+            env, range, tmpSList);
         if (p_slist == nullptr) {
             SSS_POSITION_THROW(std::runtime_error, "(", funcName,
                                ": a slist is_needed as iterator range; but",
@@ -150,6 +173,44 @@ Object eval_loop_list(varlisp::Environment& env,
     return result;
 }
 
+// NOTE 逐个从lazy-seq中取值；不会物化整个序列
+Object eval_loop_seq(varlisp::Environment& env,
+                     const varlisp::symbol& sym,
+                     const varlisp::LazySeq& seq,
+                     const varlisp::List& exprs)
+{
+    varlisp::Environment inner(&env);
+    Object result;
+    Object item;
+    while (seq.next(item)) {
+        inner[sym.name()] = std::move(item);
+        for (const auto & expr : exprs)
+        {
+            result = boost::apply_visitor(eval_visitor(inner), expr);
+        }
+    }
+    return result;
+}
+
+// NOTE 按插入顺序遍历；每次迭代，var绑定为 [key value]
+Object eval_loop_dict(varlisp::Environment& env,
+                      const varlisp::symbol& sym,
+                      const varlisp::Dict& dict,
+                      const varlisp::List& exprs)
+{
+    varlisp::Environment inner(&env);
+    Object result;
+    for (const auto & it : dict) {
+        inner[sym.name()] =
+            varlisp::List::makeSQuoteList(string_t(it.first), it.second);
+        for (const auto & expr : exprs)
+        {
+            result = boost::apply_visitor(eval_visitor(inner), expr);
+        }
+    }
+    return result;
+}
+
 struct loop_ctrl_t
 {
 private:
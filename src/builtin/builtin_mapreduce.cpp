@@ -1,4 +1,4 @@
-#include <limits>
+#include <memory>
 #include <vector>
 
 #include <sss/colorlog.hpp>
@@ -11,6 +11,7 @@
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
 #include "../detail/list_iterator.hpp"
+#include "../detail/seq_cursor.hpp"
 
 namespace varlisp {
 
@@ -18,6 +19,7 @@ REGIST_BUILTIN("map", 2, -1, eval_map,
                "; map函数接受一个函数和N个列表，该函数接受N个参数；\n"
                "; 返回一个列表。返回列表的每个元素都是使用输入的函数\n"
                "; 对N个类别中的每个元素处理的结果\n"
+               "; 列表也可以是lazy-seq(如file-lines)，逐个取值；以最短者为准\n"
 
                "(map func list-1 list-2 ... list-n) ->\n"
                "\t'(func(l1[1] l2[1] ... ln[1])\n"
@@ -55,37 +57,41 @@ Object eval_map(varlisp::Environment &env, const varlisp::List &args)
 
     auto arg_length = args.size() - 1;
     COLOG_DEBUG(SSS_VALUE_MSG(arg_length));
-    std::vector<Object>      tmp_obj_vec;
-    tmp_obj_vec.resize(arg_length);
-    std::vector<const List*> p_arg_list_vec;
-    p_arg_list_vec.resize(arg_length);
+    // NOTE 各参数按顺序逐个取值；lazy-seq 不会被物化
+    std::vector<std::unique_ptr<detail::seq_cursor_t>> cursor_vec;
+    cursor_vec.reserve(arg_length);
 
-    int min_items_count = std::numeric_limits<int>::max();
     const List arg_list = args.tail();
-    auto arg_list_it = arg_list.begin();
-    for (auto i = 0U; i < arg_length; ++i, ++arg_list_it)
+    for (const auto& arg : arg_list)
     {
-        p_arg_list_vec[i] = varlisp::getQuotedList(env, *arg_list_it, tmp_obj_vec[i]);
-        if (p_arg_list_vec[i] == nullptr) {
+        cursor_vec.emplace_back(new detail::seq_cursor_t(env, arg));
+        if (!cursor_vec.back()->is_valid()) {
             SSS_POSITION_THROW(std::runtime_error,
-                              "(", funcName, ": the other arguments must be s-list; "
-                              " but", *arg_list_it, ")");
+                              "(", funcName, ": the other arguments must be s-list or lazy-seq; "
+                              " but", arg, ")");
         }
-        min_items_count = std::min(int(p_arg_list_vec[i]->length()), min_items_count);
     }
 
-    COLOG_DEBUG(SSS_VALUE_MSG(min_items_count));
     varlisp::List ret = varlisp::List::makeSQuoteList();
     auto ret_it = detail::list_back_inserter<Object>(ret);
     const Object& callable = detail::car(args);
-    for (int i = 0; i < min_items_count; ++i) {
+    Object item;
+    for (int i = 0; ; ++i) {
         COLOG_DEBUG("loop ", i, "begin");
         varlisp::List expr {callable};
         auto back_it = detail::list_back_inserter<Object>(expr);
 
-        for (auto j = 0U; j < arg_length; ++j) {
-            COLOG_DEBUG(SSS_VALUE_MSG(i), ',', SSS_VALUE_MSG(j), ',', p_arg_list_vec[j]->nth(i));
-            *back_it++ = p_arg_list_vec[j]->nth(i);
+        bool has_item = true;
+        for (auto& cursor : cursor_vec) {
+            if (!cursor->next(item)) {
+                has_item = false;
+                break;
+            }
+            COLOG_DEBUG(SSS_VALUE_MSG(i), ',', item);
+            *back_it++ = std::move(item);
+        }
+        if (!has_item) {
+            break;
         }
         COLOG_DEBUG(expr);
         *ret_it++ = expr.eval(env);
@@ -100,6 +106,7 @@ REGIST_BUILTIN("reduce", 2, 2, eval_reduce,
                "; reduce让一个指定的函数(function)作用于列表的第一个\n"
                "; 元素和第二个元素,然后再作用于上步得到的结果和第三个\n"
                "; 元素，直到处理完列表中所有元素。\n"
+               "; list 也可以是lazy-seq，逐个取值\n"
 
                "(reduce func list) ->\n"
                "\tfunc(func(func(l[1] l[2]) l[3]) ... l[n-1]) l[n])");
@@ -120,23 +127,22 @@ Object eval_reduce(varlisp::Environment &env, const varlisp::List &args)
     // NOTE 第一个参数是call-able；并且需要两个参数
     // 第二个参数，是不少于2个元素的s-list
     const Object& callable = detail::car(args);
-    Object tmp;
-    const List * p_arg_list = varlisp::getQuotedList(env, detail::cadr(args), tmp);
-    if (p_arg_list == nullptr) {
+    detail::seq_cursor_t cursor(env, detail::cadr(args));
+    if (!cursor.is_valid()) {
         SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": need a s-list at 2nd arguments)");
+                          "(", funcName, ": need a s-list or lazy-seq at 2nd arguments)");
     }
-    if (p_arg_list->length() < 2) {
+
+    Object first_arg;
+    Object second_arg;
+    if (!cursor.next(first_arg) || !cursor.next(second_arg)) {
         SSS_POSITION_THROW(std::runtime_error,
                           "(", funcName, ": the s-list must have at least two items)");
     }
-
-    Object first_arg = p_arg_list->head();
-    auto args_list = p_arg_list->tail();
-    for (const auto& second_arg : args_list) {
+    do {
         varlisp::List expr = varlisp::List( {callable, first_arg, second_arg});
         first_arg = expr.eval(env);
-    }
+    } while (cursor.next(second_arg));
 
     return first_arg;
 }
@@ -144,6 +150,7 @@ Object eval_reduce(varlisp::Environment &env, const varlisp::List &args)
 REGIST_BUILTIN("filter", 2, 2, eval_filter,
                "; filter 根据func作用到每个元素的返回结果是否为#t；\n"
                "; 决定是否在返回的列表中，包含该元素\n"
+               "; list 也可以是lazy-seq，逐个取值\n"
 
                "(filter func list) ->\n"
                "\t(sigma list[i] where (func list[i]) == #t)");
@@ -163,16 +170,16 @@ Object eval_filter(varlisp::Environment &env, const varlisp::List &args)
     // NOTE 第一个参数是只接受一个参数的call-able；
     // 第二个参数，是一个s-list，元素个数不定；
     const Object& callable = detail::car(args);
-    Object tmp;
-    const List * p_arg_list = varlisp::getQuotedList(env, detail::cadr(args), tmp);
-    if (p_arg_list == nullptr) {
+    detail::seq_cursor_t cursor(env, detail::cadr(args));
+    if (!cursor.is_valid()) {
         SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": need a s-list as 2nd arguments)");
+                          "(", funcName, ": need a s-list or lazy-seq as 2nd arguments)");
     }
 
     varlisp::List ret = varlisp::List::makeSQuoteList();
     auto ret_it = detail::list_back_inserter<Object>(ret);
-    for (const auto & it : *p_arg_list) {
+    Object it;
+    while (cursor.next(it)) {
         varlisp::List expr = varlisp::List({callable, it});
         Object value = expr.eval(env);
 
@@ -206,16 +213,16 @@ Object eval_transform(varlisp::Environment &env, const varlisp::List &args)
     // NOTE 第一个参数是只接受一个参数的call-able；
     // 第二个参数，是一个s-list，元素个数不定；
     const Object& callable = detail::car(args);
-    Object tmp;
-    const List * p_arg_list = varlisp::getQuotedList(env, detail::cadr(args), tmp);
-    if (p_arg_list == nullptr) {
+    detail::seq_cursor_t cursor(env, detail::cadr(args));
+    if (!cursor.is_valid()) {
         SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": need a s-list as 2nd arguments)");
+                          "(", funcName, ": need a s-list or lazy-seq as 2nd arguments)");
     }
 
     varlisp::List ret = varlisp::List::makeSQuoteList();
     auto ret_it = detail::list_back_inserter<Object>(ret);
-    for (const auto & it : *p_arg_list) {
+    Object it;
+    while (cursor.next(it)) {
         varlisp::List expr = varlisp::List({callable, it});
         Object value = expr.eval(env);
         *ret_it++ = value;
@@ -252,6 +259,7 @@ Object eval_pipe_run(varlisp::Environment &env, const varlisp::List &args)
 REGIST_BUILTIN("is-all", 2, 2, eval_is_all,
                "; is-all 用第一个参数作为函数，测试列表中，是否每个元素都符合要求\n"
                "; 都符合，返回#t; 否则返回#f\n"
+               "; 列表也可以是lazy-seq\n"
                "(is-all test-func [v1...]) -> boolean");
 
 Object eval_is_all(varlisp::Environment &env, const varlisp::List &args)
@@ -260,16 +268,17 @@ Object eval_is_all(varlisp::Environment &env, const varlisp::List &args)
     // NOTE 第一个参数是call-able；并且需要两个参数
     // 第二个参数，是不少于1个元素的s-list
     const Object& callable = detail::car(args);
-    Object tmp;
-    const List * p_arg_list = varlisp::getQuotedList(env, detail::cadr(args), tmp);
-    if ((p_arg_list == nullptr) || p_arg_list->empty()) {
+    detail::seq_cursor_t cursor(env, detail::cadr(args));
+    Object it;
+    // NOTE lazy-seq 只能在取值时，才知道是否为空
+    if (!cursor.is_valid() || !cursor.next(it)) {
         SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": need a none-empty s-list at 2nd arguments; but ",
+                          "(", funcName, ": need a none-empty s-list or lazy-seq at 2nd arguments; but ",
                           detail::cadr(args), ")");
     }
 
     bool is_all = true;
-    for (const auto & it : *p_arg_list) {
+    do {
         varlisp::List expr = varlisp::List( {callable, it});
 
         Object res = expr.eval(env);
@@ -277,7 +286,7 @@ Object eval_is_all(varlisp::Environment &env, const varlisp::List &args)
             is_all = false;
             break;
         }
-    }
+    } while (cursor.next(it));
 
     return is_all;
 }
@@ -285,24 +294,26 @@ Object eval_is_all(varlisp::Environment &env, const varlisp::List &args)
 REGIST_BUILTIN("is-any", 2, 2, eval_is_any,
                "; is-any 用第一个参数作为函数，测试列表中，是否存在某个元素符合要求\n"
                "; 如果找到一个符合的，立即返回#t; 否则返回#f\n"
+               "; 列表也可以是lazy-seq；找到后即停止取值\n"
                "(is-any test-func [v1...]) -> boolean");
 
 Object eval_is_any(varlisp::Environment &env, const varlisp::List &args)
 {
-    const char * funcName = "is-all";
+    const char * funcName = "is-any";
     // NOTE 第一个参数是call-able；并且需要两个参数
     // 第二个参数，是不少于1个元素的s-list
     const Object& callable = detail::car(args);
-    Object tmp;
-    const List * p_arg_list = varlisp::getQuotedList(env, detail::cadr(args), tmp);
-    if ((p_arg_list == nullptr) || p_arg_list->empty()) {
+    detail::seq_cursor_t cursor(env, detail::cadr(args));
+    Object it;
+    // NOTE lazy-seq 只能在取值时，才知道是否为空
+    if (!cursor.is_valid() || !cursor.next(it)) {
         SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": need a none-empty s-list at 2nd arguments; but ",
+                          "(", funcName, ": need a none-empty s-list or lazy-seq at 2nd arguments; but ",
                           detail::cadr(args), ")");
     }
 
     bool is_any = false;
-    for (const auto & it : *p_arg_list) {
+    do {
         varlisp::List expr = varlisp::List( {callable, it});
 
         Object res = expr.eval(env);
@@ -310,7 +321,7 @@ Object eval_is_any(varlisp::Environment &env, const varlisp::List &args)
             is_any = true;
             break;
         }
-    }
+    } while (cursor.next(it));
 
     return is_any;
 }
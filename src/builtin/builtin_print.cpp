@@ -19,8 +19,18 @@ void fmt_impl(std::ostream& oss, varlisp::Environment& env,
               const varlisp::List& args, const char* funcName)
 {
     std::array<Object, 1> objs;
-    const auto* p_fmt =
-        requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const Object& fmtRef = getAtomicValue(env, args.nth(0), objs[0]);
+    if (const auto* p_sb = boost::get<varlisp::StringBuilder>(&fmtRef)) {
+        // NOTE string-builder 原样输出，不作为格式串解析
+        if (args.length() > 1) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": string-builder cannot be used as fmt)");
+        }
+        oss << p_sb->to_string_view();
+        return;
+    }
+    const auto* p_fmt = boost::get<varlisp::string_t>(&fmtRef);
+    requireOnFaild<varlisp::string_t>(p_fmt, funcName, 0, DEBUG_INFO);
 
     std::vector<fmtArgInfo> fmts;
     std::vector<sss::string_view> padding;
@@ -63,7 +73,9 @@ void fmt_impl(std::ostream& oss, varlisp::Environment& env,
     }
 }
 
-REGIST_BUILTIN("io-print", 1, -1, eval_print, "(io-print \"fmt\" ...)");
+REGIST_BUILTIN("io-print", 1, -1, eval_print,
+               "(io-print \"fmt\" ...)\n"
+               "(io-print string-builder)");
 
 /**
  * @brief (io-print "fmt" ...)
@@ -156,7 +168,9 @@ REGIST_BUILTIN("format", 1, -1, eval_format,
                ";  '%' 百分号形式，打印浮点数；附带'%'\n"
                ";  'j' json紧密打印\n"
                ";  'J' json格式化打印\n"
-               "(format out-fd \"fmt\" ...) -> ...");
+               "; 如果out-fd是string-builder，则追加到其末尾，并返回它\n"
+               "(format out-fd \"fmt\" ...) -> ...\n"
+               "(format string-builder \"fmt\" ...) -> string-builder");
 
 /**
  * @brief
@@ -175,6 +189,12 @@ Object eval_format(varlisp::Environment& env, const varlisp::List& args)
     if (nullptr != boost::get<varlisp::Nill>(&fdRef)) {
         fd = 0;
     }
+    else if (const auto* p_sb = boost::get<varlisp::StringBuilder>(&fdRef)) {
+        detail::string_append_buf buf(p_sb->buffer());
+        std::ostream os(&buf);
+        fmt_impl(os, env, args.tail(), funcName);
+        return *p_sb;
+    }
     else if (const int64_t* p_fd = boost::get<int64_t>(&fdRef)) {
         if (*p_fd <= 0) {
             SSS_POSITION_THROW(std::runtime_error, "(", funcName,
@@ -184,7 +204,7 @@ Object eval_format(varlisp::Environment& env, const varlisp::List& args)
     }
     else {
         SSS_POSITION_THROW(std::runtime_error, "(", funcName,
-                           ": requies int64_t fd or nil as 1st argument)");
+                           ": requies int64_t fd, string-builder or nil as 1st argument)");
     }
 
     std::ostringstream oss;
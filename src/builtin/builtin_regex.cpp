@@ -1,9 +1,16 @@
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <array>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
 
 #include <re2/re2.h>
 
 #include <sss/colorlog.hpp>
 #include <sss/debug/value_msg.hpp>
+#include <sss/path.hpp>
 #include <sss/pretytypename.hpp>
 
 #include "../object.hpp"
@@ -12,16 +19,48 @@
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/car.hpp"
 #include "../detail/list_iterator.hpp"
+#include "../detail/buffered_reader.hpp"
+#include "../detail/regex_cache.hpp"
+#include "../detail/regex_stream.hpp"
+#include "../detail/stream_fd.hpp"
 
 namespace varlisp {
 
-REGIST_BUILTIN("regex", 1, 1, eval_regex,
+namespace detail {
+// regex对象；或者字符串——经regex_cache编译，同一pattern只编译一次
+regex_t requireRegex(varlisp::Environment& env, const Object& arg, Object& tmp,
+                     const char* funcName, size_t index, const debug_info_t& debug_info)
+{
+    const Object& ref = getAtomicValue(env, arg, tmp);
+    if (const auto* p_reg = boost::get<varlisp::regex_t>(&ref)) {
+        return *p_reg;
+    }
+    const auto* p_str = boost::get<varlisp::string_t>(&ref);
+    if (p_str == nullptr) {
+        requireOnFaild<varlisp::regex_t>(p_str, funcName, index, debug_info);
+    }
+    try {
+        return regex_cache::get(p_str->to_string_view());
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+}
+} // namespace detail
+
+REGIST_BUILTIN("regex", 1, 2, eval_regex,
                "; regex 生成基于Google/re2 的正则表达式对象\n"
                "; 完整的语法描述，见$root/re2-syntax.html 和 $root/re2-syntax.txt\n"
-               "(regex \"regex-string\") -> regex-obj");
+               "; flags 可选：i 忽略大小写；s '.'匹配换行；l 按字面值；L 最长匹配\n"
+               "; 已编译的对象按 pattern+flags 缓存，见 regex-cache-stat；\n"
+               "; 各regex-xxx函数，也可以直接传入pattern字符串\n"
+               "(regex \"regex-string\") -> regex-obj\n"
+               "(regex \"regex-string\" \"flags\") -> regex-obj");
 
 /**
- * @brief (regex "regex-string") -> regex-obj
+ * @brief
+ *      (regex "regex-string") -> regex-obj
+ *      (regex "regex-string" "flags") -> regex-obj
  *
  * @param[in] env
  * @param[in] args
@@ -31,13 +70,68 @@ REGIST_BUILTIN("regex", 1, 1, eval_regex,
 Object eval_regex(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex";
-    std::array<Object, 1> objs;
+    std::array<Object, 2> objs;
     const auto *p_regstr =
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
-    return std::make_shared<RE2>(*p_regstr);
+    uint32_t flags = detail::regex_cache::flag_none;
+    if (args.length() == 2) {
+        const auto *p_flags =
+            requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
+        if (!detail::regex_cache::parse_flags(p_flags->to_string_view(), flags)) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": unknown flags `",
+                               *p_flags, "`; expect chars of \"islL\")");
+        }
+    }
+    try {
+        return detail::regex_cache::get(p_regstr->to_string_view(), flags);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+}
+
+REGIST_BUILTIN("regex-cache-stat", 0, 0, eval_regex_cache_stat,
+               "; regex-cache-stat 已编译正则的LRU缓存统计\n"
+               "(regex-cache-stat) -> {(hits int) (misses int) (evictions int) (errors int) (size int) (capacity int)}");
+
+Object eval_regex_cache_stat(varlisp::Environment &/*env*/, const varlisp::List &/*args*/)
+{
+    const auto stat = detail::regex_cache::get_stat();
+    Environment ret;
+    ret["hits"] = stat.hits;
+    ret["misses"] = stat.misses;
+    ret["evictions"] = stat.evictions;
+    ret["errors"] = stat.errors;
+    ret["size"] = int64_t(detail::regex_cache::size());
+    ret["capacity"] = int64_t(detail::regex_cache::get_capacity());
+    return Object(std::move(ret));
+}
+
+REGIST_BUILTIN("regex-cache-capacity", 0, 1, eval_regex_cache_capacity,
+               "; regex-cache-capacity 查询/设置正则缓存的容量；0表示不缓存\n"
+               "; 设置时，返回原来的容量\n"
+               "(regex-cache-capacity) -> int\n"
+               "(regex-cache-capacity n) -> int");
+
+Object eval_regex_cache_capacity(varlisp::Environment &env, const varlisp::List &args)
+{
+    const char * funcName = "regex-cache-capacity";
+    const int64_t old_capacity = int64_t(detail::regex_cache::get_capacity());
+    if (args.length() == 1) {
+        Object tmp;
+        int64_t capacity =
+            *requireTypedValue<int64_t>(env, args.nth(0), tmp, funcName, 0, DEBUG_INFO);
+        if (capacity < 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": capacity must be non-negative; but ", capacity, ")");
+        }
+        detail::regex_cache::set_capacity(size_t(capacity));
+    }
+    return old_capacity;
 }
 
 REGIST_BUILTIN("regex-match", 2, 2, eval_regex_match,
+               "; reg-obj 也可以是pattern字符串；下同\n"
                "(regex-match reg-obj target-string) -> bool");
 
 /**
@@ -52,8 +146,9 @@ Object eval_regex_match(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex-match";
     std::array<Object, 2> objs;
-    const auto *p_regobj =
-        requireTypedValue<varlisp::regex_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const auto *p_regobj = &regobj;
 
     const auto *p_target =
         requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
@@ -76,8 +171,9 @@ Object eval_regex_search(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex-search";
     std::array<Object, 3> objs;
-    const auto *p_regobj =
-        requireTypedValue<varlisp::regex_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const auto *p_regobj = &regobj;
 
     const auto *p_target =
         requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
@@ -137,8 +233,9 @@ Object eval_regex_replace(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex-replace";
     std::array<Object, 3> tmpObjs;
-    const auto *p_regobj =
-        requireTypedValue<varlisp::regex_t>(env, args.nth(0), tmpObjs[0], funcName, 0, DEBUG_INFO);
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), tmpObjs[0], funcName, 0, DEBUG_INFO);
+    const auto *p_regobj = &regobj;
 
     const auto *p_target =
         requireTypedValue<varlisp::string_t>(env, args.nth(1), tmpObjs[1], funcName, 1, DEBUG_INFO);
@@ -245,13 +342,10 @@ REGIST_BUILTIN(
 Object eval_regex_split(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex-split";
-    Object regobj;
-    const auto *p_regobj =
-        getTypedValue<varlisp::regex_t>(env, detail::car(args), regobj);
-    if (p_regobj == nullptr) {
-        SSS_POSITION_THROW(std::runtime_error,
-                          "(", funcName, ": regex obj)");
-    }
+    Object tmp;
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, detail::car(args), tmp, funcName, 0, DEBUG_INFO);
+    const auto *p_regobj = &regobj;
 
     Object target;
     const auto *p_target =
@@ -298,8 +392,9 @@ Object eval_regex_collect(varlisp::Environment &env, const varlisp::List &args)
 {
     const char * funcName = "regex-collect";
     std::array<Object, 3> objs;
-    const auto *p_regobj =
-        requireTypedValue<varlisp::regex_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const auto *p_regobj = &regobj;
 
     if (!(*p_regobj)) {
         SSS_POSITION_THROW(std::runtime_error, "not init regex-obj!");
@@ -341,4 +436,173 @@ Object eval_regex_collect(varlisp::Environment &env, const varlisp::List &args)
     return ret;
 }
 
+namespace detail {
+regex_stream_option_t stream_option(varlisp::Environment& env, const varlisp::List& args,
+                                    size_t index, Object& tmp, const char* funcName)
+{
+    regex_stream_option_t opt;
+    opt.chunk_size = buffered_reader_t::default_buffer_size();
+    if (args.length() > index) {
+        int64_t max_match =
+            *requireTypedValue<int64_t>(env, args.nth(index), tmp, funcName, index, DEBUG_INFO);
+        if (max_match <= 0) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": max-match must be positive; but ", max_match, ")");
+        }
+        opt.max_match = size_t(max_match);
+    }
+    return opt;
+}
+} // namespace detail
+
+REGIST_BUILTIN("regex-replace-stream", 3, 5, eval_regex_replace_stream,
+               "; regex-replace-stream 同regex-replace，但按块读取in，替换结果写入out；\n"
+               "; 内存占用与文件大小无关；in、out可以是fd，或者文件路径；\n"
+               "; max-match 匹配的最大长度(字节)，默认65536；跨块的匹配，在此长度内结果正确\n"
+               "(regex-replace-stream reg-obj in out) -> replaced-count\n"
+               "(regex-replace-stream reg-obj in out fmt) -> replaced-count\n"
+               "(regex-replace-stream reg-obj in out functor) -> replaced-count\n"
+               "(regex-replace-stream reg-obj in out fmt max-match) -> replaced-count");
+
+/**
+ * @brief
+ *      (regex-replace-stream reg-obj in out) -> replaced-count
+ *      (regex-replace-stream reg-obj in out fmt|functor) -> replaced-count
+ *      (regex-replace-stream reg-obj in out fmt|functor max-match) -> replaced-count
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_regex_replace_stream(varlisp::Environment &env, const varlisp::List &args)
+{
+    const char * funcName = "regex-replace-stream";
+    std::array<Object, 5> objs;
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    detail::stream_fd_t in(getAtomicValue(env, args.nth(1), objs[1]), false, funcName, 1);
+    detail::stream_fd_t out(getAtomicValue(env, args.nth(2), objs[2]), true, funcName, 2);
+
+    re2::StringPiece fmt = "";
+    bool is_functor = false;
+    if (args.length() >= 4) {
+        const Object& obj_ref = varlisp::getAtomicValue(env, args.nth(3), objs[3]);
+        if (const string_t *p_fmt = boost::get<string_t>(&obj_ref)) {
+            fmt = *p_fmt;
+        }
+        else {
+            is_functor = true;
+        }
+    }
+    std::string fmt_error_msg;
+    if (!is_functor && !regobj->CheckRewriteString(fmt, &fmt_error_msg)) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", fmt_error_msg, ")");
+    }
+    const auto opt = detail::stream_option(env, args, 4, objs[4], funcName);
+
+    const size_t sub_count = is_functor ? 1 + regobj->NumberOfCapturingGroups()
+                                        : 1 + RE2::MaxSubmatch(fmt);
+
+    detail::fd_writer_t writer(out.fd(), opt.chunk_size);
+    std::string rewrite;
+    auto on_text = [&writer](sss::string_view text) { writer.write(text); };
+    auto on_match = [&](const re2::StringPiece* subs, size_t n) {
+        if (!is_functor) {
+            rewrite.clear();
+            regobj->Rewrite(&rewrite, fmt, subs, int(n));
+            writer.write(rewrite);
+            return;
+        }
+        // NOTE 子匹配引用的是读取缓冲区，须复制
+        varlisp::List matched_list = varlisp::List::makeSQuoteList();
+        auto back_it = detail::list_back_inserter<varlisp::string_t>(matched_list);
+        for (size_t i = 0; i < n; ++i) {
+            *back_it++ = string_t(std::string(subs[i].data(), subs[i].size()));
+        }
+        auto wrap_list = varlisp::List();
+        wrap_list.append(std::move(matched_list));
+
+        auto rst = varlisp::apply(env, args.nth(3), wrap_list);
+        if (varlisp::string_t* p_str = boost::get<varlisp::string_t>(&rst)) {
+            writer.write(p_str->to_string_view());
+        }
+        else {
+            std::ostringstream oss;
+            boost::apply_visitor(print_visitor(oss), rst);
+            writer.write(oss.str());
+        }
+    };
+
+    int64_t count = 0;
+    try {
+        count = detail::regex_stream_scan(in.fd(), *regobj, sub_count, opt, on_text, on_match);
+        writer.flush();
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+    return count;
+}
+
+REGIST_BUILTIN("regex-collect-stream", 2, 4, eval_regex_collect_stream,
+               "; regex-collect-stream 同regex-collect，但按块读取in(fd或者文件路径)；\n"
+               "; max-match 同regex-replace-stream\n"
+               "(regex-collect-stream reg in) -> (list matched-sub1 matched-sub2 ...)\n"
+               "(regex-collect-stream reg in \"fmt-string\") -> (list matched-sub1 matched-sub2 ...)\n"
+               "(regex-collect-stream reg in \"fmt-string\" max-match) -> (list matched-sub1 matched-sub2 ...)");
+
+/**
+ * @brief
+ *      (regex-collect-stream reg in)
+ *      (regex-collect-stream reg in "fmt-string")
+ *      (regex-collect-stream reg in "fmt-string" max-match)
+ *          -> (list matched-sub1 matched-sub2 ...)
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_regex_collect_stream(varlisp::Environment &env, const varlisp::List &args)
+{
+    const char * funcName = "regex-collect-stream";
+    std::array<Object, 4> objs;
+    const varlisp::regex_t regobj =
+        detail::requireRegex(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+
+    detail::stream_fd_t in(getAtomicValue(env, args.nth(1), objs[1]), false, funcName, 1);
+
+    re2::StringPiece rewrite("\\0");
+    if (args.length() >= 3) {
+        const auto *p_fmt =
+            requireTypedValue<varlisp::string_t>(env, args.nth(2), objs[2], funcName, 2, DEBUG_INFO);
+        rewrite = *p_fmt;
+    }
+    std::string fmt_error_msg;
+    if (!regobj->CheckRewriteString(rewrite, &fmt_error_msg)) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", fmt_error_msg, ")");
+    }
+    const auto opt = detail::stream_option(env, args, 3, objs[3], funcName);
+
+    varlisp::List ret = varlisp::List::makeSQuoteList();
+    auto back_it = detail::list_back_inserter<varlisp::string_t>(ret);
+    auto on_match = [&](const re2::StringPiece* subs, size_t n) {
+        std::string out;
+        if (regobj->Rewrite(&out, rewrite, subs, int(n))) {
+            *back_it++ = string_t(std::move(out));
+        }
+    };
+
+    try {
+        detail::regex_stream_scan(in.fd(), *regobj, 1 + RE2::MaxSubmatch(rewrite), opt,
+                                  nullptr, on_match);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+    return ret;
+}
+
 }  // namespace varlisp
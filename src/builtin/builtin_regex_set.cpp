@@ -0,0 +1,157 @@
+#include <array>
+#include <string>
+#include <vector>
+
+#include <sss/util/PostionThrow.hpp>
+
+#include "../object.hpp"
+#include "../builtin_helper.hpp"
+
+#include "../detail/buitin_info_t.hpp"
+#include "../detail/car.hpp"
+#include "../detail/regex_cache.hpp"
+
+namespace varlisp {
+
+REGIST_BUILTIN("regex-set", 1, 2, eval_regex_set,
+               "; regex-set 由一组pattern生成正则集合(RE2::Set)；\n"
+               "; 配合 regex-set-match，一次扫描即得到所有匹配的pattern；\n"
+               "; flags 同regex\n"
+               "(regex-set '(\"pattern\"...)) -> regex-set\n"
+               "(regex-set '(\"pattern\"...) \"flags\") -> regex-set");
+
+/**
+ * @brief
+ *      (regex-set '("pattern"...)) -> regex-set
+ *      (regex-set '("pattern"...) "flags") -> regex-set
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_regex_set(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "regex-set";
+    std::array<Object, 2> objs;
+    const varlisp::List * p_list = varlisp::getQuotedList(env, detail::car(args), objs[0]);
+    if (p_list == nullptr) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                           ": need quote list as the 1st argument)");
+    }
+
+    uint32_t flags = detail::regex_cache::flag_none;
+    if (args.length() == 2) {
+        const auto *p_flags =
+            requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
+        if (!detail::regex_cache::parse_flags(p_flags->to_string_view(), flags)) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": unknown flags `",
+                               *p_flags, "`; expect chars of \"islL\")");
+        }
+    }
+
+    std::vector<std::string> patterns;
+    patterns.reserve(p_list->size());
+    for (const auto& it : *p_list) {
+        Object tmp;
+        const auto* p_pattern = getTypedValue<varlisp::string_t>(env, it, tmp);
+        if (p_pattern == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": pattern must be string; but ", it, ")");
+        }
+        patterns.emplace_back(p_pattern->data(), p_pattern->size());
+    }
+
+    try {
+        return varlisp::RegexSet(patterns, flags);
+    }
+    catch (std::runtime_error& e) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": ", e.what(), ")");
+    }
+}
+
+REGIST_BUILTIN("regex-set-match", 2, 2, eval_regex_set_match,
+               "; regex-set-match 匹配的各pattern的下标，升序；都不匹配时为空列表\n"
+               "(regex-set-match regex-set \"target-string\") -> '(index...)");
+
+/**
+ * @brief (regex-set-match regex-set "target-string") -> '(index...)
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_regex_set_match(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "regex-set-match";
+    std::array<Object, 2> objs;
+    const auto *p_set =
+        requireTypedValue<varlisp::RegexSet>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const auto *p_target =
+        requireTypedValue<varlisp::string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
+
+    std::vector<int> ids;
+    p_set->match(p_target->to_string_view(), ids);
+
+    varlisp::List ret = varlisp::List::makeSQuoteList();
+    auto * p_ret = ret.get_slist();
+    for (int id : ids) {
+        p_ret->append(Object(int64_t(id)));
+    }
+    return ret;
+}
+
+REGIST_BUILTIN("regex-set-classify", 2, 2, eval_regex_set_classify,
+               "; regex-set-classify 批量分类：对每个字符串做一次regex-set-match；\n"
+               "; 返回与pattern一一对应的列表，各元素为该pattern命中的字符串的下标\n"
+               "(regex-set-classify regex-set '(\"target-string\"...)) -> '('(index...)...)");
+
+/**
+ * @brief
+ *      (regex-set-classify regex-set '("target-string"...))
+ *          -> '('(index...)...)
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_regex_set_classify(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "regex-set-classify";
+    std::array<Object, 2> objs;
+    const auto *p_set =
+        requireTypedValue<varlisp::RegexSet>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+    const varlisp::List * p_list = varlisp::getQuotedList(env, args.nth(1), objs[1]);
+    if (p_list == nullptr) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                           ": need quote list as the 2nd argument)");
+    }
+
+    std::vector<varlisp::List> hits(p_set->size());
+    std::vector<int> ids;
+    int64_t index = 0;
+    for (const auto& it : *p_list) {
+        Object tmp;
+        const auto* p_target = getTypedValue<varlisp::string_t>(env, it, tmp);
+        if (p_target == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                               ": target must be string; but ", it, ")");
+        }
+        p_set->match(p_target->to_string_view(), ids);
+        for (int id : ids) {
+            hits[id].append(Object(index));
+        }
+        ++index;
+    }
+
+    varlisp::List ret = varlisp::List::makeSQuoteList();
+    auto * p_ret = ret.get_slist();
+    for (const auto& hit : hits) {
+        p_ret->append(Object(varlisp::List::makeSQuoteObj(hit)));
+    }
+    return ret;
+}
+
+}  // namespace varlisp
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <array>
 #include <iterator>
+#include <string>
 
 #include <sss/util/utf8.hpp>
 #include <sss/spliter.hpp>
@@ -14,6 +16,7 @@
 
 #include "../detail/buitin_info_t.hpp"
 #include "../detail/list_iterator.hpp"
+#include "../detail/string_kernel.hpp"
 #include "../detail/car.hpp"
 #include "../raw_stream_visitor.hpp"
 
@@ -117,35 +120,6 @@ Object eval_join(varlisp::Environment &env, const varlisp::List &args)
     return {string_t(oss.str())};
 }
 
-namespace detail {
-const char * locateNthUtf8(const char * it_beg, const char * it_end, size_t nth)
-{
-    while(nth > 0 && it_beg < it_end) {
-        auto len = sss::util::utf8::next_length(it_beg, it_end);
-        if (len == 0) {
-            // NOTE utf8-parse error
-            return nullptr;
-        }
-        --nth;
-        std::advance(it_beg, len);
-    }
-    if (nth == 0) {
-        return it_beg;
-    }
-    return nullptr;
-}
-
-uint32_t nthUtf8(const char* it_beg, const char* it_end, size_t nth)
-{
-    const auto *nth_ptr = locateNthUtf8(it_beg, it_end, nth);
-    if (nth_ptr == nullptr) {
-        return 0;
-    }
-    return sss::util::utf8::peek(nth_ptr, it_end).first;
-}
-
-} // namespace detail
-
 REGIST_BUILTIN("substr-byte", 2, 3, eval_substr_byte,
                "(substr-byte \"target-string\" offset)\n"
                "(substr-byte \"target-string\" offset length) -> sub-str");
@@ -267,55 +241,36 @@ Object eval_substr(varlisp::Environment &env, const varlisp::List &args)
         length = arithmetic2int(arithmetic_length);
     }
 
+    // NOTE 按码点定位，由String::utf8_offset()完成；较长的串，
+    // 使用缓冲区上的稀疏索引，不必每次从头扫描
     if (offset_int < 0) {
         // NOTE 负数，表示逆向查找；length，也是反向
-        // 如果只能循环一次的算法，就要求缓存偏移信息
-
-        // 记录每个u8字符，开始的偏移；
-        std::vector<uint32_t> u8_offset_vec;
-        u8_offset_vec.reserve(p_content->length() / 2);
-        uint32_t current_offset = 0U;
-        const auto *it = p_content->begin();
-        while (it != p_content->end()) {
-            auto len = sss::util::utf8::next_length(it, p_content->end());
-            if (len == 0) {
-                break;
-            }
-            u8_offset_vec.push_back(current_offset);
-            current_offset += len;
-            std::advance(it, len);
-        }
-        int end_offset = int(u8_offset_vec.size()) + int(offset_int);
+        int64_t end_offset = int64_t(p_content->utf8_length()) + offset_int;
         if (end_offset < 0) {
             return Nill{};
         }
-        if (length < 0) {
-            return p_content->substr(0, u8_offset_vec[end_offset]);
-        }
-        int start_offset = end_offset - int(length);
-
-        return p_content->substr(u8_offset_vec[start_offset],
-                                 u8_offset_vec[end_offset] -
-                                 u8_offset_vec[start_offset]);
-    }
-    if (length < 0) {
-        const auto *nth_ptr = detail::locateNthUtf8(p_content->begin(), p_content->end(), offset_int);
-        if (nth_ptr == nullptr) {
+        const size_t end_byte = p_content->utf8_offset(end_offset);
+        if (end_byte == varlisp::string_t::npos) {
             return Nill{};
         }
-        return p_content->substr(nth_ptr - p_content->begin());
+        if (length < 0) {
+            return p_content->substr(0, end_byte);
+        }
+        const size_t start_byte = p_content->utf8_offset(std::max(end_offset - length, int64_t(0)));
+        return p_content->substr(start_byte, end_byte - start_byte);
     }
-    const auto *nth_ptr = detail::locateNthUtf8(p_content->begin(), p_content->end(), offset_int);
-    if (nth_ptr == nullptr) {
+    const size_t start_byte = p_content->utf8_offset(offset_int);
+    if (start_byte == varlisp::string_t::npos) {
         return Nill{};
     }
-
-    const auto *end_ptr = detail::locateNthUtf8(nth_ptr, p_content->end(), length);
-    if (nth_ptr == nullptr) {
-        return Nill{};
+    if (length < 0) {
+        return p_content->substr(start_byte);
     }
-
-    return p_content->substr(nth_ptr - p_content->begin(), end_ptr - nth_ptr);
+    size_t end_byte = p_content->utf8_offset(offset_int + length);
+    if (end_byte == varlisp::string_t::npos) {
+        end_byte = p_content->size();
+    }
+    return p_content->substr(start_byte, end_byte - start_byte);
 }
 
 REGIST_BUILTIN("ltrim", 1, 1, eval_ltrim,
@@ -329,10 +284,7 @@ Object eval_ltrim(varlisp::Environment &env, const varlisp::List &args)
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
     sss::string_view sv = p_str->to_string_view();
-    while(!sv.empty() && (std::isspace(sv.front()) != 0)) {
-        sv.pop_front();
-    }
-    return p_str->substr(sv);
+    return p_str->substr(detail::strkernel::space_prefix(sv));
 }
 
 REGIST_BUILTIN("rtrim", 1, 1, eval_rtrim,
@@ -346,10 +298,7 @@ Object eval_rtrim(varlisp::Environment &env, const varlisp::List &args)
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
     sss::string_view sv = p_str->to_string_view();
-    while(!sv.empty() && (std::isspace(sv.back()) != 0)) {
-        sv.pop_back();
-    }
-    return p_str->substr(sv);
+    return p_str->substr(0, sv.size() - detail::strkernel::space_suffix(sv));
 }
 
 REGIST_BUILTIN("trim", 1, 1, eval_trim,
@@ -363,13 +312,9 @@ Object eval_trim(varlisp::Environment &env, const varlisp::List &args)
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
     sss::string_view sv = p_str->to_string_view();
-    while(!sv.empty() && (std::isspace(sv.front()) != 0)) {
-        sv.pop_front();
-    }
-    while(!sv.empty() && (std::isspace(sv.back()) != 0)) {
-        sv.pop_back();
-    }
-    return p_str->substr(sv);
+    const size_t left = detail::strkernel::space_prefix(sv);
+    sv = sv.substr(left);
+    return p_str->substr(left, sv.size() - detail::strkernel::space_suffix(sv));
 }
 
 REGIST_BUILTIN("strlen", 1, 1, eval_strlen,
@@ -391,7 +336,7 @@ Object eval_strlen(varlisp::Environment &env, const varlisp::List &args)
     std::array<Object, 1> objs;
     const auto *p_str =
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
-    return int64_t(sss::util::utf8::count_nocheck(p_str->begin(), p_str->end()));
+    return int64_t(p_str->utf8_length());
 }
 
 REGIST_BUILTIN("strlen-byte", 1, 1, eval_strlen_byte,
@@ -435,9 +380,26 @@ Object eval_split_char(varlisp::Environment &env, const varlisp::List &args)
         requireTypedValue<varlisp::string_t>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
 
     varlisp::List ret = varlisp::List::makeSQuoteList();
-    sss::util::utf8::dumpout2ucs(
-        p_str->begin(), p_str->end(),
-        detail::list_back_inserter<int64_t>(ret));
+    auto ret_it = detail::list_back_inserter<int64_t>(ret);
+    sss::string_view rest = p_str->to_string_view();
+    while (!rest.empty()) {
+        // ASCII区段，逐字节即码点；其余区段(到下一个ASCII字节为止)才解码
+        const size_t ascii_len = detail::strkernel::ascii_prefix(rest);
+        for (size_t i = 0; i < ascii_len; ++i) {
+            *ret_it++ = int64_t(rest.data()[i]);
+        }
+        rest = rest.substr(ascii_len);
+        size_t multi_len = 0;
+        while (multi_len < rest.size() &&
+               static_cast<unsigned char>(rest.data()[multi_len]) >= 0x80U) {
+            ++multi_len;
+        }
+        if (multi_len != 0) {
+            sss::util::utf8::dumpout2ucs(rest.begin(), rest.begin() + multi_len,
+                                         ret_it);
+            rest = rest.substr(multi_len);
+        }
+    }
     return ret;
 }
 
@@ -548,7 +510,11 @@ Object eval_char_nth(varlisp::Environment &env, const varlisp::List &args)
                            "(", funcName, ": query ", *p_nth, "th elment)");
     }
 
-    auto nth_char = detail::nthUtf8(p_str->begin(), p_str->end(), *p_nth);
+    const size_t offset = p_str->utf8_offset(*p_nth);
+    if (offset == varlisp::string_t::npos || offset >= p_str->size()) {
+        return Nill{};
+    }
+    auto nth_char = sss::util::utf8::peek(p_str->begin() + offset, p_str->end()).first;
 
     if (nth_char != 0u) {
         return int64_t(nth_char);
@@ -570,9 +536,10 @@ Object eval_strstr(varlisp::Environment &env, const varlisp::List &args)
     const auto * p_needle =
         requireTypedValue<string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
-    auto pos = p_source->to_string_view().find(p_needle->to_string_view());
+    auto pos = detail::strkernel::find(p_source->to_string_view(),
+                                       p_needle->to_string_view());
 
-    if (pos == sss::string_view::npos) {
+    if (pos == detail::strkernel::npos) {
         return Nill{};
     }
     return int64_t(pos);
@@ -592,9 +559,10 @@ Object eval_strrstr(varlisp::Environment &env, const varlisp::List &args)
     const auto * p_needle =
         requireTypedValue<string_t>(env, args.nth(1), objs[1], funcName, 1, DEBUG_INFO);
 
-    auto pos = p_source->to_string_view().rfind(p_needle->to_string_view());
+    auto pos = detail::strkernel::rfind(p_source->to_string_view(),
+                                        p_needle->to_string_view());
 
-    if (pos == sss::string_view::npos) {
+    if (pos == detail::strkernel::npos) {
         return Nill{};
     }
     return int64_t(pos);
@@ -632,4 +600,37 @@ Object eval_is_end_with(varlisp::Environment &env, const varlisp::List &args)
     return p_source->to_string_view().is_end_with(p_needle->to_string_view());
 }
 
+REGIST_BUILTIN("is-valid-utf8", 1, 1, eval_is_valid_utf8,
+               "; is-valid-utf8 是否合法的utf8串；\n"
+               "; 超长编码、代理区、超出U+10FFFF的，都视为非法\n"
+               "(is-valid-utf8 \"string\") -> boolean");
+
+Object eval_is_valid_utf8(varlisp::Environment &env, const varlisp::List &args)
+{
+    const char * funcName = "is-valid-utf8";
+    Object obj;
+    const auto * p_str =
+        requireTypedValue<string_t>(env, args.nth(0), obj, funcName, 0, DEBUG_INFO);
+
+    return detail::strkernel::utf8_valid(p_str->to_string_view());
+}
+
+REGIST_BUILTIN("string-intern", 1, 1, eval_string_intern,
+               "; string-intern 返回驻留的字符串；相同内容共享同一缓冲区，\n"
+               "; 比较时只需比较指针；适合大量重复的键名、枚举值\n"
+               "(string-intern \"string\") -> \"string\"");
+
+Object eval_string_intern(varlisp::Environment &env, const varlisp::List &args)
+{
+    const char * funcName = "string-intern";
+    Object obj;
+    const auto * p_str =
+        requireTypedValue<string_t>(env, args.nth(0), obj, funcName, 0, DEBUG_INFO);
+
+    if (p_str->is_interned()) {
+        return *p_str;
+    }
+    return string_t::intern(p_str->to_string_view());
+}
+
 }  // namespace varlisp
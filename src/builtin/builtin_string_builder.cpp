@@ -0,0 +1,129 @@
+#include <array>
+#include <ostream>
+
+#include <sss/util/PostionThrow.hpp>
+
+#include "../object.hpp"
+#include "../builtin_helper.hpp"
+
+#include "../detail/buitin_info_t.hpp"
+#include "../raw_stream_visitor.hpp"
+
+namespace varlisp {
+
+REGIST_BUILTIN("string-builder", 0, 1, eval_string_builder,
+               "; string-builder 创建可变字符串，用于拼接大段输出；\n"
+               "; 可选参数为预分配的字节数；\n"
+               "; 配合 sb-append、(format sb ...)、(json-string obj b sb)\n"
+               "; 追加内容；最后用 sb-freeze 得到字符串。\n"
+               "(string-builder) -> string-builder\n"
+               "(string-builder capacity) -> string-builder");
+
+/**
+ * @brief
+ *      (string-builder) -> string-builder
+ *      (string-builder capacity) -> string-builder
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_string_builder(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "string-builder";
+    if (args.length() == 0) {
+        return varlisp::StringBuilder{};
+    }
+    Object tmp;
+    int64_t capacity =
+        *requireTypedValue<int64_t>(env, args.nth(0), tmp, funcName, 0, DEBUG_INFO);
+    if (capacity < 0) {
+        SSS_POSITION_THROW(std::runtime_error, "(", funcName,
+                           ": capacity must be non-negative; but ", capacity, ")");
+    }
+    return varlisp::StringBuilder(capacity);
+}
+
+REGIST_BUILTIN("sb-append", 2, -1, eval_sb_append,
+               "; sb-append 依次追加到string-builder末尾；\n"
+               "; 字符串原样追加，其他对象同join的输出格式\n"
+               "(sb-append sb item...) -> sb");
+
+/**
+ * @brief (sb-append sb item...) -> sb
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_sb_append(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "sb-append";
+    Object sbTmp;
+    const auto* p_sb = requireTypedValue<varlisp::StringBuilder>(
+        env, args.nth(0), sbTmp, funcName, 0, DEBUG_INFO);
+
+    detail::string_append_buf buf(p_sb->buffer());
+    std::ostream os(&buf);
+    const varlisp::List items = args.tail();
+    for (const auto& it : items) {
+        Object tmp;
+        const Object& itemRef = getAtomicValue(env, it, tmp);
+        if (const auto* p_str = boost::get<string_t>(&itemRef)) {
+            p_sb->append(p_str->to_string_view());
+        }
+        else if (const auto* p_item = boost::get<varlisp::StringBuilder>(&itemRef)) {
+            p_sb->append(p_item->to_string_view());
+        }
+        else {
+            boost::apply_visitor(raw_stream_visitor(os, env), itemRef);
+        }
+    }
+    return *p_sb;
+}
+
+REGIST_BUILTIN("sb-length", 1, 1, eval_sb_length,
+               "; sb-length 已追加的字节数\n"
+               "(sb-length sb) -> int64_t");
+
+/**
+ * @brief (sb-length sb) -> int64_t
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_sb_length(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "sb-length";
+    Object tmp;
+    const auto* p_sb = requireTypedValue<varlisp::StringBuilder>(
+        env, args.nth(0), tmp, funcName, 0, DEBUG_INFO);
+    return int64_t(p_sb->size());
+}
+
+REGIST_BUILTIN("sb-freeze", 1, 1, eval_sb_freeze,
+               "; sb-freeze 将内容移交为字符串(不复制)；之后sb为空，可继续使用\n"
+               "(sb-freeze sb) -> string");
+
+/**
+ * @brief (sb-freeze sb) -> string
+ *
+ * @param[in] env
+ * @param[in] args
+ *
+ * @return
+ */
+Object eval_sb_freeze(varlisp::Environment& env, const varlisp::List& args)
+{
+    const char * funcName = "sb-freeze";
+    Object tmp;
+    const auto* p_sb = requireTypedValue<varlisp::StringBuilder>(
+        env, args.nth(0), tmp, funcName, 0, DEBUG_INFO);
+    return p_sb->freeze();
+}
+
+}  // namespace varlisp
@@ -243,10 +243,10 @@ Object eval_url_join(varlisp::Environment& env, const varlisp::List& args)
                 case 3: path     = *requireTypedValue<varlisp::string_t>(env, p_list->nth(i), tmp, funcName, i, DEBUG_INFO)->gen_shared(); break;
                 case 4:
                         {
-                            const auto * p_params =
-                                requireTypedValue<varlisp::Environment>(env, p_list->nth(i), tmp, funcName, i, DEBUG_INFO);
+                            const auto params =
+                                requireEnvironmentOrDict(env, p_list->nth(i), tmp, funcName, i, DEBUG_INFO);
                             bool is_1st = true;
-                            for (const auto & p_param : *p_params) {
+                            params.for_each([&](sss::string_view key, const Object& param) {
                                 if (is_1st) {
                                     path += '?';
                                     is_1st = false;
@@ -254,15 +254,15 @@ Object eval_url_join(varlisp::Environment& env, const varlisp::List& args)
                                 else {
                                     path += '&';
                                 }
-                                path += p_param.first;
+                                path.append(key.data(), key.size());
                                 std::ostringstream oss;
-                                boost::apply_visitor(raw_stream_visitor(oss, env), p_param.second.first);
+                                boost::apply_visitor(raw_stream_visitor(oss, env), param);
                                 std::string value = oss.str();
                                 if (!value.empty()) {
                                     path += '=';
                                     path += detail::url_encode(oss.str());
                                 }
-                            }
+                            });
                         }
                         break;
 
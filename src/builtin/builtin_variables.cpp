@@ -105,7 +105,12 @@ Object eval_undef(varlisp::Environment& env, const varlisp::List& args)
             // for named field
             // - : {albeta}+
             if (!detail::is_index(jc.stems().back())) {
-                location.env->erase(jc.stems().back());
+                if (location.dict != nullptr) {
+                    location.dict->erase(jc.stems().back());
+                }
+                else {
+                    location.env->erase(jc.stems().back());
+                }
                 ret = true;
             }
             // for index
@@ -179,8 +184,18 @@ Object eval_var_list(varlisp::Environment& env, const varlisp::List& args)
     int64_t var_count = 0;
     std::array<Object, 1> objs;
     if (args.length() != 0U) {
-       p_env =
-            varlisp::requireTypedValue<varlisp::Environment>(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+        const auto view =
+            varlisp::requireEnvironmentOrDict(env, args.nth(0), objs[0], funcName, 0, DEBUG_INFO);
+        // dict(json-parse 的结果)：没有parent，也没有const属性
+        if (view.p_dict != nullptr) {
+            view.for_each([&var_count](sss::string_view key, const Object& value) {
+                std::cout << key << "\n"
+                    << "\t" << value << std::endl;
+                ++var_count;
+            });
+            return var_count;
+        }
+        p_env = view.p_env;
     }
 
     // 被子环境覆盖了的父环境变量，不会输出。
@@ -196,6 +211,16 @@ Object eval_var_list(varlisp::Environment& env, const varlisp::List& args)
             }
         }
     }
+    // 内建函数不在根环境的map中，另外列出
+    if (args.length() == 0U) {
+        for (const auto& info : varlisp::detail::get_builtin_infos()) {
+            if (outted.insert(info.name).second) {
+                std::cout << info.name << "\n"
+                    << "\t" << *varlisp::detail::find_builtin_object(info.name) << " CONST"
+                    << std::endl;
+            }
+        }
+    }
     var_count = int64_t(outted.size());
     return var_count;
 }
@@ -506,13 +531,18 @@ Object eval_locate(varlisp::Environment& env, const varlisp::List& args)
             }
         }
         else if (const auto * p_str = boost::get<string_t>(&locator)) {
-            p_env = const_cast<varlisp::Environment*>(boost::get<varlisp::Environment>(p_obj));
-            if (p_env == nullptr) {
-                SSS_POSITION_THROW(std::runtime_error,
-                                   "need an Environment here , but ", *stem_it);
-            }
             std::string name = *p_str->gen_shared();
-            p_obj = p_env->find(name);
+            if (const auto * p_dict = boost::get<varlisp::Dict>(p_obj)) {
+                p_obj = p_dict->find(name);
+            }
+            else {
+                p_env = const_cast<varlisp::Environment*>(boost::get<varlisp::Environment>(p_obj));
+                if (p_env == nullptr) {
+                    SSS_POSITION_THROW(std::runtime_error,
+                                       "need an Environment here , but ", *stem_it);
+                }
+                p_obj = p_env->find(name);
+            }
             if (p_obj == nullptr) {
                 if (p_default != nullptr) {
                     p_obj = p_default;
@@ -527,12 +557,17 @@ Object eval_locate(varlisp::Environment& env, const varlisp::List& args)
                 SSS_POSITION_THROW(std::runtime_error, "slist required!");
             }
             const auto * p_sym = p_slist->unquoteType<varlisp::symbol>();
-            p_env = const_cast<varlisp::Environment*>(boost::get<varlisp::Environment>(p_obj));
-            if (p_env == nullptr) {
-                SSS_POSITION_THROW(std::runtime_error,
-                                   "need an Environment here , but ", *stem_it);
+            if (const auto * p_dict = boost::get<varlisp::Dict>(p_obj)) {
+                p_obj = p_dict->find(p_sym->name());
+            }
+            else {
+                p_env = const_cast<varlisp::Environment*>(boost::get<varlisp::Environment>(p_obj));
+                if (p_env == nullptr) {
+                    SSS_POSITION_THROW(std::runtime_error,
+                                       "need an Environment here , but ", *stem_it);
+                }
+                p_obj = p_env->find(p_sym->name());
             }
-            p_obj = p_env->find(p_sym->name());
             if (p_obj == nullptr) {
                 if (p_default != nullptr) {
                     p_obj = p_default;
@@ -576,6 +611,14 @@ Object eval_symbols(varlisp::Environment& env, const varlisp::List& args)
             SSS_POSITION_THROW(std::runtime_error,
                                "(", funcName, ": symbol ", *p_sym, " cannot be found)");
         }
+        if (const auto * p_dict = boost::get<varlisp::Dict>(location.obj)) {
+            auto symbols = varlisp::List::makeSQuoteList();
+            auto back_it = detail::list_back_inserter<Object>(symbols);
+            for (const auto & it : *p_dict) {
+                *back_it++ = varlisp::symbol(it.first.to_string());
+            }
+            return symbols;
+        }
         p_env = boost::get<varlisp::Environment>(location.obj);
         if (p_env == nullptr) {
             SSS_POSITION_THROW(std::runtime_error,
@@ -587,6 +630,14 @@ Object eval_symbols(varlisp::Environment& env, const varlisp::List& args)
     for (auto & it : *p_env) {
         *back_it++ = varlisp::symbol(it.first);
     }
+    // 根环境：内建函数不在map中，另外追加
+    if (args.empty() && p_env->parent() == nullptr) {
+        for (const auto& info : varlisp::detail::get_builtin_infos()) {
+            if (p_env->find(info.name) == nullptr) {
+                *back_it++ = varlisp::symbol(info.name);
+            }
+        }
+    }
     return symbols;
 }
 
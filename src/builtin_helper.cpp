@@ -35,6 +35,19 @@ const varlisp::List* getQuotedList(varlisp::Environment& env,
     return p_list;
 }
 
+keyvalue_view_t getEnvironmentOrDict(varlisp::Environment& env,
+                                     const varlisp::Object& obj,
+                                     varlisp::Object& tmp)
+{
+    keyvalue_view_t view;
+    const Object& ref = varlisp::getAtomicValue(env, obj, tmp);
+    view.p_env = boost::get<varlisp::Environment>(&ref);
+    if (view.p_env == nullptr) {
+        view.p_dict = boost::get<varlisp::Dict>(&ref);
+    }
+    return view;
+}
+
 Object * findSymbolDeep(varlisp::Environment& env,
                         const varlisp::Object& value, Object& tmp,
                         const char * funcName)
@@ -129,6 +129,10 @@ template <> inline const char * typeName<varlisp::Environment>() { return "conte
 template <> inline const char * typeName<varlisp::regex_t>()     { return "regex";   }
 template <> inline const char * typeName<varlisp::gumboNode>()   { return "gumboNode"; }
 template <> inline const char * typeName<varlisp::QuoteList>()   { return "s-list";  }
+template <> inline const char * typeName<varlisp::LazySeq>()     { return "lazy-seq"; }
+template <> inline const char * typeName<varlisp::Dict>()        { return "dict";    }
+template <> inline const char * typeName<varlisp::StringBuilder>() { return "string-builder"; }
+template <> inline const char * typeName<varlisp::RegexSet>()      { return "regex-set"; }
 
 struct readableIndex_t
 {
@@ -221,6 +225,52 @@ const varlisp::List* getQuotedList(varlisp::Environment& env,
                                    const varlisp::Object& obj,
                                    varlisp::Object& tmp);
 
+// Environment 或 Dict(json-parse 的结果)的只读视图；不做拷贝。
+// NOTE 同Environment::find()、begin()，只看当前一层，不含parent
+struct keyvalue_view_t {
+    const varlisp::Environment* p_env  = nullptr;
+    const varlisp::Dict*        p_dict = nullptr;
+
+    explicit operator bool() const { return p_env != nullptr || p_dict != nullptr; }
+
+    const Object* find(const std::string& key) const
+    {
+        return p_env ? p_env->find(key) : (p_dict ? p_dict->find(sss::string_view(key)) : nullptr);
+    }
+
+    // func(sss::string_view key, const Object& value)；Dict按插入顺序
+    template <typename Func>
+    void for_each(Func&& func) const
+    {
+        if (p_env) {
+            for (const auto& it : *p_env) {
+                func(sss::string_view(it.first), it.second.first);
+            }
+        }
+        else if (p_dict) {
+            for (const auto& it : *p_dict) {
+                func(it.first.to_string_view(), it.second);
+            }
+        }
+    }
+};
+
+// 取Environment或Dict；都不是时，返回空视图
+keyvalue_view_t getEnvironmentOrDict(varlisp::Environment& env,
+                                     const varlisp::Object& obj,
+                                     varlisp::Object& tmp);
+
+inline keyvalue_view_t requireEnvironmentOrDict(varlisp::Environment& env,
+                                                const varlisp::Object& obj,
+                                                varlisp::Object& tmp,
+                                                const char* funcName, size_t index,
+                                                const debug_info_t& debug_info)
+{
+    auto view = getEnvironmentOrDict(env, obj, tmp);
+    requireOnFaild<varlisp::Environment>(view ? &view : nullptr, funcName, index, debug_info);
+    return view;
+}
+
 // NOTE 深度查询一个symbol——注意，该symbol，可以由cast等方法生成。
 Object * findSymbolDeep(varlisp::Environment& env,
                         const varlisp::Object& value, Object& tmp,
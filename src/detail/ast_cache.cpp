@@ -0,0 +1,200 @@
+#include "ast_cache.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <sss/colorlog.hpp>
+#include <sss/path.hpp>
+
+#include "../environment.hpp"
+#include "../parser.hpp"
+
+#include "config.hpp"
+#include "mmap_file.hpp"
+#include "object_codec.hpp"
+
+namespace varlisp::detail::ast_cache {
+
+namespace {
+
+const char     ast_magic[8] = {'V', 'L', 'S', 'P', 'A', 'S', 'T', '\0'};
+const uint32_t ast_version  = 2;
+
+// 缓存文件头：magic、字节序标记、ast_version、codec::build_fingerprint()，
+// 然后是下面的源文件信息；任何一项不一致，都按未命中处理
+struct source_info_t
+{
+    std::string path;
+    uint64_t    mtime_ns = 0;
+    uint64_t    size     = 0;
+    uint64_t    hash     = 0;
+};
+
+std::string cache_file_path(const std::string& cache_dir,
+                            const std::string& full_path)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ast",
+                  static_cast<unsigned long long>(codec::hash(full_path)));
+    return sss::path::append_copy(cache_dir, name);
+}
+
+// 命中时，将语句序列放入exprs，返回true
+bool read_cache(const std::string& cache_file, const source_info_t& info,
+                std::vector<Object>& exprs)
+{
+    if (sss::path::file_exists(cache_file) != sss::PATH_TO_FILE) {
+        return false;
+    }
+    try {
+        mmap_file_t file(cache_file);
+        auto data = file.view();
+        if (data.size() < sizeof(ast_magic) ||
+            std::memcmp(data.data(), ast_magic, sizeof(ast_magic)) != 0) {
+            return false;
+        }
+        codec::reader_t reader(sss::string_view(
+            data.data() + sizeof(ast_magic), data.size() - sizeof(ast_magic)));
+        // NOTE 须先比较字节序标记；字节序不同，后面的长度字段都不可信
+        if (reader.get_u32() != codec::endian_marker ||
+            reader.get_u32() != ast_version ||
+            reader.get_u64() != codec::build_fingerprint() ||
+            reader.get_string() != sss::string_view(info.path) ||
+            reader.get_u64() != info.mtime_ns ||
+            reader.get_u64() != info.size ||
+            reader.get_u64() != info.hash) {
+            return false;
+        }
+        for (uint32_t i = 0, cnt = reader.get_u32(); i < cnt; ++i) {
+            exprs.push_back(reader.decode());
+        }
+        return reader.empty();
+    }
+    catch (std::exception& e) {
+        COLOG_ERROR("ast-cache `", cache_file, "` broken: ", e.what());
+        exprs.clear();
+        return false;
+    }
+}
+
+bool write_cache(const std::string& cache_file, const source_info_t& info,
+                 uint32_t count, const std::string& body)
+{
+    std::string head(ast_magic, sizeof(ast_magic));
+    codec::put_u32(head, codec::endian_marker);
+    codec::put_u32(head, ast_version);
+    codec::put_u64(head, codec::build_fingerprint());
+    codec::put_string(head, info.path);
+    codec::put_u64(head, info.mtime_ns);
+    codec::put_u64(head, info.size);
+    codec::put_u64(head, info.hash);
+    codec::put_u32(head, count);
+
+    sss::path::mkpath(sss::path::dirname(cache_file));
+    // NOTE 先写临时文件，再rename；避免并发的进程读到写了一半的缓存
+    std::string tmp_file = cache_file + "." + std::to_string(::getpid());
+    {
+        std::ofstream ofs(tmp_file.c_str(),
+                          std::ios_base::out | std::ios_base::binary |
+                              std::ios_base::trunc);
+        ofs.write(head.data(), head.size());
+        ofs.write(body.data(), body.size());
+        if (!ofs) {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+        std::remove(tmp_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 同Parser::parse_view()对'@'前缀的处理
+bool script_do_echo(sss::string_view content)
+{
+    while (!content.empty() && std::isspace(static_cast<unsigned char>(content.front()))) {
+        content.pop_front();
+    }
+    return content.empty() || content.front() != '@';
+}
+
+}  // namespace
+
+stat_t& get_stat()
+{
+    static stat_t stat;
+    return stat;
+}
+
+int load(varlisp::Parser& parser, varlisp::Environment& env,
+         const std::string& full_path, bool is_silent)
+{
+    auto t_beg = std::chrono::steady_clock::now();
+    auto elapsed_us = [&t_beg]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - t_beg)
+            .count();
+    };
+
+    mmap_file_t content(full_path);
+
+    const std::string cache_dir = config::get_astCachePath();
+    struct stat st;
+    if (cache_dir.empty() || ::stat(full_path.c_str(), &st) != 0) {
+        return parser.parse_view(env, content.view(), is_silent);
+    }
+
+    source_info_t info;
+    info.path = full_path;
+    info.mtime_ns = uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + st.st_mtim.tv_nsec;
+    info.size = content.size();
+    info.hash = codec::hash(content.view());
+
+    const std::string cache_file = cache_file_path(cache_dir, full_path);
+
+    std::vector<Object> exprs;
+    if (read_cache(cache_file, info, exprs)) {
+        int ec = parser.eval_exprs(env, exprs, is_silent,
+                                   script_do_echo(content.view()));
+        get_stat().hits++;
+        get_stat().hit_us += elapsed_us();
+        return ec;
+    }
+
+    std::string body;
+    uint32_t count = 0;
+    bool is_encodable = true;
+    int ec = parser.parse_view(
+        env, content.view(), is_silent, [&](const Object& expr) {
+            // NOTE 须在求值之前编码；求值可能修改共享的List
+            if (!is_encodable) {
+                return;
+            }
+            try {
+                codec::encode(body, expr);
+                ++count;
+            }
+            catch (std::runtime_error& e) {
+                COLOG_INFO("ast-cache skip `", full_path, "`: ", e.what());
+                is_encodable = false;
+            }
+        });
+    if (ec == 1 && is_encodable && write_cache(cache_file, info, count, body)) {
+        get_stat().stores++;
+    }
+    get_stat().misses++;
+    get_stat().miss_us += elapsed_us();
+    return ec;
+}
+
+} // namespace varlisp::detail::ast_cache
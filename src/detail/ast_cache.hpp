@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace varlisp {
+class Parser;
+struct Environment;
+} // namespace varlisp
+
+namespace varlisp::detail::ast_cache {
+
+struct stat_t
+{
+    int64_t hits     = 0;   // 直接使用缓存的次数
+    int64_t misses   = 0;   // 需要Tokenizer/Parser解析的次数
+    int64_t stores   = 0;   // 写入缓存文件的次数
+    int64_t hit_us   = 0;   // 命中时，载入(含求值)总耗时
+    int64_t miss_us  = 0;   // 未命中时，载入(含求值)总耗时
+};
+
+stat_t& get_stat();
+
+// 载入并求值脚本；
+// 缓存文件按 路径、mtime、大小、内容hash 校验；命中时直接反序列化得到
+// 语句序列，跳过Tokenizer/Parser；否则正常解析，并在全部成功后写入缓存。
+//
+// 缓存目录见 config::get_astCachePath()，为空时不使用缓存。
+// 返回值同 Parser::parse()
+int load(varlisp::Parser& parser, varlisp::Environment& env,
+         const std::string& full_path, bool is_silent);
+
+} // namespace varlisp::detail::ast_cache
@@ -0,0 +1,83 @@
+#include "buffered_reader.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/util/PostionThrow.hpp>
+
+namespace varlisp::detail {
+
+size_t& buffered_reader_t::default_buffer_size()
+{
+    static size_t buf_size = 1024 * 1024;
+    return buf_size;
+}
+
+buffered_reader_t::buffered_reader_t(int fd, size_t buf_size)
+    : m_fd(fd)
+{
+    m_buf.resize(buf_size != 0U ? buf_size : default_buffer_size());
+}
+
+int64_t buffered_reader_t::fill()
+{
+    if (m_beg != 0) {
+        std::memmove(m_buf.data(), m_buf.data() + m_beg, m_end - m_beg);
+        m_end -= m_beg;
+        m_beg = 0;
+    }
+    if (m_end == m_buf.size()) {
+        // NOTE 单行超过了缓冲区大小；只能扩容
+        m_buf.resize(m_buf.size() * 2);
+    }
+    int64_t ec = 0;
+    do {
+        ec = ::read(m_fd, m_buf.data() + m_end, m_buf.size() - m_end);
+    } while (ec == -1 && errno == EINTR);
+
+    if (ec == -1) {
+        SSS_POSITION_THROW(std::runtime_error, "read fd ", m_fd, " failed: ",
+                           std::strerror(errno));
+    }
+    if (ec > 0) {
+        m_end += ec;
+    }
+    else {
+        m_eof = true;
+    }
+    return ec;
+}
+
+bool buffered_reader_t::next_line(sss::string_view& line)
+{
+    size_t searched = m_beg;
+    while (true) {
+        const char * p_start = m_buf.data() + searched;
+        const auto * p_nl = static_cast<const char*>(
+            std::memchr(p_start, '\n', m_end - searched));
+        if (p_nl != nullptr) {
+            line = sss::string_view(m_buf.data() + m_beg,
+                                    p_nl - (m_buf.data() + m_beg));
+            m_beg = p_nl - m_buf.data() + 1;
+            return true;
+        }
+        if (m_eof) {
+            if (m_beg == m_end) {
+                return false;
+            }
+            // 最后一行，没有换行符
+            line = sss::string_view(m_buf.data() + m_beg, m_end - m_beg);
+            m_beg = m_end;
+            return true;
+        }
+        // 已经检查过的部分，不必重复查找
+        size_t checked = m_end - m_beg;
+        this->fill();
+        searched = m_beg + checked;
+    }
+}
+
+} // namespace varlisp::detail
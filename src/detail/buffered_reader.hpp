@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <sss/string_view.hpp>
+
+namespace varlisp::detail {
+
+// 按大块read(2)读取fd，再在用户态切分为行；
+// 避免 detail::readline() 那样，每个字节一次系统调用。
+//
+// NOTE 本对象只管读取，不负责fd的生命周期。
+class buffered_reader_t
+{
+public:
+    explicit buffered_reader_t(int fd, size_t buf_size = default_buffer_size());
+    ~buffered_reader_t() = default;
+
+    buffered_reader_t(const buffered_reader_t&) = delete;
+    buffered_reader_t& operator=(const buffered_reader_t&) = delete;
+
+    buffered_reader_t(buffered_reader_t&&) = default;
+    buffered_reader_t& operator=(buffered_reader_t&&) = default;
+
+public:
+    // 读取下一行，不含行尾的'\n'；
+    // line 引用内部缓冲区，仅在下一次读取操作之前有效。
+    // 到达文件结尾(且无剩余数据)，返回false；出错时抛出std::runtime_error
+    bool next_line(sss::string_view& line);
+
+    // 读取一个字节；到达文件结尾，返回-1；出错时抛出std::runtime_error
+    int next_byte()
+    {
+        if (m_beg == m_end && (m_eof || this->fill() <= 0)) {
+            return -1;
+        }
+        return static_cast<unsigned char>(m_buf[m_beg++]);
+    }
+
+    // 取出至多n个已读入、未消费的字节，不读fd；返回取出的字节数
+    size_t take(char* out, size_t n)
+    {
+        n = std::min(n, this->pending());
+        std::memcpy(out, m_buf.data() + m_beg, n);
+        m_beg += n;
+        return n;
+    }
+
+    // 已从fd读入，但尚未消费的字节数
+    size_t pending() const
+    {
+        return m_end - m_beg;
+    }
+
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    bool eof() const
+    {
+        return m_eof && m_beg == m_end;
+    }
+
+    static size_t& default_buffer_size();
+
+private:
+    // 将剩余数据移动到缓冲区开头，并尽量填满缓冲区；
+    // 返回本次读取的字节数；0表示文件结尾。
+    // EINTR 时重试；其它错误，抛出std::runtime_error
+    int64_t fill();
+
+private:
+    int                 m_fd;
+    std::vector<char>   m_buf;
+    size_t              m_beg = 0;
+    size_t              m_end = 0;
+    bool                m_eof = false;
+};
+
+} // namespace varlisp::detail
@@ -1,9 +1,14 @@
 #include "buitin_info_t.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 #include <sss/util/PostionThrow.hpp>
 
+#include "../builtin.hpp"
+
 namespace varlisp {
 namespace detail {
 builtin_info_vet_t& get_builtin_infos()
@@ -12,6 +17,145 @@ builtin_info_vet_t& get_builtin_infos()
     return m_builtin_infos;
 }
 
+namespace {
+
+inline uint64_t mix64(uint64_t x)
+{
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdULL;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return x ^ (x >> 33);
+}
+
+// 完美hash(hash and displace)：
+//   name_hash 先分桶；每个桶找一个位移值d，使得桶内各键的
+//   mix64(name_hash ^ d) 落入互不冲突的空槽。
+// 查找时：一次分桶、一次mix、一次字符串比较。
+struct builtin_index_t
+{
+    std::vector<uint32_t> m_disp;       // 每桶的位移值
+    std::vector<int>      m_slots;      // 内建函数编号；-1表示空
+    std::size_t           m_bucket_mask = 0;
+    std::size_t           m_slot_mask = 0;
+
+    explicit builtin_index_t(const builtin_info_vet_t& infos)
+    {
+        std::size_t slot_cnt = 16;
+        while (slot_cnt < infos.size() * 2) {
+            slot_cnt <<= 1;
+        }
+        std::size_t bucket_cnt = 4;
+        while (bucket_cnt * 4 < infos.size()) {
+            bucket_cnt <<= 1;
+        }
+        m_slot_mask = slot_cnt - 1;
+        m_bucket_mask = bucket_cnt - 1;
+        m_slots.assign(slot_cnt, -1);
+        m_disp.assign(bucket_cnt, 0);
+
+        std::vector<std::vector<int>> buckets(bucket_cnt);
+        for (size_t i = 0; i != infos.size(); ++i) {
+            auto& bucket = buckets[infos[i].name_hash & m_bucket_mask];
+            // NOTE 重名(或hash相同)时，找不到位移值；且后者将无法按名字访问——直接报错
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](int idx) {
+                return infos[idx].name_hash == infos[i].name_hash;
+            });
+            if (it != bucket.end()) {
+                SSS_POSITION_THROW(std::logic_error, "builtin `", infos[i].name,
+                                   "` conflicts with `", infos[*it].name,
+                                   "`: duplicate name or name hash");
+            }
+            bucket.push_back(int(i));
+        }
+        std::vector<size_t> order(bucket_cnt);
+        for (size_t b = 0; b != bucket_cnt; ++b) {
+            order[b] = b;
+        }
+        // 大桶优先
+        std::sort(order.begin(), order.end(), [&buckets](size_t l, size_t r) {
+            return buckets[l].size() > buckets[r].size();
+        });
+
+        std::vector<std::size_t> pos;
+        for (auto b : order) {
+            if (buckets[b].empty()) {
+                break;
+            }
+            for (uint32_t d = 0;; ++d) {
+                pos.clear();
+                bool is_ok = true;
+                for (int idx : buckets[b]) {
+                    std::size_t p = mix64(infos[idx].name_hash ^ d) & m_slot_mask;
+                    if (m_slots[p] != -1 ||
+                        std::find(pos.begin(), pos.end(), p) != pos.end()) {
+                        is_ok = false;
+                        break;
+                    }
+                    pos.push_back(p);
+                }
+                if (is_ok) {
+                    m_disp[b] = d;
+                    for (size_t k = 0; k != pos.size(); ++k) {
+                        m_slots[pos[k]] = buckets[b][k];
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    int find(const builtin_info_vet_t& infos, const std::string& name) const
+    {
+        const uint64_t h = keywords_hash::hash(name);
+        const int idx = m_slots[mix64(h ^ m_disp[h & m_bucket_mask]) & m_slot_mask];
+        if (idx >= 0 && infos[idx].name_hash == h &&
+            std::strcmp(infos[idx].name, name.c_str()) == 0) {
+            return idx;
+        }
+        return -1;
+    }
+};
+
+}  // namespace
+
+int find_builtin(const std::string& name)
+{
+    // NOTE 静态注册完成之后才会调用，故可以延迟建立
+    static const builtin_index_t index(get_builtin_infos());
+    return index.find(get_builtin_infos(), name);
+}
+
+namespace {
+
+const std::vector<Object>& get_builtin_objects()
+{
+    static const std::vector<Object> objects = [] {
+        std::vector<Object> ret;
+        ret.reserve(get_builtin_infos().size());
+        for (size_t i = 0; i != get_builtin_infos().size(); ++i) {
+            ret.emplace_back(varlisp::Builtin(int(i)));
+        }
+        return ret;
+    }();
+    return objects;
+}
+
+}  // namespace
+
+const Object* find_builtin_object(const std::string& name)
+{
+    const int idx = find_builtin(name);
+    return idx < 0 ? nullptr : &get_builtin_objects()[idx];
+}
+
+int builtin_object_index(const Object* p_obj)
+{
+    const auto& objects = get_builtin_objects();
+    if (objects.empty() || p_obj < objects.data() || p_obj >= objects.data() + objects.size()) {
+        return -1;
+    }
+    return int(p_obj - objects.data());
+}
+
 void builtin_info_t::params_size_check(int arg_len) const
 {
     if (this->min > 0 && arg_len < this->min) {
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include "../object.hpp"
 #include "../String.hpp"
+#include "../literal_hash.hpp"
 
 namespace varlisp {
 namespace detail {
@@ -14,17 +17,21 @@ using eval_func_t = Object (*)(varlisp::Environment &, const varlisp::List &);
 
 // 参数格式；
 // 闭区间；-1表示无穷
+//
+// NOTE name、help_msg都是字符串字面值；help_msg直接引用之，不做拷贝
 struct builtin_info_t {
-    builtin_info_t(const char* name, int min, int max, eval_func_t func,
-                   const char* help_msg)
+    builtin_info_t(const char* name, std::size_t name_hash, int min, int max,
+                   eval_func_t func, const char* help_msg)
         : name(name),
+          name_hash(name_hash),
           min(min),
           max(max),
           eval_fun(func),
-          help_msg(std::string(help_msg))
+          help_msg(sss::string_view(help_msg), true)
     {}
     void params_size_check(int arg_len) const;
     const char *    name;
+    std::size_t     name_hash;  // keywords_hash::hash(name)，编译期计算
     int             min;
     int             max;
     eval_func_t     eval_fun;
@@ -33,18 +40,37 @@ struct builtin_info_t {
 
 using builtin_info_vet_t = std::vector<builtin_info_t>;
 builtin_info_vet_t& get_builtin_infos();
-inline bool regist_builtin_function(const char* name, int min, int max,
-                                    eval_func_t func, const char * help_msg) noexcept
+inline bool regist_builtin_function(const char* name, std::size_t name_hash,
+                                    int min, int max, eval_func_t func,
+                                    const char* help_msg) noexcept
 {
-    get_builtin_infos().emplace_back(name, min, max, func, help_msg);
+    get_builtin_infos().emplace_back(name, name_hash, min, max, func, help_msg);
     return true;
 }
 
+// 按名字查找内建函数的编号；不存在，返回-1
+// 首次调用时，按编译期得到的name_hash，建立无冲突的开放寻址表；
+// 之后每次查找，只需一次取模与一次字符串比较。
+// 名字重复或name_hash相同时，建表抛出std::logic_error(启动时即可发现)。
+int find_builtin(const std::string& name);
+
+// 按名字取内建函数对象；不存在，返回nullptr
+// 内建函数不逐个放入根环境的map；Environment::deep_find()在环境链上都
+// 找不到时，经由find_builtin()在此查找。对象表进程内唯一、只读；
+// 需要可写的条目时，由Environment在根环境中放一份(见Environment::deep_find())。
+const Object* find_builtin_object(const std::string& name);
+
+// p_obj 若指向上述对象表中的元素，返回其内建函数编号；否则返回-1
+int builtin_object_index(const Object* p_obj);
+
 #ifndef REGIST_BUILTIN
 #define REGIST_BUILTIN(name, low, high, func, help_msg)          \
     Object func(varlisp::Environment&, const varlisp::List&);    \
     static const bool dummy##func = varlisp::detail::regist_builtin_function( \
-        name, low, high, &(func), help_msg);
+        name,                                                    \
+        std::integral_constant<std::size_t,                      \
+                               varlisp::detail::keywords_hash::hash(name)>::value, \
+        low, high, &(func), help_msg);
 #endif
 
 } // namespace detail
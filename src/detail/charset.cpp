@@ -0,0 +1,311 @@
+#include "charset.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <iconv.h>
+
+#include <uchardet/uchardet.h>
+
+#include "string_kernel.hpp"
+
+namespace varlisp::detail::charset {
+
+namespace {
+
+// 采样段数；第一段从首个非ASCII字节处开始，其余取中部、尾部
+const size_t sample_count = 3;
+
+// 对齐采样边界时，最多向前、后查找换行的距离
+const size_t line_align_limit = 1024;
+
+// 转换时，块末尾允许保留的不完整字节数
+const size_t max_carry = 64;
+
+struct uchardet_deleter_t
+{
+    void operator()(uchardet_t ud) const { uchardet_delete(ud); }
+};
+
+std::string uchardet_detect(sss::string_view content)
+{
+    std::unique_ptr<std::remove_pointer<uchardet_t>::type, uchardet_deleter_t> ud(uchardet_new());
+    if (uchardet_handle_data(ud.get(), content.data(), content.size()) != 0) {
+        throw std::runtime_error("uchardet: analyze coding failed");
+    }
+    uchardet_data_end(ud.get());
+    std::string encoding = uchardet_get_charset(ud.get());
+    normalize(encoding);
+    return encoding;
+}
+
+// 末尾不完整的utf8字符的字节数
+size_t utf8_incomplete_suffix(sss::string_view s)
+{
+    const size_t n = s.size();
+    for (size_t k = 1; k <= 3 && k <= n; ++k) {
+        const auto c = static_cast<unsigned char>(s.data()[n - k]);
+        if ((c & 0xC0U) == 0x80U) {
+            continue;
+        }
+        const size_t need = c >= 0xF0U ? 4 : c >= 0xE0U ? 3 : c >= 0xC0U ? 2 : 1;
+        return need > k ? k : 0;
+    }
+    return 0;
+}
+
+// [beg, beg + len) 向内收缩到整行；附近没有换行时，保持原样
+sss::string_view line_aligned(sss::string_view content, size_t beg, size_t len, bool align_begin)
+{
+    const char* p = content.data();
+    size_t end = beg + len;
+    if (align_begin && beg > 0) {
+        const size_t limit = std::min(beg + line_align_limit, end);
+        const void* nl = std::memchr(p + beg, '\n', limit - beg);
+        if (nl != nullptr) {
+            beg = size_t(static_cast<const char*>(nl) - p) + 1;
+        }
+    }
+    if (end < content.size()) {
+        const size_t limit = std::max(end > line_align_limit ? end - line_align_limit : 0, beg);
+        for (size_t i = end; i > limit; --i) {
+            if (p[i - 1] == '\n') {
+                end = i;
+                break;
+            }
+        }
+    }
+    return sss::string_view(p + beg, end - beg);
+}
+
+struct iconv_holder_t
+{
+    iconv_t cd;
+
+    iconv_holder_t(const std::string& from, const std::string& to)
+        : cd(iconv_open(to.c_str(), from.c_str()))
+    {
+        if (cd == reinterpret_cast<iconv_t>(-1)) {
+            throw std::runtime_error("iconv_open " + from + " -> " + to + ": " +
+                                     std::strerror(errno));
+        }
+    }
+    ~iconv_holder_t() { iconv_close(cd); }
+
+    iconv_holder_t(const iconv_holder_t&) = delete;
+    iconv_holder_t& operator=(const iconv_holder_t&) = delete;
+};
+
+}  // namespace
+
+void normalize(std::string& encoding)
+{
+    std::transform(encoding.begin(), encoding.end(), encoding.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+    // utf-8, utf-16be utf-32le
+    if (encoding.compare(0, 4, "utf-") == 0 || encoding.compare(0, 4, "ucs-") == 0) {
+        encoding.erase(encoding.begin() + 3);
+    }
+    if (encoding.empty() || encoding == "none") {
+        encoding.assign("ascii");
+    }
+}
+
+bool is_compatible(const std::string& from, const std::string& to)
+{
+    std::string f = from;
+    std::string t = to;
+    normalize(f);
+    normalize(t);
+    return f == t || (f == "ascii" && t == "utf8");
+}
+
+bool detect_fast(sss::string_view content, detect_result_t& result, bool partial)
+{
+    // '\0' 多半是utf16、utf32；交给uchardet
+    if (strkernel::find_char(content, '\0') != strkernel::npos) {
+        return false;
+    }
+    const size_t ascii = strkernel::ascii_prefix(content);
+    if (ascii == content.size()) {
+        result.encoding   = "ascii";
+        result.confidence = 1.0;
+        result.method     = "ascii";
+        return true;
+    }
+    sss::string_view rest(content.data() + ascii, content.size() - ascii);
+    if (partial) {
+        rest = sss::string_view(rest.data(), rest.size() - utf8_incomplete_suffix(rest));
+    }
+    if (strkernel::utf8_valid(rest)) {
+        result.encoding   = "utf8";
+        result.confidence = 1.0;
+        result.method     = "utf8";
+        return true;
+    }
+    return false;
+}
+
+sss::string_view head_sample(sss::string_view content, size_t size)
+{
+    if (content.size() <= size) {
+        return content;
+    }
+    size_t first = strkernel::ascii_prefix(content);
+    const size_t limit = first > line_align_limit ? first - line_align_limit : 0;
+    while (first > limit && content.data()[first - 1] != '\n') {
+        --first;
+    }
+    first = std::min(first, content.size() - size);
+    return line_aligned(content, first, size, false);
+}
+
+detect_result_t detect(sss::string_view content, const detect_option_t& opt)
+{
+    detect_result_t ret;
+    if (detect_fast(content, ret, opt.partial)) {
+        return ret;
+    }
+
+    if (opt.sample_size != 0 && content.size() > opt.sample_size) {
+        const size_t len = opt.sample_size / sample_count;
+        const sss::string_view samples[sample_count] = {
+            head_sample(content, len),
+            line_aligned(content, (content.size() - len) / 2, len, true),
+            line_aligned(content, content.size() - len, len, true),
+        };
+
+        std::map<std::string, size_t> votes;
+        size_t voters = 0;
+        for (const auto& sample : samples) {
+            // 纯ASCII的段，不能说明问题
+            if (strkernel::ascii_prefix(sample) == sample.size()) {
+                continue;
+            }
+            ++votes[uchardet_detect(sample)];
+            ++voters;
+        }
+        auto best = std::max_element(votes.begin(), votes.end(),
+                                     [](const std::pair<const std::string, size_t>& a,
+                                        const std::pair<const std::string, size_t>& b) {
+                                         return a.second < b.second;
+                                     });
+        if (best != votes.end()) {
+            const double confidence = double(best->second) / double(voters);
+            if (confidence >= opt.confidence) {
+                ret.encoding   = best->first;
+                ret.confidence = confidence;
+                ret.method     = "sample";
+                return ret;
+            }
+        }
+    }
+
+    ret.encoding = uchardet_detect(content);
+    return ret;
+}
+
+codec::stat_t transcode(const codec::source_t& source, const codec::sink_t& sink,
+                        const std::string& from, const std::string& to, size_t chunk_size)
+{
+    codec::stat_t stat;
+    chunk_size = std::max<size_t>(chunk_size, 4096);
+    std::vector<char> in(chunk_size + max_carry);
+
+    if (is_compatible(from, to)) {
+        while (size_t got = source(in.data(), chunk_size)) {
+            sink(in.data(), got);
+            stat.bytes_in += int64_t(got);
+        }
+        stat.bytes_out = stat.bytes_in;
+        return stat;
+    }
+
+    iconv_holder_t ic(from, to);
+    // 输出最多膨胀到4倍(如 ascii -> utf32)
+    std::vector<char> out(chunk_size * 4 + 64);
+    auto emit = [&](char* op) {
+        const size_t produced = size_t(op - out.data());
+        if (produced != 0) {
+            sink(out.data(), produced);
+            stat.bytes_out += int64_t(produced);
+        }
+    };
+
+    size_t  carry = 0;
+    int64_t base  = 0;     // in[0] 在输入流中的偏移
+    while (true) {
+        const size_t got = source(in.data() + carry, chunk_size);
+        stat.bytes_in += int64_t(got);
+        if (got == 0) {
+            if (carry != 0) {
+                throw std::runtime_error("iconv " + from + " -> " + to +
+                                         ": incomplete multibyte sequence at end; offset " +
+                                         std::to_string(base));
+            }
+            break;
+        }
+
+        char*  ip    = in.data();
+        size_t ileft = carry + got;
+        while (ileft != 0) {
+            char*  op    = out.data();
+            size_t oleft = out.size();
+            const size_t rc = iconv(ic.cd, &ip, &ileft, &op, &oleft);
+            const int err = errno;
+            emit(op);
+            if (rc != size_t(-1) || err == EINVAL) {
+                break;
+            }
+            if (err == E2BIG) {
+                continue;
+            }
+            throw std::runtime_error("iconv " + from + " -> " + to + ": " +
+                                     std::strerror(err) + "; offset " +
+                                     std::to_string(base + (ip - in.data())));
+        }
+        if (ileft > max_carry) {
+            throw std::runtime_error("iconv " + from + " -> " + to +
+                                     ": unconvertible input; offset " +
+                                     std::to_string(base + (ip - in.data())));
+        }
+        base += ip - in.data();
+        std::memmove(in.data(), ip, ileft);
+        carry = ileft;
+    }
+
+    // 有状态的编码(如 iso-2022-jp)，输出复位序列
+    char*  op    = out.data();
+    size_t oleft = out.size();
+    iconv(ic.cd, nullptr, nullptr, &op, &oleft);
+    emit(op);
+    return stat;
+}
+
+bool is_decodable(sss::string_view content, const std::string& encoding)
+{
+    std::string enc = encoding;
+    normalize(enc);
+    if (enc == "utf8") {
+        return strkernel::utf8_valid(content);
+    }
+    if (enc == "ascii") {
+        return strkernel::ascii_prefix(content) == content.size();
+    }
+    try {
+        transcode(codec::memory_source(content), [](const char*, size_t) {}, enc, "utf8");
+    }
+    catch (std::runtime_error&) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace varlisp::detail::charset
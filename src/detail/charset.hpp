@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "codec.hpp"
+
+namespace varlisp::detail::charset {
+
+// 编码名规范化：小写；"utf-8" -> "utf8"；空串、"none" -> "ascii"
+void normalize(std::string& encoding);
+
+// 源、目标编码兼容——即，源内容无需转换(同名，或者ascii -> utf8)
+bool is_compatible(const std::string& from, const std::string& to);
+
+struct detect_option_t
+{
+    // 超过此长度的内容，只检测其中三段采样；0 表示总是全文检测
+    size_t sample_size = 64 * 1024;
+    // 各段采样结果的一致度，低于此值时，退回全文检测
+    double confidence = 0.6;
+    // content 只是流的开头：末尾不完整的utf8字符，不算非法
+    bool partial = false;
+};
+
+struct detect_result_t
+{
+    std::string encoding;               // 已规范化
+    double      confidence = 1.0;       // 与结果一致的采样段比例；全文检测时为1
+    const char* method     = "full";    // "ascii" "utf8" "sample" "full"
+};
+
+// 向量化的ASCII、utf8校验(内容含'\0'时跳过)；命中时，填写result并返回true
+bool detect_fast(sss::string_view content, detect_result_t& result, bool partial = false);
+
+// 首个非ASCII字节所在行起，至多size字节(末尾按行对齐)；供外部检测程序使用
+sss::string_view head_sample(sss::string_view content, size_t size);
+
+// 先做detect_fast()，命中即返回；
+// 否则用uchardet检测采样，一致度不够时，再检测全文。
+// 采样的第一段，从首个非ASCII字节所在行开始；纯ASCII的段不参与投票。
+// 出错时，抛出std::runtime_error
+detect_result_t detect(sss::string_view content, const detect_option_t& opt = detect_option_t());
+
+// 流式转换：按chunk_size分块交给iconv；块末尾不完整的多字节字符，留到下一块。
+// 源、目标编码兼容时，直接复制，不做校验。
+// 非法字节序列、结尾不完整等，抛出std::runtime_error(含出错的字节偏移)
+codec::stat_t transcode(const codec::source_t& source, const codec::sink_t& sink,
+                        const std::string& from, const std::string& to,
+                        size_t chunk_size = 64 * 1024);
+
+// content 能否按encoding完整解码；只校验，不保存转换结果
+bool is_decodable(sss::string_view content, const std::string& encoding);
+
+} // namespace varlisp::detail::charset
@@ -0,0 +1,436 @@
+#include "codec.hpp"
+
+#include <unistd.h>
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "file.hpp"
+
+namespace varlisp::detail::codec {
+
+namespace {
+
+const size_t io_chunk_size = 256 * 1024;
+const size_t dict_size     = 32 * 1024;  // deflate 的窗口大小
+
+std::runtime_error zlib_error(const char* what, int ec, const z_stream* strm = nullptr)
+{
+    std::string msg = std::string(what) + ": zlib error " + std::to_string(ec);
+    if (strm != nullptr && strm->msg != nullptr) {
+        msg += "; ";
+        msg += strm->msg;
+    }
+    return std::runtime_error(msg);
+}
+
+// 尽量读满size字节；返回读到的字节数，小于size表示已到结尾
+size_t read_full(const source_t& source, char* buf, size_t size)
+{
+    size_t len = 0;
+    while (len < size) {
+        size_t n = source(buf + len, size - len);
+        if (n == 0) {
+            break;
+        }
+        len += n;
+    }
+    return len;
+}
+
+struct deflate_guard_t
+{
+    explicit deflate_guard_t(z_stream& s) : strm(s) {}
+    ~deflate_guard_t()
+    {
+        deflateEnd(&strm);
+    }
+    z_stream& strm;
+};
+
+struct block_t
+{
+    std::string input;
+    std::string output;
+    uLong       crc = 0;
+};
+
+// 以raw deflate压缩一块；非最后一块以Z_SYNC_FLUSH结尾(字节对齐)，
+// 这样各块的输出可以直接拼接
+void deflate_block(block_t& block, sss::string_view dict, int level, bool is_last)
+{
+    z_stream strm;
+    std::memset(&strm, 0, sizeof(strm));
+    int ec = deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (ec != Z_OK) {
+        throw zlib_error("deflateInit2", ec);
+    }
+    deflate_guard_t guard(strm);
+
+    if (!dict.empty()) {
+        ec = deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(dict.data()), uInt(dict.size()));
+        if (ec != Z_OK) {
+            throw zlib_error("deflateSetDictionary", ec, &strm);
+        }
+    }
+
+    strm.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(block.input.data()));
+    strm.avail_in = uInt(block.input.size());
+
+    // NOTE 预留sync flush标记等的空间
+    block.output.resize(deflateBound(&strm, strm.avail_in) + 16);
+    size_t used = 0;
+    const int flush = is_last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true) {
+        strm.next_out  = reinterpret_cast<Bytef*>(&block.output[used]);
+        strm.avail_out = uInt(block.output.size() - used);
+        ec = deflate(&strm, flush);
+        used = block.output.size() - strm.avail_out;
+        if (ec == Z_STREAM_ERROR) {
+            throw zlib_error("deflate", ec, &strm);
+        }
+        if (is_last ? ec == Z_STREAM_END : (strm.avail_in == 0 && strm.avail_out != 0)) {
+            break;
+        }
+        block.output.resize(block.output.size() * 2);
+    }
+    block.output.resize(used);
+    block.crc = crc32(0L, reinterpret_cast<const Bytef*>(block.input.data()), uInt(block.input.size()));
+}
+
+void put_le32(std::string& out, uLong v)
+{
+    for (int i = 0; i < 4; ++i) {
+        out += char((v >> (8 * i)) & 0xFFU);
+    }
+}
+
+size_t thread_count(size_t threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max<size_t>(threads, 1);
+}
+
+struct zstd_cctx_deleter_t
+{
+    void operator()(ZSTD_CCtx* p) const
+    {
+        ZSTD_freeCCtx(p);
+    }
+};
+
+struct zstd_dctx_deleter_t
+{
+    void operator()(ZSTD_DCtx* p) const
+    {
+        ZSTD_freeDCtx(p);
+    }
+};
+
+size_t zstd_check(size_t ec, const char* what)
+{
+    if (ZSTD_isError(ec) != 0U) {
+        throw std::runtime_error(std::string(what) + ": zstd error; " + ZSTD_getErrorName(ec));
+    }
+    return ec;
+}
+
+}  // namespace
+
+stat_t gzip_compress(const source_t& source, const sink_t& sink, const gzip_option_t& opt)
+{
+    stat_t stat;
+    const size_t threads    = thread_count(opt.threads);
+    const size_t block_size = std::max<size_t>(opt.block_size, dict_size);
+
+    // 头部：magic, CM=deflate, FLG=0, MTIME=0, XFL=0, OS=unix
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+    sink(header, sizeof(header));
+    stat.bytes_out += sizeof(header);
+
+    uLong  crc   = crc32(0L, Z_NULL, 0);
+    uLong  isize = 0;
+    std::string dict;   // 上一块的末尾；供下一块作字典
+    std::vector<block_t> blocks(threads * 2);
+    bool eof = false;
+    while (!eof) {
+        size_t count = 0;
+        for (; count < blocks.size() && !eof; ++count) {
+            auto& input = blocks[count].input;
+            input.resize(block_size);
+            input.resize(read_full(source, &input[0], block_size));
+            eof = input.size() < block_size;
+        }
+        // NOTE 输入恰好是block_size的整数倍时，最后一块是空的
+        const size_t last = eof ? count - 1 : size_t(-1);
+
+        auto dict_of = [&](size_t i) -> sss::string_view {
+            const std::string& prev = i == 0 ? dict : blocks[i - 1].input;
+            size_t len = std::min(prev.size(), dict_size);
+            return sss::string_view(prev.data() + prev.size() - len, len);
+        };
+
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+        std::atomic<bool> failed{false};
+        auto worker = [&]() {
+            for (size_t i = next++; i < count && !failed; i = next++) {
+                try {
+                    deflate_block(blocks[i], dict_of(i), opt.level, i == last);
+                }
+                catch (...) {
+                    if (!failed.exchange(true)) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+        const size_t workers = std::min(threads, count);
+        if (workers <= 1) {
+            worker();
+        }
+        else {
+            std::vector<std::thread> pool;
+            pool.reserve(workers);
+            for (size_t i = 0; i < workers; ++i) {
+                pool.emplace_back(worker);
+            }
+            for (auto& t : pool) {
+                t.join();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const auto& block = blocks[i];
+            sink(block.output.data(), block.output.size());
+            stat.bytes_in  += int64_t(block.input.size());
+            stat.bytes_out += int64_t(block.output.size());
+            crc   = crc32_combine(crc, block.crc, z_off_t(block.input.size()));
+            isize += uLong(block.input.size());
+        }
+        const auto& tail = blocks[count - 1].input;
+        dict.assign(tail, tail.size() - std::min(tail.size(), dict_size), std::string::npos);
+    }
+
+    std::string trailer;
+    put_le32(trailer, crc);
+    put_le32(trailer, isize & 0xFFFFFFFFUL);
+    sink(trailer.data(), trailer.size());
+    stat.bytes_out += int64_t(trailer.size());
+    return stat;
+}
+
+stat_t gzip_decompress(const source_t& source, const sink_t& sink)
+{
+    stat_t stat;
+    z_stream strm;
+    std::memset(&strm, 0, sizeof(strm));
+    int ec = inflateInit2(&strm, 16 + MAX_WBITS);
+    if (ec != Z_OK) {
+        throw zlib_error("inflateInit2", ec);
+    }
+    std::unique_ptr<z_stream, int (*)(z_stream*)> guard(&strm, inflateEnd);
+
+    std::vector<char> in(io_chunk_size);
+    std::vector<char> out(io_chunk_size);
+    bool in_member = false;     // 当前member尚未结束
+    while (true) {
+        size_t n = source(in.data(), in.size());
+        if (n == 0) {
+            break;
+        }
+        stat.bytes_in += int64_t(n);
+        strm.next_in  = reinterpret_cast<Bytef*>(in.data());
+        strm.avail_in = uInt(n);
+        while (strm.avail_in != 0) {
+            if (!in_member && strm.total_in != 0) {
+                // 上一个member已结束，后面还有数据：下一个member
+                inflateReset(&strm);
+            }
+            in_member = true;
+            strm.next_out  = reinterpret_cast<Bytef*>(out.data());
+            strm.avail_out = uInt(out.size());
+            ec = inflate(&strm, Z_NO_FLUSH);
+            if (ec != Z_OK && ec != Z_STREAM_END && ec != Z_BUF_ERROR) {
+                throw zlib_error("inflate", ec, &strm);
+            }
+            size_t len = out.size() - strm.avail_out;
+            if (len != 0) {
+                sink(out.data(), len);
+                stat.bytes_out += int64_t(len);
+            }
+            if (ec == Z_STREAM_END) {
+                in_member = false;
+            }
+        }
+    }
+    // 输入结束时，inflate 内部可能还有待输出的数据
+    while (in_member) {
+        strm.next_out  = reinterpret_cast<Bytef*>(out.data());
+        strm.avail_out = uInt(out.size());
+        ec = inflate(&strm, Z_NO_FLUSH);
+        size_t len = out.size() - strm.avail_out;
+        if (len != 0) {
+            sink(out.data(), len);
+            stat.bytes_out += int64_t(len);
+        }
+        if (ec == Z_STREAM_END) {
+            in_member = false;
+        }
+        else if (len == 0) {
+            throw std::runtime_error("inflate: unexpected end of gzip stream");
+        }
+    }
+    return stat;
+}
+
+stat_t zstd_compress(const source_t& source, const sink_t& sink, int level, size_t threads)
+{
+    stat_t stat;
+    std::unique_ptr<ZSTD_CCtx, zstd_cctx_deleter_t> cctx(ZSTD_createCCtx());
+    if (!cctx) {
+        throw std::runtime_error("ZSTD_createCCtx: out of memory");
+    }
+    zstd_check(ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel, level),
+               "ZSTD_c_compressionLevel");
+    threads = thread_count(threads);
+    if (threads > 1) {
+        // NOTE libzstd 未开启多线程支持时，会失败；此时退回单线程
+        ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_nbWorkers, int(threads));
+    }
+
+    std::vector<char> in(std::max<size_t>(ZSTD_CStreamInSize(), io_chunk_size));
+    std::vector<char> out(ZSTD_CStreamOutSize());
+    while (true) {
+        size_t n = read_full(source, in.data(), in.size());
+        stat.bytes_in += int64_t(n);
+        const bool is_last = n < in.size();
+        const ZSTD_EndDirective mode = is_last ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input{in.data(), n, 0};
+        bool finished = false;
+        while (!finished) {
+            ZSTD_outBuffer output{out.data(), out.size(), 0};
+            size_t remaining = zstd_check(ZSTD_compressStream2(cctx.get(), &output, &input, mode),
+                                          "ZSTD_compressStream2");
+            if (output.pos != 0) {
+                sink(out.data(), output.pos);
+                stat.bytes_out += int64_t(output.pos);
+            }
+            finished = is_last ? remaining == 0 : input.pos == input.size;
+        }
+        if (is_last) {
+            break;
+        }
+    }
+    return stat;
+}
+
+stat_t zstd_decompress(const source_t& source, const sink_t& sink)
+{
+    stat_t stat;
+    std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter_t> dctx(ZSTD_createDCtx());
+    if (!dctx) {
+        throw std::runtime_error("ZSTD_createDCtx: out of memory");
+    }
+    std::vector<char> in(std::max<size_t>(ZSTD_DStreamInSize(), io_chunk_size));
+    std::vector<char> out(ZSTD_DStreamOutSize());
+    size_t last_ret = 0;    // 非0，表示当前frame尚未结束
+    while (true) {
+        size_t n = source(in.data(), in.size());
+        if (n == 0) {
+            break;
+        }
+        stat.bytes_in += int64_t(n);
+        ZSTD_inBuffer input{in.data(), n, 0};
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output{out.data(), out.size(), 0};
+            last_ret = zstd_check(ZSTD_decompressStream(dctx.get(), &output, &input),
+                                  "ZSTD_decompressStream");
+            if (output.pos != 0) {
+                sink(out.data(), output.pos);
+                stat.bytes_out += int64_t(output.pos);
+            }
+        }
+    }
+    // 输入结束时，可能还有已解码、未输出的数据
+    while (last_ret != 0) {
+        ZSTD_inBuffer  input{nullptr, 0, 0};
+        ZSTD_outBuffer output{out.data(), out.size(), 0};
+        last_ret = zstd_check(ZSTD_decompressStream(dctx.get(), &output, &input),
+                              "ZSTD_decompressStream");
+        if (output.pos == 0) {
+            if (last_ret != 0) {
+                throw std::runtime_error("ZSTD_decompressStream: unexpected end of zstd stream");
+            }
+            break;
+        }
+        sink(out.data(), output.pos);
+        stat.bytes_out += int64_t(output.pos);
+    }
+    return stat;
+}
+
+int zstd_min_level()
+{
+    return ZSTD_minCLevel();
+}
+
+int zstd_max_level()
+{
+    return ZSTD_maxCLevel();
+}
+
+int zstd_default_level()
+{
+    return ZSTD_CLEVEL_DEFAULT;
+}
+
+source_t fd_source(int fd)
+{
+    return [fd](char* buf, size_t size) -> size_t {
+        while (true) {
+            ssize_t ec = file::read_fd(fd, buf, size);
+            if (ec == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("codec read: ") + std::strerror(errno));
+            }
+            return size_t(ec);
+        }
+    };
+}
+
+source_t memory_source(sss::string_view data)
+{
+    auto offset = std::make_shared<size_t>(0);
+    return [data, offset](char* buf, size_t size) -> size_t {
+        size_t len = std::min(size, data.size() - *offset);
+        std::memcpy(buf, data.data() + *offset, len);
+        *offset += len;
+        return len;
+    };
+}
+
+sink_t memory_sink(std::string& out)
+{
+    return [&out](const char* data, size_t size) {
+        out.append(data, size);
+    };
+}
+
+} // namespace varlisp::detail::codec
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+namespace varlisp::detail::codec {
+
+// 数据源：读取至多size字节到buf，返回实际读到的字节数；0表示结束
+using source_t = std::function<size_t(char* buf, size_t size)>;
+// 输出：依次给出处理后的数据
+using sink_t = std::function<void(const char* data, size_t size)>;
+
+struct stat_t
+{
+    int64_t bytes_in  = 0;
+    int64_t bytes_out = 0;
+};
+
+struct gzip_option_t
+{
+    int    level      = -1;         // 0-9；-1 为zlib默认(6)
+    size_t threads    = 0;          // 0 表示按CPU核数
+    size_t block_size = 128 * 1024;
+};
+
+// pigz 风格的并行压缩：输入按block_size分块，各块由不同线程压缩(以前一块的
+// 末尾32K作为字典)，再按顺序拼接；输出为标准的单member gzip，结果与线程数无关。
+stat_t gzip_compress(const source_t& source, const sink_t& sink, const gzip_option_t& opt);
+
+// 流式解压；支持多个member拼接的gzip
+stat_t gzip_decompress(const source_t& source, const sink_t& sink);
+
+// zstd 流式压缩；threads > 1 时，使用zstd自带的多线程压缩
+stat_t zstd_compress(const source_t& source, const sink_t& sink, int level, size_t threads);
+
+// 流式解压；支持多个frame拼接
+stat_t zstd_decompress(const source_t& source, const sink_t& sink);
+
+int zstd_min_level();
+int zstd_max_level();
+int zstd_default_level();
+
+// 出错时，以上函数抛出std::runtime_error
+
+source_t fd_source(int fd);
+source_t memory_source(sss::string_view data);
+sink_t   memory_sink(std::string& out);
+
+} // namespace varlisp::detail::codec
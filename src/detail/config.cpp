@@ -2,6 +2,7 @@
 #include "config.hpp"
 #include "env_get_value.hpp"
 
+#include <cstdlib>
 #include <string>
 
 #include <sss/path.hpp>
@@ -20,6 +21,19 @@ std::string get_omegaGfwRulePath()
     return get_value_with_default("path-to-omegaoptions", omegaOptionPathDefault);
 }
 
+std::string get_astCachePath()
+{
+    static const std::string astCachePathDefault = [] {
+        const char * home = std::getenv("HOME");
+        return home != nullptr && *home != '\0'
+                   ? sss::path::append_copy(home, ".cache/varlisp/ast")
+                   : sss::path::append_copy(
+                         sss::path::dirname(sss::path::getbin()), "ast-cache");
+    }();
+
+    return get_value_with_default("path-to-ast-cache", astCachePathDefault);
+}
+
 } // namespace config
 
 } // namespace detail
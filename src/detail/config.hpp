@@ -12,6 +12,9 @@ namespace config
 const int gfw_rule_mgr_methd = 0;
 
 std::string get_omegaGfwRulePath();
+
+// load 的ast缓存目录；为空串，则关闭缓存
+std::string get_astCachePath();
     // static const 
 
 } // namespace config
@@ -0,0 +1,336 @@
+#include "digest.hpp"
+
+#include <sys/stat.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <openssl/evp.h>
+
+#ifdef VARLISP_WITH_BLAKE3
+#include <blake3.h>
+#endif
+#ifdef VARLISP_WITH_XXHASH
+#include <xxhash.h>
+#endif
+
+#include "file.hpp"
+#include "mmap_file.hpp"
+
+namespace varlisp::detail::digest {
+
+namespace {
+
+// 每次交给各算法的字节数；各算法轮流处理同一块，块仍在缓存中
+const size_t chunk_size = 256 * 1024;
+
+const char* const algo_names[algo_count] = {"md5", "sha1", "sha256", "xxh64", "xxh3", "blake3"};
+
+}  // namespace
+
+struct hasher_t::state_t
+{
+    virtual ~state_t() = default;
+    virtual void        update(const char* data, size_t size) = 0;
+    virtual std::string finish() = 0;
+};
+
+namespace {
+
+class evp_state_t : public hasher_t::state_t
+{
+public:
+    explicit evp_state_t(const EVP_MD* md) : m_ctx(EVP_MD_CTX_new())
+    {
+        if (m_ctx == nullptr || EVP_DigestInit_ex(m_ctx, md, nullptr) != 1) {
+            EVP_MD_CTX_free(m_ctx);
+            throw std::runtime_error("digest: EVP_DigestInit_ex failed");
+        }
+    }
+    ~evp_state_t() override { EVP_MD_CTX_free(m_ctx); }
+
+    void update(const char* data, size_t size) override
+    {
+        EVP_DigestUpdate(m_ctx, data, size);
+    }
+    std::string finish() override
+    {
+        unsigned char buf[EVP_MAX_MD_SIZE];
+        unsigned int  len = 0;
+        EVP_DigestFinal_ex(m_ctx, buf, &len);
+        return std::string(reinterpret_cast<const char*>(buf), len);
+    }
+
+private:
+    EVP_MD_CTX* m_ctx;
+};
+
+#ifdef VARLISP_WITH_XXHASH
+std::string xxh_canonical(XXH64_hash_t hash)
+{
+    XXH64_canonical_t canonical;
+    XXH64_canonicalFromHash(&canonical, hash);
+    return std::string(reinterpret_cast<const char*>(canonical.digest), sizeof(canonical.digest));
+}
+
+class xxh64_state_t : public hasher_t::state_t
+{
+public:
+    xxh64_state_t() : m_state(XXH64_createState())
+    {
+        if (m_state == nullptr) {
+            throw std::bad_alloc();
+        }
+        XXH64_reset(m_state, 0);
+    }
+    ~xxh64_state_t() override { XXH64_freeState(m_state); }
+
+    void update(const char* data, size_t size) override
+    {
+        XXH64_update(m_state, data, size);
+    }
+    std::string finish() override { return xxh_canonical(XXH64_digest(m_state)); }
+
+private:
+    XXH64_state_t* m_state;
+};
+
+class xxh3_state_t : public hasher_t::state_t
+{
+public:
+    xxh3_state_t() : m_state(XXH3_createState())
+    {
+        if (m_state == nullptr) {
+            throw std::bad_alloc();
+        }
+        XXH3_64bits_reset(m_state);
+    }
+    ~xxh3_state_t() override { XXH3_freeState(m_state); }
+
+    void update(const char* data, size_t size) override
+    {
+        XXH3_64bits_update(m_state, data, size);
+    }
+    std::string finish() override { return xxh_canonical(XXH3_64bits_digest(m_state)); }
+
+private:
+    XXH3_state_t* m_state;
+};
+#endif
+
+#ifdef VARLISP_WITH_BLAKE3
+class blake3_state_t : public hasher_t::state_t
+{
+public:
+    blake3_state_t() { blake3_hasher_init(&m_hasher); }
+
+    void update(const char* data, size_t size) override
+    {
+        blake3_hasher_update(&m_hasher, data, size);
+    }
+    std::string finish() override
+    {
+        uint8_t buf[BLAKE3_OUT_LEN];
+        blake3_hasher_finalize(&m_hasher, buf, BLAKE3_OUT_LEN);
+        return std::string(reinterpret_cast<const char*>(buf), BLAKE3_OUT_LEN);
+    }
+
+private:
+    blake3_hasher m_hasher;
+};
+#endif
+
+std::unique_ptr<hasher_t::state_t> make_state(algo_t algo)
+{
+    switch (algo) {
+        case algo_md5:
+            return std::unique_ptr<hasher_t::state_t>(new evp_state_t(EVP_md5()));
+        case algo_sha1:
+            return std::unique_ptr<hasher_t::state_t>(new evp_state_t(EVP_sha1()));
+        case algo_sha256:
+            return std::unique_ptr<hasher_t::state_t>(new evp_state_t(EVP_sha256()));
+#ifdef VARLISP_WITH_XXHASH
+        case algo_xxh64:
+            return std::unique_ptr<hasher_t::state_t>(new xxh64_state_t());
+        case algo_xxh3:
+            return std::unique_ptr<hasher_t::state_t>(new xxh3_state_t());
+#else
+        case algo_xxh64:
+        case algo_xxh3:
+            throw std::runtime_error("digest: xxh64/xxh3 not available; built without libxxhash");
+#endif
+#ifdef VARLISP_WITH_BLAKE3
+        case algo_blake3:
+            return std::unique_ptr<hasher_t::state_t>(new blake3_state_t());
+#else
+        case algo_blake3:
+            throw std::runtime_error("digest: blake3 not available; built without libblake3");
+#endif
+        default:
+            throw std::runtime_error("digest: unknown algorithm");
+    }
+}
+
+}  // namespace
+
+const char* algo_name(algo_t algo)
+{
+    return algo >= 0 && algo < algo_count ? algo_names[algo] : "";
+}
+
+bool parse_algo(sss::string_view name, algo_t& algo)
+{
+    for (int i = 0; i < algo_count; ++i) {
+        if (name == sss::string_view(algo_names[i])) {
+            algo = algo_t(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+hasher_t::hasher_t(const std::vector<algo_t>& algos)
+{
+    m_states.reserve(algos.size());
+    for (auto algo : algos) {
+        m_states.push_back(make_state(algo));
+    }
+}
+
+hasher_t::~hasher_t() = default;
+
+void hasher_t::update(const char* data, size_t size)
+{
+    m_size += int64_t(size);
+    while (size != 0) {
+        const size_t len = std::min(size, chunk_size);
+        for (auto& state : m_states) {
+            state->update(data, len);
+        }
+        data += len;
+        size -= len;
+    }
+}
+
+std::vector<std::string> hasher_t::finish()
+{
+    std::vector<std::string> ret;
+    ret.reserve(m_states.size());
+    for (auto& state : m_states) {
+        ret.push_back(state->finish());
+    }
+    return ret;
+}
+
+std::vector<std::string> digest_view(sss::string_view data, const std::vector<algo_t>& algos)
+{
+    hasher_t hasher(algos);
+    hasher.update(data.data(), data.size());
+    return hasher.finish();
+}
+
+std::vector<std::string> digest_fd(int fd, const std::vector<algo_t>& algos, int64_t* p_size)
+{
+    hasher_t hasher(algos);
+    std::unique_ptr<char[]> buf(new char[chunk_size]);
+    while (true) {
+        ssize_t cnt = file::read_fd(fd, buf.get(), chunk_size);
+        if (cnt == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("digest read: ") + std::strerror(errno));
+        }
+        if (cnt == 0) {
+            break;
+        }
+        hasher.update(buf.get(), size_t(cnt));
+    }
+    if (p_size != nullptr) {
+        *p_size = hasher.size();
+    }
+    return hasher.finish();
+}
+
+std::vector<std::string> digest_file(const std::string& path, const std::vector<algo_t>& algos,
+                                     int64_t* p_size)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        mmap_file_t file(path);
+        if (file.is_mapped()) {
+            if (p_size != nullptr) {
+                *p_size = int64_t(file.size());
+            }
+            return digest_view(file.view(), algos);
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("open `" + path + "` failed: " + std::strerror(errno));
+    }
+    try {
+        auto ret = digest_fd(fd, algos, p_size);
+        ::close(fd);
+        return ret;
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+std::vector<file_result_t> digest_files(const std::vector<std::string>& paths,
+                                        const std::vector<algo_t>& algos, size_t threads)
+{
+    std::vector<file_result_t> results(paths.size());
+    if (paths.empty()) {
+        return results;
+    }
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, paths.size());
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        while (true) {
+            const size_t i = next.fetch_add(1);
+            if (i >= paths.size()) {
+                break;
+            }
+            auto& result = results[i];
+            try {
+                result.digests = digest_file(paths[i], algos, &result.size);
+                result.ok = true;
+            }
+            catch (std::exception& e) {
+                result.error = e.what();
+            }
+        }
+    };
+
+    if (threads <= 1) {
+        worker();
+        return results;
+    }
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+    return results;
+}
+
+} // namespace varlisp::detail::digest
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sss/string_view.hpp>
+
+namespace varlisp::detail::digest {
+
+// md5、sha1、sha256 来自openssl；xxh64、xxh3(64位) 来自libxxhash；blake3 来自libblake3
+// 后两个库是可选的(见CMakeLists.txt)；缺少时，使用对应算法会抛出std::runtime_error
+enum algo_t {
+    algo_md5 = 0,
+    algo_sha1,
+    algo_sha256,
+    algo_xxh64,
+    algo_xxh3,
+    algo_blake3,
+    algo_count
+};
+
+const char* algo_name(algo_t algo);
+
+// "md5" "sha1" "sha256" "xxh64" "xxh3" "blake3"；不认识的返回false
+bool parse_algo(sss::string_view name, algo_t& algo);
+
+// 一次读取，同时计算多种摘要；各算法的状态互相独立。
+// xxh64、xxh3 按规范形式(大端)输出，与xxhsum一致。
+class hasher_t
+{
+public:
+    explicit hasher_t(const std::vector<algo_t>& algos);
+    ~hasher_t();
+
+    hasher_t(const hasher_t&) = delete;
+    hasher_t& operator=(const hasher_t&) = delete;
+
+    void update(const char* data, size_t size);
+
+    // 各算法的摘要(二进制)，顺序同构造时的algos；之后不能再update()
+    std::vector<std::string> finish();
+
+    // 已处理的字节数
+    int64_t size() const { return m_size; }
+
+    // 各算法的状态；实现见digest.cpp
+    struct state_t;
+
+private:
+    std::vector<std::unique_ptr<state_t>> m_states;
+    int64_t m_size = 0;
+};
+
+// 以下函数，出错时抛出std::runtime_error
+
+std::vector<std::string> digest_view(sss::string_view data, const std::vector<algo_t>& algos);
+
+// 从fd读取，直到结尾
+std::vector<std::string> digest_fd(int fd, const std::vector<algo_t>& algos, int64_t* p_size = nullptr);
+
+// 普通文件mmap后计算；不能mmap的(管道、/proc下的文件等)，按块读取
+std::vector<std::string> digest_file(const std::string& path, const std::vector<algo_t>& algos,
+                                     int64_t* p_size = nullptr);
+
+struct file_result_t
+{
+    bool                     ok   = false;
+    int64_t                  size = 0;
+    std::vector<std::string> digests;
+    std::string              error;
+};
+
+// 多个文件，分给threads个线程(0 表示按CPU核数)并行计算；结果顺序同paths
+std::vector<file_result_t> digest_files(const std::vector<std::string>& paths,
+                                        const std::vector<algo_t>& algos, size_t threads);
+
+} // namespace varlisp::detail::digest
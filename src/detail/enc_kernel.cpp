@@ -0,0 +1,524 @@
+#include "enc_kernel.hpp"
+
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VARLISP_ENCKERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace varlisp::detail::enckernel {
+
+namespace {
+
+// base64_decode() 中，avx2 每块写出32字节(有效24字节)；out须多留的空间
+const size_t b64_dec_slack = 8;
+
+enum : uint8_t {
+    b64_invalid = 0xFF,
+    b64_space   = 0xFE,
+    b64_pad     = 0xFD,
+};
+
+struct b64_table_t
+{
+    char    c62;
+    char    c63;
+    char    enc[64];
+    uint8_t dec[256];
+
+    b64_table_t(char c62_, char c63_) : c62(c62_), c63(c63_)
+    {
+        const char* head = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+        for (int i = 0; i < 62; ++i) {
+            enc[i] = head[i];
+        }
+        enc[62] = c62;
+        enc[63] = c63;
+
+        for (auto& v : dec) {
+            v = b64_invalid;
+        }
+        for (int i = 0; i < 64; ++i) {
+            dec[static_cast<unsigned char>(enc[i])] = uint8_t(i);
+        }
+        for (char c : {' ', '\t', '\r', '\n'}) {
+            dec[static_cast<unsigned char>(c)] = b64_space;
+        }
+        dec[static_cast<unsigned char>('=')] = b64_pad;
+    }
+};
+
+const b64_table_t& b64_table(alphabet_t alphabet)
+{
+    static const b64_table_t std_table('+', '/');
+    static const b64_table_t url_table('-', '_');
+    return alphabet == alphabet_url ? url_table : std_table;
+}
+
+struct hex_table_t
+{
+    int8_t dec[256];
+
+    hex_table_t()
+    {
+        for (auto& v : dec) {
+            v = -1;
+        }
+        for (int i = 0; i < 10; ++i) {
+            dec['0' + i] = int8_t(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            dec['a' + i] = int8_t(10 + i);
+            dec['A' + i] = int8_t(10 + i);
+        }
+    }
+};
+
+const hex_table_t& hex_table()
+{
+    static const hex_table_t table;
+    return table;
+}
+
+const char* hex_digits(bool upper)
+{
+    return upper ? "0123456789ABCDEF" : "0123456789abcdef";
+}
+
+// 以下各simd实现，返回已处理的输入字节数；剩余部分由scalar处理
+
+#ifdef VARLISP_ENCKERNEL_X86
+
+// sse2
+
+__attribute__((target("sse2")))
+inline __m128i in_range_sse2(__m128i v, char lo, char hi)
+{
+    // 有符号比较；>= 0x80 的字节为负，总在范围之外
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(char(lo - 1))),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(char(hi + 1)), v));
+}
+
+__attribute__((target("sse2")))
+inline __m128i hex_digit_sse2(__m128i nibble, __m128i alpha)
+{
+    const __m128i gt9 = _mm_cmpgt_epi8(nibble, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibble, _mm_set1_epi8('0')), _mm_and_si128(gt9, alpha));
+}
+
+__attribute__((target("sse2")))
+size_t hex_encode_sse2(char* o, const char* p, size_t n, bool upper)
+{
+    const __m128i mask  = _mm_set1_epi8(0x0f);
+    const __m128i alpha = _mm_set1_epi8(char((upper ? 'A' : 'a') - '0' - 10));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i hi = hex_digit_sse2(_mm_and_si128(_mm_srli_epi16(v, 4), mask), alpha);
+        const __m128i lo = hex_digit_sse2(_mm_and_si128(v, mask), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// 16个十六进制字符 -> 16个半字节；ok 标记合法字符
+__attribute__((target("sse2")))
+inline __m128i hex_nibble_sse2(__m128i v, __m128i& ok)
+{
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i digit = in_range_sse2(v, '0', '9');
+    const __m128i alpha = in_range_sse2(lower, 'a', 'f');
+    ok = _mm_or_si128(digit, alpha);
+    return _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+                        _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+// 每16位：低字节为高半字节，高字节为低半字节 -> 低字节为合成后的字节
+__attribute__((target("sse2")))
+inline __m128i hex_merge_sse2(__m128i nibbles)
+{
+    return _mm_and_si128(_mm_or_si128(_mm_slli_epi16(nibbles, 4), _mm_srli_epi16(nibbles, 8)),
+                         _mm_set1_epi16(0xff));
+}
+
+__attribute__((target("sse2")))
+size_t hex_decode_sse2(char* o, const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m128i ok0;
+        __m128i ok1;
+        const __m128i n0 =
+            hex_nibble_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), ok0);
+        const __m128i n1 =
+            hex_nibble_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16)), ok1);
+        if (_mm_movemask_epi8(_mm_and_si128(ok0, ok1)) != 0xFFFF) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + i / 2),
+                         _mm_packus_epi16(hex_merge_sse2(n0), hex_merge_sse2(n1)));
+    }
+    return i;
+}
+
+// avx2
+
+__attribute__((target("avx2")))
+inline __m256i in_range_avx2(__m256i v, char lo, char hi)
+{
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(char(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(char(hi + 1)), v));
+}
+
+__attribute__((target("avx2")))
+inline __m256i hex_digit_avx2(__m256i nibble, __m256i alpha)
+{
+    const __m256i gt9 = _mm256_cmpgt_epi8(nibble, _mm256_set1_epi8(9));
+    return _mm256_add_epi8(_mm256_add_epi8(nibble, _mm256_set1_epi8('0')),
+                           _mm256_and_si256(gt9, alpha));
+}
+
+__attribute__((target("avx2")))
+size_t hex_encode_avx2(char* o, const char* p, size_t n, bool upper)
+{
+    const __m256i mask  = _mm256_set1_epi8(0x0f);
+    const __m256i alpha = _mm256_set1_epi8(char((upper ? 'A' : 'a') - '0' - 10));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i hi = hex_digit_avx2(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask), alpha);
+        const __m256i lo = hex_digit_avx2(_mm256_and_si256(v, mask), alpha);
+        // unpack 按128位通道进行；再按顺序拼回
+        const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 2 * i),
+                            _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 2 * i + 32),
+                            _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i hex_nibble_avx2(__m256i v, __m256i& ok)
+{
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i digit = in_range_avx2(v, '0', '9');
+    const __m256i alpha = in_range_avx2(lower, 'a', 'f');
+    ok = _mm256_or_si256(digit, alpha);
+    return _mm256_or_si256(
+        _mm256_and_si256(digit, _mm256_sub_epi8(v, _mm256_set1_epi8('0'))),
+        _mm256_and_si256(alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+}
+
+__attribute__((target("avx2")))
+inline __m256i hex_merge_avx2(__m256i nibbles)
+{
+    return _mm256_and_si256(
+        _mm256_or_si256(_mm256_slli_epi16(nibbles, 4), _mm256_srli_epi16(nibbles, 8)),
+        _mm256_set1_epi16(0xff));
+}
+
+__attribute__((target("avx2")))
+size_t hex_decode_avx2(char* o, const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i ok0;
+        __m256i ok1;
+        const __m256i n0 =
+            hex_nibble_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), ok0);
+        const __m256i n1 =
+            hex_nibble_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 32)), ok1);
+        if (_mm256_movemask_epi8(_mm256_and_si256(ok0, ok1)) != -1) {
+            break;
+        }
+        const __m256i packed = _mm256_packus_epi16(hex_merge_avx2(n0), hex_merge_avx2(n1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + i / 2),
+                            _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return i;
+}
+
+// 24字节 -> 32个base64字符(W. Muła 的方法)
+__attribute__((target("avx2")))
+size_t base64_encode_avx2(char* o, const char* p, size_t n, const b64_table_t& table)
+{
+    const __m256i shuf = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                          1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    // 各区间的偏移：0-25 -> 'A'，26-51 -> 'a'，52-61 -> '0'，62、63
+    const char d = '0' - 52;
+    const __m256i shift = _mm256_setr_epi8(
+        'a' - 26, d, d, d, d, d, d, d, d, d, d, char(table.c62 - 62), char(table.c63 - 63), 'A', 0, 0,
+        'a' - 26, d, d, d, d, d, d, d, d, d, d, char(table.c62 - 62), char(table.c63 - 63), 'A', 0, 0);
+    size_t i = 0;
+    size_t k = 0;
+    // 每次读取p+i、p+i+12处的各16字节，各用其中12字节
+    for (; i + 28 <= n; i += 24, k += 32) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_shuffle_epi8(v, shuf);
+
+        const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i idx = _mm256_or_si256(t1, t3);
+
+        __m256i sel = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+        sel = _mm256_or_si256(sel, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        const __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shift, sel), idx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + k), out);
+    }
+    return i;
+}
+
+// 32个base64字符 -> 24字节；遇到含非法字符(包括空白、'=')的块即停止
+__attribute__((target("avx2")))
+size_t base64_decode_avx2(char* o, const char* p, size_t n, const b64_table_t& table)
+{
+    const __m256i pack_shuf =
+        _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                         2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i pack_perm = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    size_t i = 0;
+    size_t k = 0;
+    for (; i + 32 <= n; i += 32, k += 24) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i upper = in_range_avx2(v, 'A', 'Z');
+        const __m256i lower = in_range_avx2(v, 'a', 'z');
+        const __m256i digit = in_range_avx2(v, '0', '9');
+        const __m256i e62   = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(table.c62));
+        const __m256i e63   = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(table.c63));
+        const __m256i ok    = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                              _mm256_or_si256(digit, _mm256_or_si256(e62, e63)));
+        if (_mm256_movemask_epi8(ok) != -1) {
+            break;
+        }
+        __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(e62, _mm256_set1_epi8(char(62 - table.c62))));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(e63, _mm256_set1_epi8(char(63 - table.c63))));
+        v = _mm256_add_epi8(v, shift);
+
+        // 4个6位 -> 24位
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack_shuf);
+        v = _mm256_permutevar8x32_epi32(v, pack_perm);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + k), v);
+    }
+    return i;
+}
+
+#endif // VARLISP_ENCKERNEL_X86
+
+inline bool use_avx2()
+{
+#ifdef VARLISP_ENCKERNEL_X86
+    return strkernel::get_isa() == strkernel::isa_avx2;
+#else
+    return false;
+#endif
+}
+
+// 向已扩展的out写入；返回写入位置
+inline char* grow(std::string& out, size_t n)
+{
+    const size_t base = out.size();
+    out.resize(base + n);
+    return &out[base];
+}
+
+}  // namespace
+
+size_t base64_encoded_size(size_t n, alphabet_t alphabet)
+{
+    if (alphabet == alphabet_url) {
+        return n / 3 * 4 + (n % 3 != 0 ? n % 3 + 1 : 0);
+    }
+    return (n + 2) / 3 * 4;
+}
+
+void base64_encode(std::string& out, sss::string_view in, alphabet_t alphabet)
+{
+    const auto& table = b64_table(alphabet);
+    const auto* p = reinterpret_cast<const unsigned char*>(in.data());
+    const size_t n = in.size();
+    char* o = grow(out, base64_encoded_size(n, alphabet));
+
+    size_t i = 0;
+#ifdef VARLISP_ENCKERNEL_X86
+    if (use_avx2()) {
+        i = base64_encode_avx2(o, in.data(), n, table);
+        o += i / 3 * 4;
+    }
+#endif
+    for (; i + 3 <= n; i += 3) {
+        const uint32_t v = uint32_t(p[i]) << 16 | uint32_t(p[i + 1]) << 8 | p[i + 2];
+        o[0] = table.enc[v >> 18];
+        o[1] = table.enc[(v >> 12) & 0x3F];
+        o[2] = table.enc[(v >> 6) & 0x3F];
+        o[3] = table.enc[v & 0x3F];
+        o += 4;
+    }
+    const bool pad = alphabet == alphabet_std;
+    if (n - i == 1) {
+        const uint32_t v = uint32_t(p[i]) << 16;
+        *o++ = table.enc[v >> 18];
+        *o++ = table.enc[(v >> 12) & 0x3F];
+        if (pad) {
+            *o++ = '=';
+            *o++ = '=';
+        }
+    }
+    else if (n - i == 2) {
+        const uint32_t v = uint32_t(p[i]) << 16 | uint32_t(p[i + 1]) << 8;
+        *o++ = table.enc[v >> 18];
+        *o++ = table.enc[(v >> 12) & 0x3F];
+        *o++ = table.enc[(v >> 6) & 0x3F];
+        if (pad) {
+            *o++ = '=';
+        }
+    }
+}
+
+bool base64_decode(std::string& out, sss::string_view in, alphabet_t alphabet)
+{
+    const auto& table = b64_table(alphabet);
+    const char* p = in.data();
+    const size_t n = in.size();
+    char* o = grow(out, (n + 3) / 4 * 3 + b64_dec_slack);
+
+#ifdef VARLISP_ENCKERNEL_X86
+    const bool simd = use_avx2();
+    // simd 在某块上失败后，scalar 至少处理到该块末尾，再重试
+    size_t retry_at = 0;
+#endif
+    uint32_t acc = 0;
+    int cnt = 0;
+    size_t i = 0;
+    while (i < n) {
+#ifdef VARLISP_ENCKERNEL_X86
+        if (simd && cnt == 0 && i >= retry_at) {
+            const size_t done = base64_decode_avx2(o, p + i, n - i, table);
+            i += done;
+            o += done / 4 * 3;
+            retry_at = i + 32;
+            if (i == n) {
+                break;
+            }
+        }
+#endif
+        const uint8_t v = table.dec[static_cast<unsigned char>(p[i])];
+        if (v < 64) {
+            acc = acc << 6 | v;
+            if (++cnt == 4) {
+                o[0] = char(acc >> 16);
+                o[1] = char(acc >> 8);
+                o[2] = char(acc);
+                o += 3;
+                acc = 0;
+                cnt = 0;
+            }
+        }
+        else if (v == b64_pad) {
+            break;
+        }
+        else if (v != b64_space) {
+            return false;
+        }
+        ++i;
+    }
+
+    // 末尾：只允许'='与空白
+    size_t npad = 0;
+    for (; i < n; ++i) {
+        const uint8_t v = table.dec[static_cast<unsigned char>(p[i])];
+        if (v == b64_pad) {
+            ++npad;
+        }
+        else if (v != b64_space) {
+            return false;
+        }
+    }
+    if (cnt == 1 || (npad != 0 && (cnt == 0 || cnt + npad != 4))) {
+        return false;
+    }
+    if (cnt == 2) {
+        *o++ = char(acc >> 4);
+    }
+    else if (cnt == 3) {
+        *o++ = char(acc >> 10);
+        *o++ = char(acc >> 2);
+    }
+    out.resize(size_t(o - out.data()));
+    return true;
+}
+
+void hex_encode(std::string& out, sss::string_view in, bool upper)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(in.data());
+    const size_t n = in.size();
+    char* o = grow(out, 2 * n);
+
+    size_t i = 0;
+#ifdef VARLISP_ENCKERNEL_X86
+    switch (strkernel::get_isa()) {
+        case strkernel::isa_avx2:
+            i = hex_encode_avx2(o, in.data(), n, upper);
+            break;
+        case strkernel::isa_sse2:
+            i = hex_encode_sse2(o, in.data(), n, upper);
+            break;
+        default:
+            break;
+    }
+#endif
+    const char* digits = hex_digits(upper);
+    for (; i < n; ++i) {
+        o[2 * i]     = digits[p[i] >> 4];
+        o[2 * i + 1] = digits[p[i] & 0x0F];
+    }
+}
+
+bool hex_decode(std::string& out, sss::string_view in)
+{
+    const char* p = in.data();
+    const size_t n = in.size();
+    if (n % 2 != 0) {
+        return false;
+    }
+    char* o = grow(out, n / 2);
+
+    size_t i = 0;
+#ifdef VARLISP_ENCKERNEL_X86
+    switch (strkernel::get_isa()) {
+        case strkernel::isa_avx2:
+            i = hex_decode_avx2(o, p, n);
+            break;
+        case strkernel::isa_sse2:
+            i = hex_decode_sse2(o, p, n);
+            break;
+        default:
+            break;
+    }
+#endif
+    const auto& table = hex_table();
+    for (; i < n; i += 2) {
+        const int hi = table.dec[static_cast<unsigned char>(p[i])];
+        const int lo = table.dec[static_cast<unsigned char>(p[i + 1])];
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        o[i / 2] = char(hi << 4 | lo);
+    }
+    return true;
+}
+
+} // namespace varlisp::detail::enckernel
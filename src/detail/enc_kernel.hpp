@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "string_kernel.hpp"
+
+namespace varlisp::detail::enckernel {
+
+// base64、hex 编解码的向量化实现；与strkernel共用运行时选择的指令集
+// (strkernel::get_isa())：
+//  avx2   - base64、hex 每次处理24/32字节；
+//  sse2   - hex 每次处理16字节；base64 需要pshufb(ssse3)，此级别用scalar；
+//  scalar - 查表。
+// 各实现结果完全一致。
+//
+// 结果追加到out：先按结果的(最大)长度扩展out，各实现直接写入其中，最后截去多余部分；
+// 调用方可把out移入String，不再复制。
+
+enum alphabet_t {
+    alphabet_std = 0,   // RFC 4648 §4："+/"，补齐'='
+    alphabet_url = 1,   // RFC 4648 §5："-_"，不补'='
+};
+
+size_t base64_encoded_size(size_t n, alphabet_t alphabet);
+
+void base64_encode(std::string& out, sss::string_view in, alphabet_t alphabet);
+
+// 忽略空白(" \t\r\n")；'='只能出现在末尾，可省略；
+// 非法输入返回false，此时out的内容不确定
+bool base64_decode(std::string& out, sss::string_view in, alphabet_t alphabet);
+
+// 每字节两个十六进制字符；默认小写
+void hex_encode(std::string& out, sss::string_view in, bool upper = false);
+
+// 大小写均可；长度须为偶数；非法输入返回false，此时out的内容不确定
+bool hex_decode(std::string& out, sss::string_view in);
+
+} // namespace varlisp::detail::enckernel
@@ -8,12 +8,14 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <stdexcept>
 
 #include <sss/macro/defer.hpp>
 #include <sss/path.hpp>
 #include <sss/path/glob_path.hpp>
 #include <sss/util/PostionThrow.hpp>
+#include <sss/util/utf8.hpp>
 
 #if defined (__APPLE__)
 #   include <fcntl.h>
@@ -118,6 +120,93 @@ static void on_exit()
     }
 }
 
+typedef std::map<int, std::unique_ptr<buffered_reader_t>> fd_reader_map_type;
+
+fd_reader_map_type& get_fd_reader_map()
+{
+    static fd_reader_map_type fd_reader_map;
+    return fd_reader_map;
+}
+
+size_t& reader_buffer_size()
+{
+    static size_t buf_size = 64 * 1024;
+    return buf_size;
+}
+
+buffered_reader_t& get_reader(int fd)
+{
+    auto& p_reader = get_fd_reader_map()[fd];
+    if (!p_reader) {
+        p_reader.reset(new buffered_reader_t(fd, reader_buffer_size()));
+    }
+    return *p_reader;
+}
+
+void sync_reader(int fd)
+{
+    auto& m = get_fd_reader_map();
+    auto it = m.find(fd);
+    if (it == m.end()) {
+        return;
+    }
+    if (size_t pending = it->second->pending()) {
+        if (::lseek(fd, -int64_t(pending), SEEK_CUR) == -1) {
+            // NOTE 管道等：数据无法退回内核；保留读缓冲，由read_fd()取出
+            return;
+        }
+    }
+    m.erase(it);
+}
+
+int64_t read_fd(int fd, char* buf, size_t size)
+{
+    auto& m = get_fd_reader_map();
+    auto it = m.find(fd);
+    if (it != m.end()) {
+        if (it->second->pending() != 0) {
+            return int64_t(it->second->take(buf, size));
+        }
+        m.erase(it);
+    }
+    return ::read(fd, buf, size);
+}
+
+void drop_reader(int fd)
+{
+    get_fd_reader_map().erase(fd);
+}
+
+int64_t read_char(int fd)
+{
+    auto& reader = get_reader(fd);
+    int c = reader.next_byte();
+    if (c == -1) {
+        return -1;
+    }
+    char buf[6] = {char(c)};
+    int64_t len = sss::util::utf8::next_length(buf, buf + 1);
+    if (len <= 1) {
+        return int64_t(uint8_t(buf[0]));
+    }
+    for (int64_t i = 1; i < len; ++i) {
+        if ((c = reader.next_byte()) == -1) {
+            return -1;
+        }
+        buf[i] = char(c);
+    }
+    auto ch = sss::util::utf8::peek(buf, buf + len);
+    if (ch.second != len) {
+        return -1;
+    }
+    return int64_t(ch.first);
+}
+
+int64_t read_byte(int fd)
+{
+    return get_reader(fd).next_byte();
+}
+
 void list_opened_fd(std::function<void(int fd, const std::string& path)> && func) {
 #if defined (__APPLE__)
     int pid = getpid();
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
 
+#include "buffered_reader.hpp"
+
 namespace varlisp::detail::file {
 
 std::string get_fname_from_fd(int fd);
@@ -11,4 +15,27 @@ bool register_fd(int fd);
 bool unregister_fd(int fd);
 void list_opened_fd(std::function<void(int fd, const std::string& path)> && func);
 
+// 各fd的读缓冲；read-line、read-char、read-byte 经由此读取，首次使用时创建
+buffered_reader_t& get_reader(int fd);
+
+// 将内核中的文件位置，退回到已读入、未消费的位置，并丢弃读缓冲；
+// lseek、write、read-all、流式函数等直接操作fd之前调用。
+// 管道等不能lseek的，保留未消费的数据，由read_fd()先行取出
+void sync_reader(int fd);
+
+// 同::read(2)；但先取出该fd读缓冲中未消费的数据(见sync_reader)，
+// 取尽后丢弃读缓冲。直接读fd的流式函数(read-all、regex-stream、
+// gzip/zstd、iconv、digest等)都经由此读取
+int64_t read_fd(int fd, char* buf, size_t size);
+
+// 丢弃读缓冲；close 时调用
+void drop_reader(int fd);
+
+// 新建读缓冲的大小；已有的读缓冲不受影响
+size_t& reader_buffer_size();
+
+// 经读缓冲读取一个utf8字符、一个字节；结尾或出错，返回-1
+int64_t read_char(int fd);
+int64_t read_byte(int fd);
+
 } // namespace varlisp::detail::file
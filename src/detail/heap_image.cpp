@@ -0,0 +1,122 @@
+#include "heap_image.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+#include <sss/colorlog.hpp>
+#include <sss/path.hpp>
+#include <sss/util/PostionThrow.hpp>
+
+#include "../builtin.hpp"
+#include "../environment.hpp"
+
+#include "mmap_file.hpp"
+#include "object_codec.hpp"
+
+namespace varlisp::detail::image {
+
+namespace {
+
+const char     image_magic[8] = {'V', 'L', 'S', 'P', 'I', 'M', 'G', '\0'};
+const uint32_t image_version  = 2;  // 2: regex带上编译选项
+
+}  // namespace
+
+int64_t save(const varlisp::Environment& env, const std::string& path)
+{
+    std::string body;
+    uint32_t count = 0;
+    for (const auto& it : env) {
+        const auto& name = it.first;
+        const auto& value = it.second.first;
+        const bool is_const = it.second.second.is_const;
+        // NOTE 内建函数，启动时会重新注册
+        if (name == "_" || (is_const && boost::get<varlisp::Builtin>(&value))) {
+            continue;
+        }
+        const size_t mark = body.size();
+        try {
+            codec::put_string(body, name);
+            codec::put_u8(body, is_const ? 1 : 0);
+            codec::encode(body, value);
+            ++count;
+        }
+        catch (std::runtime_error& e) {
+            COLOG_INFO("save-image skip `", name, "`: ", e.what());
+            body.resize(mark);
+        }
+    }
+
+    std::string head(image_magic, sizeof(image_magic));
+    codec::put_u32(head, image_version);
+    codec::put_u32(head, count);
+
+    sss::path::mkpath(sss::path::dirname(path));
+    std::string tmp_path = path + "." + std::to_string(::getpid());
+    {
+        std::ofstream ofs(tmp_path.c_str(), std::ios_base::out |
+                                                std::ios_base::binary |
+                                                std::ios_base::trunc);
+        ofs.write(head.data(), head.size());
+        ofs.write(body.data(), body.size());
+        if (!ofs) {
+            std::remove(tmp_path.c_str());
+            SSS_POSITION_THROW(std::runtime_error, "write image `", path,
+                               "` failed");
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        SSS_POSITION_THROW(std::runtime_error, "rename image `", path,
+                           "` failed: ", std::strerror(errno));
+    }
+    return count;
+}
+
+int64_t restore(varlisp::Environment& env, const std::string& path)
+{
+    mmap_file_t file(path);
+    auto data = file.view();
+    if (data.size() < sizeof(image_magic) ||
+        std::memcmp(data.data(), image_magic, sizeof(image_magic)) != 0) {
+        SSS_POSITION_THROW(std::runtime_error, "`", path,
+                           "` is not a varlisp image");
+    }
+    codec::reader_t reader(sss::string_view(data.data() + sizeof(image_magic),
+                                            data.size() - sizeof(image_magic)));
+    if (reader.get_u32() != image_version) {
+        SSS_POSITION_THROW(std::runtime_error, "`", path,
+                           "` image version mismatch");
+    }
+    // NOTE 先全部解码，再写入env；避免损坏的镜像只恢复了一半
+    std::vector<std::tuple<std::string, bool, Object>> items;
+    uint32_t count = reader.get_u32();
+    items.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string name = reader.get_string().to_string();
+        bool is_const = reader.get_u8() != 0;
+        items.emplace_back(std::move(name), is_const, reader.decode());
+    }
+    for (auto& item : items) {
+        // NOTE 不用operator[]：名字中的':'会被当作json路径
+        if (Object* p_obj = env.find(std::get<0>(item))) {
+            if (!std::get<1>(item)) {
+                *p_obj = std::move(std::get<2>(item));
+            }
+        }
+        else {
+            env.insert(std::move(std::get<0>(item)),
+                       std::move(std::get<2>(item)), std::get<1>(item));
+        }
+    }
+    return count;
+}
+
+} // namespace varlisp::detail::image
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace varlisp {
+struct Environment;
+} // namespace varlisp
+
+namespace varlisp::detail::image {
+
+// 将env(全局环境)中的对象，以detail::codec二进制格式，整体写入path；
+// 启动时注册的内建函数、常量，以及"_"，不写入；
+// 无法编码的对象(gumbo节点、lazy-seq等)跳过。
+// 返回写入的条目数
+int64_t save(const varlisp::Environment& env, const std::string& path);
+
+// mmap读取path，并将其中的条目，写回env；
+// 已存在的常量不会被覆盖。返回恢复的条目数
+int64_t restore(varlisp::Environment& env, const std::string& path);
+
+} // namespace varlisp::detail::image
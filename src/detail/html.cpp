@@ -1,6 +1,16 @@
 #include "html.hpp"
 #include "../object.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 #include <re2/re2.h>
 
 #include <gq/DocType.h>
@@ -118,9 +128,9 @@ static void trim_to(std::string& str, char mark)
     }
 }
 
-std::string getResourceAuto(const std::string& output_dir, const std::string& url,
-                            resource_manager_t& rs_mgr, const ss1x::http::Headers& request_header,
-                            const std::string&  /*proxy_domain*/, int  /*proxy_port*/)
+// 下载url对应的资源，保存到output_dir；不访问resource_manager_t，可在多个线程中同时调用
+local_info_t fetch_resource(const std::string& output_dir, const std::string& url,
+                            const ss1x::http::Headers& request_header)
 {
     std::string max_content;
     ss1x::http::Headers respond_headers;
@@ -161,8 +171,7 @@ std::string getResourceAuto(const std::string& output_dir, const std::string& ur
 
     if (respond_headers.status_code / 100 != 2) { // 200
         COLOG_ERROR(url);
-        rs_mgr[url] = local_info_t{"", 0, fs_ERROR};
-        return "";
+        return local_info_t{"", 0, fs_ERROR};
     }
     // NOTE 有类图片资源，是形如:
     // http://m.tiebaimg.com/timg?wapp&q....
@@ -206,20 +215,36 @@ std::string getResourceAuto(const std::string& output_dir, const std::string& ur
 #endif
 
     if (sss::path::file_exists(output_path) == sss::PATH_TO_FILE) {
-        rs_mgr[url] = {output_path, max_content.size(), fs_EXIST};
-        return output_path;
+        return {output_path, max_content.size(), fs_EXIST};
     }
-    std::ofstream ofs(output_path);
-    if (!ofs.good()) {
-        rs_mgr[url] = {output_path, max_content.size(), fs_ERROR};
-        COLOG_ERROR("open file ", output_path, " to write, error.");
-        return output_path;
+    // NOTE 不同url可能得到相同内容(即同一文件名)；先写临时文件再rename，
+    // 避免并发下载时，两个线程同时写一个文件
+    std::ostringstream tmp_path;
+    tmp_path << output_path << ".tmp." << std::this_thread::get_id();
+    {
+        std::ofstream ofs(tmp_path.str(), std::ios_base::out | std::ios_base::binary);
+        if (!ofs.good()) {
+            COLOG_ERROR("open file ", tmp_path.str(), " to write, error.");
+            return {output_path, max_content.size(), fs_ERROR};
+        }
+        ofs << max_content;
+    }
+    if (std::rename(tmp_path.str().c_str(), output_path.c_str()) != 0) {
+        std::remove(tmp_path.str().c_str());
+        COLOG_ERROR("rename ", tmp_path.str(), " to ", output_path, " error.");
+        return {output_path, max_content.size(), fs_ERROR};
     }
-    ofs << max_content;
 
     COLOG_INFO(url, " -> ", output_path, "; ", max_content.size(), " bytes.");
-    rs_mgr[url] = {output_path, max_content.size(), fs_DONE};
-    return output_path;
+    return {output_path, max_content.size(), fs_DONE};
+}
+
+std::string getResourceAuto(const std::string& output_dir, const std::string& url,
+                            resource_manager_t& rs_mgr, const ss1x::http::Headers& request_header,
+                            const std::string&  /*proxy_domain*/, int  /*proxy_port*/)
+{
+    rs_mgr[url] = fetch_resource(output_dir, url, request_header);
+    return rs_mgr[url].path;
 }
 
 template<typename Container, typename ValueT>
@@ -233,6 +258,64 @@ bool contains(const Container& c, const ValueT& tar)
     return false;
 }
 
+// 需要下载到本地的资源属性：img/script/embed.src，以及样式表link.href
+bool is_resource_attr(GumboNode* apNode, const std::string& tagName, const std::string& attrName)
+{
+    return (tagName == "img" && attrName == "src") ||
+           (tagName == "script" && attrName == "src") ||
+           (tagName == "embed" && attrName == "src") ||
+           (tagName == "link" && attrName == "href" &&
+            detail::html::getAttribute(apNode, "rel") == "stylesheet");
+}
+
+// 去掉页内锚点；返回是否需要下载(非空，且不是 data: 内联资源)
+bool normalize_resource_url(std::string& url)
+{
+    static RE2 local_anchor_pattern{R"(#\w+$)"};
+    RE2::GlobalReplace(&url, local_anchor_pattern, "");
+
+    // NOTE https://www.jb51.net/css/41981.html
+    // date:,data:image/png,data:image/jpeg!
+    return !url.empty() && !sss::is_begin_with(url, "data:");
+}
+
+const RE2& style_url_pattern()
+{
+    static RE2 re(R"(url\((.+?)\))");
+    return re;
+}
+
+void collect_resource_urls(GumboNode* apNode, std::vector<std::string>& urls)
+{
+    if (apNode->type != GUMBO_NODE_ELEMENT && apNode->type != GUMBO_NODE_DOCUMENT) {
+        return;
+    }
+    if (apNode->type == GUMBO_NODE_ELEMENT) {
+        const std::string tagName = CQueryUtil::tagName(apNode);
+        for (size_t i = 0; i < CQueryUtil::attrNum(apNode); ++i) {
+            std::string attrName = CQueryUtil::nthAttr(apNode, i)->name;
+            if (is_resource_attr(apNode, tagName, attrName)) {
+                std::string url = CQueryUtil::nthAttr(apNode, i)->value;
+                if (normalize_resource_url(url)) {
+                    urls.push_back(std::move(url));
+                }
+            }
+            else if (attrName == "style") {
+                re2::StringPiece style = CQueryUtil::nthAttr(apNode, i)->value;
+                re2::StringPiece url;
+                while (RE2::FindAndConsume(&style, style_url_pattern(), &url)) {
+                    if (!url.empty()) {
+                        urls.emplace_back(url.data(), url.size());
+                    }
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < CQueryUtil::childNum(apNode); ++i) {
+        collect_resource_urls(CQueryUtil::nthChild(apNode, i), urls);
+    }
+}
+
 void gumbo_rewrite_outterHtml(std::ostream& o, GumboNode* apNode,
                               CQueryUtil::CIndenter& ind,
                               const std::string& output_dir,
@@ -302,29 +385,19 @@ void gumbo_rewrite_outterHtml(std::ostream& o, GumboNode* apNode,
                         // 这种，附带版本号的东西了。
                         //
                     }
-                    if ((tagName == "img" && attrName == "src") ||
-                        (tagName == "script" && attrName == "src") ||
-                        (tagName == "embed" && attrName == "src") ||
-                        (tagName == "link" && attrName == "href" && detail::html::getAttribute(apNode, "rel") == "stylesheet"))
+                    if (is_resource_attr(apNode, tagName, attrName))
                     {
                         std::string url = CQueryUtil::nthAttr(apNode, i)->value;
 
-                        static RE2 local_anchor_pattern{R"(#\w+$)"};
-
-                        RE2::GlobalReplace(&url, local_anchor_pattern, "");
-
-                        bool is_inline_href = sss::is_begin_with(url, "data:");
-
-                        // NOTE https://www.jb51.net/css/41981.html
-                        // date:,data:image/png,data:image/jpeg!
-                        if (!is_inline_href &&
-                            !url.empty() && rs_mgr.find(url) == rs_mgr.end()) {
+                        // NOTE 一般已由prefetch_resources()并发下载；这里只补漏
+                        bool is_fetchable = normalize_resource_url(url);
+                        if (is_fetchable && rs_mgr.find(url) == rs_mgr.end()) {
                             //std::cout << url.substr(0,6) << std::endl;
                             std::cout << url << std::endl;
                             getResourceAuto(output_dir, url, rs_mgr, request_header, proxy_domain, proxy_port);
                         }
 
-                        if (!is_inline_href && !url.empty() && rs_mgr[url].fsize && rs_mgr[url].is_ok()) {
+                        if (is_fetchable && rs_mgr[url].fsize && rs_mgr[url].is_ok()) {
                             o << " " << attrName << "=\""
                                 << htmlEntityEscape(sss::path::basename(rs_mgr[url].path)) << "\"";
                         }
@@ -339,8 +412,7 @@ void gumbo_rewrite_outterHtml(std::ostream& o, GumboNode* apNode,
                         std::string style_str = CQueryUtil::nthAttr(apNode, i)->value;
                         // TODO
                         // <span class="LinkCard-backdrop" style="background-image:url(https://pic4.zhimg.com/v2-7d66f99141b9c5ccad48fb4ee54d8bbf_ipico.jpg)"></span>
-                        static RE2 re(R"(url\((.+?)\))");
-                        RE2::FullMatch(style_str, re);
+                        const RE2& re = style_url_pattern();
                         std::ostringstream oss;
 
                         std::vector<re2::StringPiece> sub_matches;
@@ -479,6 +551,86 @@ void gumbo_rewrite_outterHtml(std::ostream& o, GumboNode* apNode,
     }
 }
 
+void collect_resource_urls(const gumboNode& g, std::vector<std::string>& urls)
+{
+    CNode n = g.getCNode();
+    if (!n.valid()) {
+        return;
+    }
+    collect_resource_urls(reinterpret_cast<GumboNode*>(n.get()), urls);
+}
+
+prefetch_stat_t prefetch_resources(const std::vector<std::string>& urls,
+                                   const std::string& output_dir,
+                                   resource_manager_t& rs_mgr,
+                                   const ss1x::http::Headers& request_header)
+{
+    using clock_t = std::chrono::steady_clock;
+    auto elapsed_us = [](clock_t::time_point beg) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now() - beg).count();
+    };
+
+    // 去重：已下载过的，以及本批中重复的
+    std::vector<std::string> todo;
+    std::set<std::string> seen;
+    for (const auto& url : urls) {
+        if (rs_mgr.find(url) == rs_mgr.end() && seen.insert(url).second) {
+            todo.push_back(url);
+        }
+    }
+
+    prefetch_stat_t stat;
+    stat.urls = int64_t(todo.size());
+    if (todo.empty()) {
+        return stat;
+    }
+
+    std::vector<local_info_t> results(todo.size());
+    std::vector<int64_t> cost_us(todo.size(), 0);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < todo.size(); i = next++) {
+            auto beg = clock_t::now();
+            try {
+                results[i] = fetch_resource(output_dir, todo[i], request_header);
+            }
+            catch (std::exception& e) {
+                COLOG_ERROR(todo[i], e.what());
+                results[i] = local_info_t{"", 0, fs_ERROR};
+            }
+            cost_us[i] = elapsed_us(beg);
+        }
+    };
+
+    auto beg = clock_t::now();
+    const size_t thread_cnt = std::min(std::max<size_t>(get_prefetch_concurrency(), 1), todo.size());
+    std::vector<std::thread> threads;
+    threads.reserve(thread_cnt);
+    for (size_t i = 0; i < thread_cnt; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    stat.wall_us = elapsed_us(beg);
+
+    for (size_t i = 0; i < todo.size(); ++i) {
+        if (results[i].is_ok()) {
+            stat.fetched++;
+        }
+        else {
+            stat.failed++;
+        }
+        stat.total_us += cost_us[i];
+        stat.slowest_us = std::max(stat.slowest_us, cost_us[i]);
+        COLOG_DEBUG(todo[i], cost_us[i] / 1000.0, "ms");
+        rs_mgr[todo[i]] = std::move(results[i]);
+    }
+    COLOG_INFO("prefetch ", stat.urls, " resources by ", thread_cnt, " threads; ",
+               stat.failed, " failed; ", stat.wall_us / 1000.0, "ms");
+    return stat;
+}
+
 void gumbo_rewrite_impl(int fd, const gumboNode& g,
                         const std::string& output_dir, resource_manager_t& rs_mgr,
                         const ss1x::http::Headers& request_header,
@@ -515,6 +667,12 @@ void         set_gqnode_indent(const std::string& ind)
     get_gqnode_indent().assign(ind, 0, space_cnt);
 }
 
+size_t&      get_prefetch_concurrency()
+{
+    static size_t concurrency = 8;
+    return concurrency;
+}
+
 std::string& get_gqnode_indent()
 {
     static std::string indent = " ";
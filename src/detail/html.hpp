@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include <map>
+#include <string>
+#include <vector>
 #include <utility>
 
 #include <ss1x/asio/headers.hpp>
@@ -58,6 +60,26 @@ inline std::ostream& operator << (std::ostream& o, const local_info_t& i)
 
 using resource_manager_t = std::map<std::string, local_info_t>;
 
+// 收集g中需要下载到本地的资源url(图片、脚本、样式表、style中的url())；
+// 规则同gumbo_rewrite_impl()
+void collect_resource_urls(const gumboNode& g, std::vector<std::string>& urls);
+
+struct prefetch_stat_t {
+    int64_t urls       = 0;     // 实际需要下载的url数(已去重)
+    int64_t fetched    = 0;
+    int64_t failed     = 0;
+    int64_t wall_us    = 0;     // 并发下载的总耗时
+    int64_t total_us   = 0;     // 各url耗时之和
+    int64_t slowest_us = 0;
+};
+
+// 用至多get_prefetch_concurrency()个线程并发下载；结果写入rs_mgr。
+// 之后的gumbo_rewrite_impl()，直接使用rs_mgr中的结果，不再逐个下载
+prefetch_stat_t prefetch_resources(const std::vector<std::string>& urls,
+                                   const std::string& output_dir,
+                                   resource_manager_t& rs_mgr,
+                                   const ss1x::http::Headers& request_header);
+
 void gumbo_rewrite_impl(int fd, const gumboNode& g,
                         const std::string& output_dir,
                         resource_manager_t& rs_mgr,
@@ -65,6 +87,8 @@ void gumbo_rewrite_impl(int fd, const gumboNode& g,
                         const std::string& proxy_domain = "",
                         int proxy_port = 0);
 
+size_t&      get_prefetch_concurrency();
+
 void         set_gqnode_indent(const std::string& ind);
 std::string& get_gqnode_indent();
 
@@ -0,0 +1,652 @@
+#include "html2md.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <gq/QueryUtil.h>
+
+namespace varlisp::detail::html2md {
+
+namespace {
+
+inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+const char* attr_of(GumboNode* node, const char* name)
+{
+    for (size_t i = 0; i < CQueryUtil::attrNum(node); ++i) {
+        GumboAttribute* attr = CQueryUtil::nthAttr(node, i);
+        if (std::strcmp(attr->name, name) == 0) {
+            return attr->value;
+        }
+    }
+    return "";
+}
+
+// class="language-cpp" 或 "lang-cpp" -> "cpp"
+std::string code_lang_of(GumboNode* node)
+{
+    std::string_view cls = attr_of(node, "class");
+    for (std::string_view prefix : {std::string_view("language-"), std::string_view("lang-")}) {
+        auto pos = cls.find(prefix);
+        if (pos != std::string_view::npos && (pos == 0 || is_space(cls[pos - 1]))) {
+            auto beg = pos + prefix.size();
+            auto end = beg;
+            while (end < cls.size() && !is_space(cls[end])) {
+                ++end;
+            }
+            return std::string(cls.data() + beg, end - beg);
+        }
+    }
+    return "";
+}
+
+void append_escaped(std::string& out, std::string_view s, const char* specials)
+{
+    for (char c : s) {
+        if (std::strchr(specials, c) != nullptr) {
+            out += '\\';
+        }
+        out += c;
+    }
+}
+
+// NOTE 遍历时，换行不立即输出，而是记在m_pending中，由下一次输出时补上；
+// 这样，相邻的块元素之间，只保留一个空行；并且每行开头，都能补上当前的前缀
+// (引用的"> "、列表项的缩进)。
+class converter_t
+{
+public:
+    explicit converter_t(std::string& out) : m_out(out), m_start(out.size()) {}
+
+public:
+    void walk(GumboNode* node)
+    {
+        switch (node->type) {
+            case GUMBO_NODE_DOCUMENT:
+                walk_children(node);
+                break;
+
+            case GUMBO_NODE_ELEMENT:
+                on_element(node);
+                break;
+
+            case GUMBO_NODE_TEXT:
+            case GUMBO_NODE_CDATA:
+                on_text(node->v.text.text);
+                break;
+
+            case GUMBO_NODE_WHITESPACE:
+                if (m_pre != 0) {
+                    write(node->v.text.text, false);
+                }
+                else {
+                    m_space = true;
+                }
+                break;
+
+            default:
+                // 注释、模板
+                break;
+        }
+    }
+
+    void walk_children(GumboNode* node)
+    {
+        for (size_t i = 0; i < CQueryUtil::childNum(node); ++i) {
+            walk(CQueryUtil::nthChild(node, i));
+        }
+    }
+
+private:
+    void on_element(GumboNode* node);
+    void on_text(const char* text);
+    void on_list(GumboNode* node, int64_t start);
+    void on_list_item(GumboNode* node);
+    void on_link(GumboNode* node);
+    void on_table(GumboNode* node);
+    void collect_rows(GumboNode* node, std::vector<std::vector<std::string>>& rows);
+    void wrap(GumboNode* node, std::string_view mark);
+
+    bool is_empty() const
+    {
+        return m_out.size() == m_start;
+    }
+
+    // 要求之后的输出，与之前的输出隔开n个换行(1:另起一行；2:空一行)
+    void newline(int n)
+    {
+        // 列表项还未输出内容时，不再隔开
+        if (m_marker.empty()) {
+            m_pending = std::max(m_pending, n);
+        }
+    }
+
+    void flush_newlines();
+    void begin_line();
+    void write(std::string_view s, bool use_space = true);
+    void write_word(std::string_view word);
+
+private:
+    std::string&         m_out;
+    size_t               m_start;
+    std::string          m_prefix;              // 各行的前缀
+    std::string          m_marker;              // 列表项首行，替换前缀中的缩进
+    size_t               m_marker_end = 0;      // m_marker在前缀中的结尾位置
+    int                  m_pending    = 0;      // 待输出的换行数
+    int                  m_newlines   = 0;      // 已输出的、结尾处连续的换行数
+    bool                 m_line_start = true;   // 当前行还未输出前缀
+    bool                 m_space      = false;  // 待输出的空白
+    int                  m_pre        = 0;
+    int                  m_code       = 0;
+    std::vector<int64_t> m_lists;               // 各层列表下一项的序号；-1表示无序列表
+};
+
+void converter_t::flush_newlines()
+{
+    if (m_pending == 0) {
+        return;
+    }
+    if (!is_empty()) {
+        for (int i = m_newlines; i < m_pending; ++i) {
+            if (i > 0) {
+                // 空行，只保留前缀中的非空白部分，如"> " -> ">"
+                auto end = m_prefix.find_last_not_of(' ');
+                m_out.append(m_prefix, 0, end == std::string::npos ? 0 : end + 1);
+            }
+            m_out += '\n';
+        }
+        m_newlines   = std::max(m_newlines, m_pending);
+        m_line_start = true;
+    }
+    m_pending = 0;
+    m_space   = false;
+}
+
+void converter_t::begin_line()
+{
+    flush_newlines();
+    if (!m_line_start) {
+        return;
+    }
+    if (!m_marker.empty()) {
+        m_out.append(m_prefix, 0, m_marker_end - m_marker.size());
+        m_out += m_marker;
+        m_out.append(m_prefix, m_marker_end, std::string::npos);
+        m_marker.clear();
+    }
+    else {
+        m_out += m_prefix;
+    }
+    m_line_start = false;
+    m_space      = false;
+    m_newlines   = 0;
+}
+
+// s中的'\n'，另起一行(补上前缀)
+void converter_t::write(std::string_view s, bool use_space)
+{
+    while (!s.empty()) {
+        auto pos = s.find('\n');
+        std::string_view line = s.substr(0, pos);
+        if (!line.empty()) {
+            bool space = use_space && m_space && !m_line_start && m_pending == 0;
+            begin_line();
+            if (space) {
+                m_out += ' ';
+            }
+            if (use_space) {
+                m_space = false;
+            }
+            m_out.append(line.data(), line.size());
+            m_newlines = 0;
+        }
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        flush_newlines();
+        if (!m_marker.empty()) {
+            begin_line();
+        }
+        else if (m_line_start && !is_empty()) {
+            // 空行
+            auto end = m_prefix.find_last_not_of(' ');
+            m_out.append(m_prefix, 0, end == std::string::npos ? 0 : end + 1);
+        }
+        m_out += '\n';
+        m_newlines++;
+        m_line_start = true;
+        m_space      = false;
+        s = s.substr(pos + 1);
+    }
+}
+
+void converter_t::write_word(std::string_view word)
+{
+    if (m_code != 0) {
+        write(word);
+        return;
+    }
+    std::string escaped;
+    escaped.reserve(word.size() + 4);
+    // 行首的 #、>、-、+、"1." 会被当作标题、引用、列表
+    if (m_line_start || m_pending != 0) {
+        if (word[0] == '#' || word[0] == '>' || word == "-" || word == "+") {
+            escaped += '\\';
+        }
+        else if (std::isdigit(static_cast<unsigned char>(word[0])) != 0) {
+            auto end = std::find_if(word.begin(), word.end(), [](char c) {
+                return std::isdigit(static_cast<unsigned char>(c)) == 0;
+            });
+            if (end != word.end() && *end == '.') {
+                auto digits = size_t(end - word.begin());
+                escaped.append(word.data(), digits);
+                escaped += '\\';
+                word = word.substr(digits);
+            }
+        }
+    }
+    append_escaped(escaped, word, "\\`*_[]");
+    write(escaped);
+}
+
+void converter_t::on_text(const char* text)
+{
+    if (m_pre != 0) {
+        write(text, false);
+        return;
+    }
+    // 连续空白，折叠为一个空格
+    const char* p = text;
+    while (*p != '\0') {
+        if (is_space(*p)) {
+            m_space = true;
+            ++p;
+            continue;
+        }
+        const char* beg = p;
+        while (*p != '\0' && !is_space(*p)) {
+            ++p;
+        }
+        write_word(std::string_view(beg, p - beg));
+    }
+}
+
+void converter_t::wrap(GumboNode* node, std::string_view mark)
+{
+    write(mark);
+    m_space = false;
+    size_t pos = m_out.size();
+    walk_children(node);
+    if (m_out.size() == pos) {
+        m_out.resize(pos - mark.size());
+    }
+    else {
+        write(mark, false);
+    }
+}
+
+void converter_t::on_element(GumboNode* node)
+{
+    switch (GumboTag tag = node->v.element.tag) {
+        case GUMBO_TAG_HEAD:
+        case GUMBO_TAG_TITLE:
+        case GUMBO_TAG_SCRIPT:
+        case GUMBO_TAG_STYLE:
+        case GUMBO_TAG_NOSCRIPT:
+        case GUMBO_TAG_TEMPLATE:
+        case GUMBO_TAG_IFRAME:
+        case GUMBO_TAG_OBJECT:
+        case GUMBO_TAG_SVG:
+        case GUMBO_TAG_MATH:
+        case GUMBO_TAG_SELECT:
+        case GUMBO_TAG_TEXTAREA:
+            break;
+
+        case GUMBO_TAG_H1:
+        case GUMBO_TAG_H2:
+        case GUMBO_TAG_H3:
+        case GUMBO_TAG_H4:
+        case GUMBO_TAG_H5:
+        case GUMBO_TAG_H6: {
+            static const char * const marks[] = {"#", "##", "###", "####", "#####", "######"};
+            newline(2);
+            write(marks[tag - GUMBO_TAG_H1]);
+            m_space = true;
+            walk_children(node);
+            newline(2);
+            break;
+        }
+
+        case GUMBO_TAG_P:
+        case GUMBO_TAG_DIV:
+        case GUMBO_TAG_ARTICLE:
+        case GUMBO_TAG_SECTION:
+        case GUMBO_TAG_HEADER:
+        case GUMBO_TAG_FOOTER:
+        case GUMBO_TAG_MAIN:
+        case GUMBO_TAG_NAV:
+        case GUMBO_TAG_ASIDE:
+        case GUMBO_TAG_FIGURE:
+        case GUMBO_TAG_ADDRESS:
+        case GUMBO_TAG_DETAILS:
+        case GUMBO_TAG_FORM:
+        case GUMBO_TAG_FIELDSET:
+        case GUMBO_TAG_CENTER:
+        case GUMBO_TAG_DL:
+            newline(2);
+            walk_children(node);
+            newline(2);
+            break;
+
+        case GUMBO_TAG_DT:
+        case GUMBO_TAG_DD:
+        case GUMBO_TAG_FIGCAPTION:
+        case GUMBO_TAG_SUMMARY:
+        case GUMBO_TAG_CAPTION:
+            newline(1);
+            walk_children(node);
+            newline(1);
+            break;
+
+        case GUMBO_TAG_BR:
+            if (!is_empty()) {
+                write("  \n", false);
+            }
+            break;
+
+        case GUMBO_TAG_HR:
+            newline(2);
+            write("* * *");
+            newline(2);
+            break;
+
+        case GUMBO_TAG_B:
+        case GUMBO_TAG_STRONG:
+            wrap(node, "**");
+            break;
+
+        case GUMBO_TAG_I:
+        case GUMBO_TAG_EM:
+            wrap(node, "_");
+            break;
+
+        case GUMBO_TAG_S:
+        case GUMBO_TAG_STRIKE:
+        case GUMBO_TAG_DEL:
+            wrap(node, "~~");
+            break;
+
+        case GUMBO_TAG_CODE:
+        case GUMBO_TAG_KBD:
+        case GUMBO_TAG_SAMP:
+        case GUMBO_TAG_TT:
+            if (m_pre != 0) {
+                walk_children(node);
+            }
+            else {
+                m_code++;
+                wrap(node, "`");
+                m_code--;
+            }
+            break;
+
+        case GUMBO_TAG_PRE: {
+            std::string lang = code_lang_of(node);
+            if (lang.empty() && CQueryUtil::childNum(node) != 0) {
+                GumboNode* child = CQueryUtil::nthChild(node, 0);
+                if (child->type == GUMBO_NODE_ELEMENT && child->v.element.tag == GUMBO_TAG_CODE) {
+                    lang = code_lang_of(child);
+                }
+            }
+            newline(2);
+            write("```" + lang);
+            newline(1);
+            m_pre++;
+            walk_children(node);
+            m_pre--;
+            newline(1);
+            write("```");
+            newline(2);
+            break;
+        }
+
+        case GUMBO_TAG_BLOCKQUOTE: {
+            newline(2);
+            flush_newlines();
+            size_t old = m_prefix.size();
+            m_prefix += "> ";
+            walk_children(node);
+            m_prefix.resize(old);
+            newline(2);
+            break;
+        }
+
+        case GUMBO_TAG_UL:
+            on_list(node, -1);
+            break;
+
+        case GUMBO_TAG_OL: {
+            const char* start = attr_of(node, "start");
+            on_list(node, *start != '\0' ? std::max<int64_t>(std::atoll(start), 0) : 1);
+            break;
+        }
+
+        case GUMBO_TAG_LI:
+            on_list_item(node);
+            break;
+
+        case GUMBO_TAG_A:
+            on_link(node);
+            break;
+
+        case GUMBO_TAG_IMG: {
+            std::string_view src = attr_of(node, "src");
+            if (src.empty() || src.substr(0, 5) == "data:") {
+                // 延迟加载的图片
+                src = attr_of(node, "data-src");
+            }
+            if (src.empty()) {
+                break;
+            }
+            std::string img = "![";
+            append_escaped(img, attr_of(node, "alt"), "\\[]");
+            img += "](";
+            img.append(src.data(), src.size());
+            img += ")";
+            write(img);
+            break;
+        }
+
+        case GUMBO_TAG_TABLE:
+            on_table(node);
+            break;
+
+        default:
+            walk_children(node);
+            break;
+    }
+}
+
+void converter_t::on_list(GumboNode* node, int64_t start)
+{
+    newline(m_lists.empty() ? 2 : 1);
+    flush_newlines();
+    m_lists.push_back(start);
+    walk_children(node);
+    m_lists.pop_back();
+    newline(m_lists.empty() ? 2 : 1);
+}
+
+void converter_t::on_list_item(GumboNode* node)
+{
+    newline(1);
+    flush_newlines();
+
+    std::string marker = "* ";
+    if (!m_lists.empty() && m_lists.back() >= 0) {
+        marker = std::to_string(m_lists.back()++) + ". ";
+    }
+    size_t old = m_prefix.size();
+    m_prefix.append(marker.size(), ' ');
+    m_marker     = std::move(marker);
+    m_marker_end = m_prefix.size();
+
+    walk_children(node);
+    if (!m_marker.empty()) {
+        // 空的列表项，也输出标记
+        begin_line();
+    }
+    m_prefix.resize(old);
+    newline(1);
+}
+
+void converter_t::on_link(GumboNode* node)
+{
+    std::string_view href = attr_of(node, "href");
+    if (href.empty() || href[0] == '#' || href.substr(0, 11) == "javascript:") {
+        walk_children(node);
+        return;
+    }
+    write("[");
+    m_space = false;
+    size_t pos = m_out.size();
+    walk_children(node);
+    if (m_out.size() == pos) {
+        m_out.resize(pos - 1);
+        return;
+    }
+    if (std::string_view(m_out.data() + pos, m_out.size() - pos) == href) {
+        // [url](url) -> <url>
+        m_out.resize(pos - 1);
+        m_out += '<';
+        m_out.append(href.data(), href.size());
+        m_out += '>';
+        return;
+    }
+    std::string tail = "](";
+    tail.append(href.data(), href.size());
+    tail += ")";
+    write(tail, false);
+}
+
+void converter_t::collect_rows(GumboNode* node, std::vector<std::vector<std::string>>& rows)
+{
+    for (size_t i = 0; i < CQueryUtil::childNum(node); ++i) {
+        GumboNode* child = CQueryUtil::nthChild(node, i);
+        if (child->type != GUMBO_NODE_ELEMENT) {
+            continue;
+        }
+        switch (child->v.element.tag) {
+            case GUMBO_TAG_THEAD:
+            case GUMBO_TAG_TBODY:
+            case GUMBO_TAG_TFOOT:
+                collect_rows(child, rows);
+                break;
+
+            case GUMBO_TAG_TR: {
+                std::vector<std::string> row;
+                for (size_t j = 0; j < CQueryUtil::childNum(child); ++j) {
+                    GumboNode* cell = CQueryUtil::nthChild(child, j);
+                    if (cell->type != GUMBO_NODE_ELEMENT ||
+                        (cell->v.element.tag != GUMBO_TAG_TD && cell->v.element.tag != GUMBO_TAG_TH)) {
+                        continue;
+                    }
+                    // 单元格内容，单独转换，再压成一行
+                    std::string content;
+                    converter_t sub(content);
+                    sub.walk_children(cell);
+                    std::string text;
+                    text.reserve(content.size());
+                    for (char c : content) {
+                        if (c == '\n') {
+                            if (!text.empty() && text.back() != ' ') {
+                                text += ' ';
+                            }
+                        }
+                        else if (c == '|') {
+                            text += "\\|";
+                        }
+                        else {
+                            text += c;
+                        }
+                    }
+                    while (!text.empty() && text.back() == ' ') {
+                        text.pop_back();
+                    }
+                    row.push_back(std::move(text));
+                }
+                rows.push_back(std::move(row));
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+void converter_t::on_table(GumboNode* node)
+{
+    std::vector<std::vector<std::string>> rows;
+    collect_rows(node, rows);
+    size_t cols = 0;
+    for (const auto& row : rows) {
+        cols = std::max(cols, row.size());
+    }
+    if (cols == 0) {
+        return;
+    }
+
+    newline(2);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        std::string line;
+        for (size_t j = 0; j < cols; ++j) {
+            if (j != 0) {
+                line += " | ";
+            }
+            if (j < rows[i].size()) {
+                line += rows[i][j];
+            }
+        }
+        while (!line.empty() && line.back() == ' ') {
+            line.pop_back();
+        }
+        write(line, false);
+        newline(1);
+        if (i == 0) {
+            // 第一行作为表头
+            line.clear();
+            for (size_t j = 0; j < cols; ++j) {
+                line += j != 0 ? "|---" : "---";
+            }
+            write(line, false);
+            newline(1);
+        }
+    }
+    newline(2);
+}
+
+}  // namespace
+
+void convert(std::string& out, const gumboNode& g)
+{
+    CNode n = g.getCNode();
+    if (!n.valid()) {
+        return;
+    }
+    size_t start = out.size();
+    converter_t converter(out);
+    converter.walk(reinterpret_cast<GumboNode*>(n.get()));
+    if (out.size() != start) {
+        out += '\n';
+    }
+}
+
+} // namespace varlisp::detail::html2md
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "../gumboNode.hpp"
+
+namespace varlisp::detail::html2md {
+
+// 把以g为根的html树，转换为markdown文本，追加到out；
+// 直接遍历gumbo树，规则大致同html2text(BODY_WIDTH = 0)：
+//   h1-h6 -> #；p/div 等 -> 段落；ul/ol/li -> "* "、"1. "；a -> [text](href)；
+//   img -> ![alt](src)；b/strong -> **；i/em -> _；code -> `；pre -> ```；
+//   blockquote -> "> "；table -> 管道表格；hr -> * * *；
+//   script、style、head 等，忽略。
+void convert(std::string& out, const gumboNode& g);
+
+inline std::string convert(const gumboNode& g)
+{
+    std::string out;
+    convert(out, g);
+    return out;
+}
+
+} // namespace varlisp::detail::html2md
@@ -28,21 +28,22 @@ namespace http {
 
 void Environment2ss1x_header(ss1x::http::Headers& header,
                              varlisp::Environment& env,
-                             const varlisp::Environment& info)
+                             const varlisp::keyvalue_view_t& info)
 {
     const char * funcName = __PRETTY_FUNCTION__;
     std::array<Object, 1> objs;
     int id = 0;
-    for (auto it = info.begin(); it != info.end(); ++it, ++id) {
-        if (it->first == "http_version") {
+    info.for_each([&](sss::string_view key, const Object& value) {
+        if (key == sss::string_view("http_version")) {
             header.http_version =
-                requireTypedValue<varlisp::string_t>(env, it->second.first, objs[0], funcName, id, DEBUG_INFO)->to_string();
+                requireTypedValue<varlisp::string_t>(env, value, objs[0], funcName, id, DEBUG_INFO)->to_string();
         }
         else {
-            header[it->first] =
-                requireTypedValue<varlisp::string_t>(env, it->second.first, objs[0], funcName, id, DEBUG_INFO)->to_string();
+            header[key.to_string()] =
+                requireTypedValue<varlisp::string_t>(env, value, objs[0], funcName, id, DEBUG_INFO)->to_string();
         }
-    }
+        ++id;
+    });
 }
 
 std::tuple<std::string, std::string> urlSplitByPath(std::string url) {
@@ -10,11 +10,16 @@
 
 #include "../environment.hpp"
 
+namespace varlisp {
+struct keyvalue_view_t;
+} // namespace varlisp
+
 namespace varlisp::detail::http {
 
+// info 为context或dict(json-parse 的结果)
 void Environment2ss1x_header(ss1x::http::Headers& header,
                              varlisp::Environment& env,
-                             const varlisp::Environment& info);
+                             const varlisp::keyvalue_view_t& info);
 
 enum curl_method_t : uint8_t {
     curl_method_get,
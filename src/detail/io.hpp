@@ -1,12 +1,16 @@
 #pragma once
 
+#include <cerrno>
 #include <string>
 
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <sss/string_view.hpp>
 #include <sss/util/utf8.hpp>
 
+#include "file.hpp"
+
 namespace varlisp {
 namespace detail {
 
@@ -29,26 +33,42 @@ inline std::string readline(int64_t fd)
     return line;
 }
 
+// 普通文件：读取整个文件，与fd的当前偏移无关，也不改变偏移(pread)；
+// 管道等：从当前位置读到结尾
 inline std::string readall(int64_t fd)
 {
-    char buf[1024]={'\0'};
-    int64_t offset = ::lseek(fd, 0, SEEK_CUR);
-    int64_t fsize = ::lseek(fd, 0, SEEK_END);
+    std::string content;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        content.resize(st.st_size);
+        size_t got = 0;
+        while (got < content.size()) {
+            int64_t ec = ::pread(fd, &content[got], content.size() - got, got);
+            if (ec == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ec <= 0) {
+                break;
+            }
+            got += ec;
+        }
+        content.resize(got);
+        return content;
+    }
 
-    std::ostringstream oss;
-    ::lseek(fd, 0, SEEK_SET);
-    while (fsize != 0) {
-        auto to_read_size = std::min<int64_t>(fsize, sizeof(buf));
-        if (::read(fd, buf, to_read_size) == -1) {
+    char buf[64 * 1024];
+    while (true) {
+        // NOTE 先取出read-line等已读入、未消费的数据
+        int64_t ec = file::read_fd(fd, buf, sizeof(buf));
+        if (ec == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ec <= 0) {
             break;
         }
-        oss.write(buf, to_read_size);
-        fsize -= to_read_size;
+        content.append(buf, ec);
     }
-
-    ::lseek(fd, offset, SEEK_SET);
-
-    return oss.str();
+    return content;
 }
 
 inline int64_t readchar(int64_t fd)
@@ -9,6 +9,7 @@
 #include <sss/debug/value_msg.hpp>
 #include <sss/spliter.hpp>
 
+#include "../dict.hpp"
 #include "../environment.hpp"
 #include "../list.hpp"
 
@@ -85,12 +86,18 @@ varlisp::Object * json_accessor::access(varlisp::Environment& env) const
 
 const varlisp::Object * json_accessor::find_name(const varlisp::Object* obj, size_t id) const
 {
-    const varlisp::Environment * p_env = boost::get<varlisp::Environment>(obj);
-    if (!p_env) {
-        SSS_POSITION_THROW(std::runtime_error,
-                           obj->which(), " is not a Environment");
+    const varlisp::Object * p_ret = nullptr;
+    if (const auto * p_dict = boost::get<varlisp::Dict>(obj)) {
+        p_ret = p_dict->find(m_stems[id]);
+    }
+    else {
+        const varlisp::Environment * p_env = boost::get<varlisp::Environment>(obj);
+        if (!p_env) {
+            SSS_POSITION_THROW(std::runtime_error,
+                               obj->which(), " is not a Environment");
+        }
+        p_ret = p_env->find(m_stems[id]);
     }
-    const varlisp::Object * p_ret = p_env->find(m_stems[id]);
     if (!p_ret || id + 1 == m_stems.size()) {
         return p_ret;
     }
@@ -198,15 +205,21 @@ Object& json_accessor::query_location(varlisp::Environment& env) const
 
 Object& json_accessor::query_field(Object& obj, size_t id) const
 {
-    varlisp::Environment * p_env = boost::get<varlisp::Environment>(&obj);
-    if (!p_env) {
-        obj = varlisp::Environment();
-        p_env = boost::get<varlisp::Environment>(&obj);
-    }
-    varlisp::Object * p_ret = p_env->find(m_stems[id]);
-    if (!p_ret) {
-        p_env->operator[](m_stems[id]) = Nill{};
+    varlisp::Object * p_ret = nullptr;
+    if (auto * p_dict = boost::get<varlisp::Dict>(&obj)) {
+        p_ret = &p_dict->operator[](m_stems[id]);
+    }
+    else {
+        varlisp::Environment * p_env = boost::get<varlisp::Environment>(&obj);
+        if (!p_env) {
+            obj = varlisp::Environment();
+            p_env = boost::get<varlisp::Environment>(&obj);
+        }
         p_ret = p_env->find(m_stems[id]);
+        if (!p_ret) {
+            p_env->operator[](m_stems[id]) = Nill{};
+            p_ret = p_env->find(m_stems[id]);
+        }
     }
     if (id + 1 == m_stems.size()) {
         return *p_ret;
@@ -297,9 +310,10 @@ json_accessor::location json_accessor::locate(varlisp::Environment& env)
     json_accessor& jc{*this};
     auto pl = detail::locate_impl(env, jc.prefix());
     varlisp::List* parentList = nullptr;
+    varlisp::Dict* parentDict = nullptr;
 
     if (!jc.has_sub()) {
-        return {const_cast<varlisp::Object*>(pl.first), const_cast<varlisp::Environment*>(pl.second), nullptr};
+        return {const_cast<varlisp::Object*>(pl.first), const_cast<varlisp::Environment*>(pl.second), nullptr, nullptr};
     }
     COLOG_DEBUG(pl);
     for (size_t i = 0; i < jc.m_stems.size() && pl.first; ++i) {
@@ -311,6 +325,7 @@ json_accessor::location json_accessor::locate(varlisp::Environment& env)
                                    "need a List here , but ", pl.first->which());
             }
             parentList = const_cast<varlisp::List*>(p_list);
+            parentDict = nullptr;
             if (p_list->is_quoted()) {
                 p_list = p_list->unquoteType<varlisp::List>();
                 if (!p_list) {
@@ -332,6 +347,11 @@ json_accessor::location json_accessor::locate(varlisp::Environment& env)
             // pl.first = p_list->objAt(sss::string_cast<int>(jc.m_stems[i]));
             COLOG_DEBUG(*p_list);
         }
+        else if (const auto * p_dict = boost::get<varlisp::Dict>(pl.first)) {
+            parentList = nullptr;
+            parentDict = const_cast<varlisp::Dict*>(p_dict);
+            pl.first = p_dict->find(jc.m_stems[i]);
+        }
         else {
             // auto * p_env = pl.second
             pl.second = boost::get<varlisp::Environment>(pl.first);
@@ -340,15 +360,19 @@ json_accessor::location json_accessor::locate(varlisp::Environment& env)
                                    "need an Environment here , but ", pl.first->which());
             }
             parentList = nullptr;
+            parentDict = nullptr;
             pl.first = pl.second->find(jc.m_stems[i]);
         }
         COLOG_DEBUG(pl);
     }
 
     if (parentList != nullptr) {
-        return {const_cast<varlisp::Object*>(pl.first), nullptr, parentList};
+        return {const_cast<varlisp::Object*>(pl.first), nullptr, parentList, nullptr};
+    }
+    if (parentDict != nullptr) {
+        return {const_cast<varlisp::Object*>(pl.first), nullptr, nullptr, parentDict};
     }
-    return {const_cast<varlisp::Object*>(pl.first), const_cast<varlisp::Environment*>(pl.second), nullptr};
+    return {const_cast<varlisp::Object*>(pl.first), const_cast<varlisp::Environment*>(pl.second), nullptr, nullptr};
 }
 
 } // namespace varlisp::detail
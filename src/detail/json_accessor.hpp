@@ -9,6 +9,7 @@
 namespace varlisp {
 struct Environment;
 struct List;
+struct Dict;
 namespace detail {
 
 inline bool is_index(const std::string& stem)
@@ -29,6 +30,7 @@ class json_accessor
         varlisp::Object*      obj; // located object by accessor
         varlisp::Environment* env; // none-nullptr when reference by symbol
         varlisp::List*        list; // none-nullptr when reference by index
+        varlisp::Dict*        dict; // none-nullptr when reference by field of dict
     };
     const std::string&          m_jstyle_name;
     std::vector<std::string>    m_stems;
@@ -0,0 +1,64 @@
+#include "mmap_file.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/path.hpp>
+#include <sss/util/PostionThrow.hpp>
+
+#include "io.hpp"
+
+namespace varlisp::detail {
+
+mmap_file_t::mmap_file_t(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        SSS_POSITION_THROW(std::runtime_error,
+                           "open `", path, "` failed: ", std::strerror(errno));
+    }
+    this->map_fd(fd);
+    ::close(fd);
+
+    if (m_addr == nullptr) {
+        sss::path::file2string(path, m_fallback);
+    }
+}
+
+mmap_file_t::mmap_file_t(int fd)
+{
+    if (!this->map_fd(fd)) {
+        m_fallback = readall(fd);
+    }
+}
+
+bool mmap_file_t::map_fd(int fd)
+{
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // 顺序读取为主
+            ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            m_addr = static_cast<const char*>(addr);
+            m_size = st.st_size;
+        }
+    }
+    return m_addr != nullptr;
+}
+
+mmap_file_t::~mmap_file_t()
+{
+    if (m_addr != nullptr) {
+        ::munmap(const_cast<char*>(m_addr), m_size);
+    }
+}
+
+} // namespace varlisp::detail
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+namespace varlisp::detail {
+
+// 只读方式，将整个文件mmap到内存；view()即文件内容，不做拷贝。
+// 对于无法mmap的文件(空文件、管道、/proc下的文件等)，退化为读入内部的
+// std::string。
+//
+// NOTE view()的有效期，与本对象相同。
+class mmap_file_t
+{
+public:
+    explicit mmap_file_t(const std::string& path);
+    // 映射fd所指的整个文件(与fd的当前偏移无关)；不负责关闭fd
+    explicit mmap_file_t(int fd);
+    ~mmap_file_t();
+
+    mmap_file_t(const mmap_file_t&) = delete;
+    mmap_file_t& operator=(const mmap_file_t&) = delete;
+
+public:
+    sss::string_view view() const
+    {
+        return m_addr != nullptr ? sss::string_view(m_addr, m_size)
+                                 : sss::string_view(m_fallback);
+    }
+
+    size_t size() const
+    {
+        return m_addr != nullptr ? m_size : m_fallback.size();
+    }
+
+    bool is_mapped() const
+    {
+        return m_addr != nullptr;
+    }
+
+private:
+    // 普通文件，且非空时映射；返回是否成功
+    bool map_fd(int fd);
+
+private:
+    const char *    m_addr = nullptr;
+    size_t          m_size = 0;
+    std::string     m_fallback;
+};
+
+} // namespace varlisp::detail
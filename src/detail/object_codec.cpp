@@ -0,0 +1,443 @@
+#include "object_codec.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/util/PostionThrow.hpp>
+
+#include "../Define.hpp"
+#include "../builtin.hpp"
+#include "../condition.hpp"
+#include "../dict.hpp"
+#include "../environment.hpp"
+#include "../ifexpr.hpp"
+#include "../lambda.hpp"
+#include "../list.hpp"
+#include "../logic_and.hpp"
+#include "../logic_or.hpp"
+
+#include "buitin_info_t.hpp"
+#include "regex_cache.hpp"
+
+namespace varlisp::detail::codec {
+
+namespace {
+
+// NOTE 仅追加，不要调整已有值；否则旧的缓存文件会被错误解读
+enum tag_t : uint8_t {
+    tag_empty       = 0,
+    tag_nill        = 1,
+    tag_false       = 2,
+    tag_true        = 3,
+    tag_int64       = 4,
+    tag_double      = 5,
+    tag_string      = 6,
+    tag_regex       = 7,
+    tag_symbol      = 8,
+    tag_keyword     = 9,
+    tag_list        = 10,
+    tag_if          = 11,
+    tag_cond        = 12,
+    tag_and         = 13,
+    tag_or          = 14,
+    tag_define      = 15,
+    tag_lambda      = 16,
+    tag_environment = 17,
+    tag_builtin     = 18,
+    tag_dict        = 19,
+    tag_regex_flags = 20,   // pattern + regex_cache::flag_t
+};
+
+// NOTE 内建函数的编号，取决于注册(链接)顺序；故按名字编码
+int builtin_type_by_name(const std::string& name)
+{
+    int type = varlisp::detail::find_builtin(name);
+    if (type < 0) {
+        SSS_POSITION_THROW(std::runtime_error, "codec: unknown builtin `",
+                           name, "`");
+    }
+    return type;
+}
+
+struct encode_visitor : public boost::static_visitor<void>
+{
+    std::string& m_out;
+    explicit encode_visitor(std::string& out) : m_out(out) {}
+
+    template <typename T>
+    void operator()(const T& v) const
+    {
+        SSS_POSITION_THROW(std::runtime_error, "cannot encode object: ", v);
+    }
+
+    void operator()(const Empty&) const { put_u8(m_out, tag_empty); }
+    void operator()(const Nill&) const { put_u8(m_out, tag_nill); }
+    void operator()(bool v) const { put_u8(m_out, v ? tag_true : tag_false); }
+    void operator()(int64_t v) const
+    {
+        put_u8(m_out, tag_int64);
+        put_u64(m_out, static_cast<uint64_t>(v));
+    }
+    void operator()(double v) const
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        put_u8(m_out, tag_double);
+        put_u64(m_out, bits);
+    }
+    void operator()(const string_t& v) const
+    {
+        put_u8(m_out, tag_string);
+        put_string(m_out, v.to_string_view());
+    }
+    void operator()(const varlisp::regex_t& v) const
+    {
+        if (!v) {
+            SSS_POSITION_THROW(std::runtime_error, "null regex-obj");
+        }
+        // NOTE i/s/l/L 等编译选项，须与pattern一起保存
+        put_u8(m_out, tag_regex_flags);
+        put_string(m_out, v->pattern());
+        put_u32(m_out, regex_cache::flags_of(v->options()));
+    }
+    void operator()(const varlisp::symbol& v) const
+    {
+        put_u8(m_out, tag_symbol);
+        put_string(m_out, v.name());
+    }
+    void operator()(const varlisp::keywords_t& v) const
+    {
+        put_u8(m_out, tag_keyword);
+        put_u64(m_out, static_cast<uint64_t>(v.type()));
+    }
+    void operator()(const varlisp::List& v) const
+    {
+        put_u8(m_out, tag_list);
+        put_u32(m_out, v.length());
+        for (const auto& item : v) {
+            boost::apply_visitor(*this, item);
+        }
+    }
+    void operator()(const varlisp::IfExpr& v) const
+    {
+        put_u8(m_out, tag_if);
+        boost::apply_visitor(*this, v.condition);
+        boost::apply_visitor(*this, v.consequent);
+        boost::apply_visitor(*this, v.alternative);
+    }
+    void operator()(const varlisp::Cond& v) const
+    {
+        put_u8(m_out, tag_cond);
+        put_u32(m_out, v.conditions.size());
+        for (const auto& item : v.conditions) {
+            boost::apply_visitor(*this, item.first);
+            boost::apply_visitor(*this, item.second);
+        }
+    }
+    void operator()(const varlisp::LogicAnd& v) const
+    {
+        put_u8(m_out, tag_and);
+        this->put_objects(v.conditions);
+    }
+    void operator()(const varlisp::LogicOr& v) const
+    {
+        put_u8(m_out, tag_or);
+        this->put_objects(v.conditions);
+    }
+    void operator()(const varlisp::Define& v) const
+    {
+        put_u8(m_out, tag_define);
+        put_string(m_out, v.name.name());
+        boost::apply_visitor(*this, v.value);
+        boost::apply_visitor(*this, v.force_rewrite);
+    }
+    void operator()(const varlisp::Lambda& v) const
+    {
+        put_u8(m_out, tag_lambda);
+        put_u32(m_out, v.args().size());
+        for (const auto& arg : v.args()) {
+            put_string(m_out, arg);
+        }
+        put_string(m_out, v.help_msg().to_string_view());
+        this->put_objects(v.body());
+    }
+    void operator()(const varlisp::Environment& v) const
+    {
+        put_u8(m_out, tag_environment);
+        put_u32(m_out, v.size());
+        for (const auto& item : v) {
+            put_string(m_out, item.first);
+            put_u8(m_out, item.second.second.is_const ? 1 : 0);
+            boost::apply_visitor(*this, item.second.first);
+        }
+    }
+
+    void operator()(const varlisp::Builtin& v) const
+    {
+        put_u8(m_out, tag_builtin);
+        put_string(m_out, varlisp::detail::get_builtin_infos()[v.type()].name);
+    }
+    void operator()(const varlisp::Dict& v) const
+    {
+        put_u8(m_out, tag_dict);
+        put_u32(m_out, v.size());
+        for (const auto& item : v) {
+            put_string(m_out, item.first);
+            boost::apply_visitor(*this, item.second);
+        }
+    }
+
+    void put_objects(const std::vector<Object>& objs) const
+    {
+        put_u32(m_out, objs.size());
+        for (const auto& item : objs) {
+            boost::apply_visitor(*this, item);
+        }
+    }
+};
+
+}  // namespace
+
+void put_u8(std::string& out, uint8_t v)
+{
+    out += static_cast<char>(v);
+}
+
+void put_u32(std::string& out, uint32_t v)
+{
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void put_u64(std::string& out, uint64_t v)
+{
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void put_string(std::string& out, sss::string_view s)
+{
+    put_u32(out, s.size());
+    out.append(s.data(), s.size());
+}
+
+void encode(std::string& out, const Object& obj)
+{
+    boost::apply_visitor(encode_visitor(out), obj);
+}
+
+const char * reader_t::take(size_t n)
+{
+    if (m_in.size() < n) {
+        SSS_POSITION_THROW(std::runtime_error, "codec: unexpected end of data");
+    }
+    const char * p = m_in.data();
+    m_in = sss::string_view(p + n, m_in.size() - n);
+    return p;
+}
+
+uint8_t reader_t::get_u8()
+{
+    return static_cast<uint8_t>(*this->take(1));
+}
+
+uint32_t reader_t::get_u32()
+{
+    uint32_t v = 0;
+    std::memcpy(&v, this->take(sizeof(v)), sizeof(v));
+    return v;
+}
+
+uint64_t reader_t::get_u64()
+{
+    uint64_t v = 0;
+    std::memcpy(&v, this->take(sizeof(v)), sizeof(v));
+    return v;
+}
+
+sss::string_view reader_t::get_string()
+{
+    uint32_t len = this->get_u32();
+    return sss::string_view(this->take(len), len);
+}
+
+Object reader_t::decode()
+{
+    const uint8_t tag = this->get_u8();
+    switch (tag) {
+        case tag_empty:
+            return Object{};
+
+        case tag_nill:
+            return Nill{};
+
+        case tag_false:
+            return false;
+
+        case tag_true:
+            return true;
+
+        case tag_int64:
+            return static_cast<int64_t>(this->get_u64());
+
+        case tag_double:
+            {
+                uint64_t bits = this->get_u64();
+                double v = 0;
+                std::memcpy(&v, &bits, sizeof(v));
+                return v;
+            }
+
+        case tag_string:
+            return string_t(this->get_string().to_string());
+
+        case tag_regex:
+            return std::make_shared<RE2>(this->get_string().to_string());
+
+        case tag_regex_flags:
+            {
+                auto pattern = this->get_string();
+                uint32_t flags = this->get_u32();
+                return std::make_shared<RE2>(
+                    re2::StringPiece(pattern.data(), pattern.size()),
+                    regex_cache::make_options(flags));
+            }
+
+        case tag_symbol:
+            return varlisp::symbol(this->get_string().to_string());
+
+        case tag_keyword:
+            return varlisp::keywords_t(
+                static_cast<varlisp::keywords_t::kw_type_t>(this->get_u64()));
+
+        case tag_list:
+            {
+                varlisp::List ret;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    ret.append(this->decode());
+                }
+                return ret;
+            }
+
+        case tag_if:
+            {
+                Object condition = this->decode();
+                Object consequent = this->decode();
+                Object alternative = this->decode();
+                return varlisp::IfExpr(condition, consequent, alternative);
+            }
+
+        case tag_cond:
+            {
+                std::vector<std::pair<Object, Object>> conditions;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    Object predict = this->decode();
+                    Object expr = this->decode();
+                    conditions.emplace_back(std::move(predict), std::move(expr));
+                }
+                return varlisp::Cond(std::move(conditions));
+            }
+
+        case tag_and:
+        case tag_or:
+            {
+                std::vector<Object> conditions;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    conditions.push_back(this->decode());
+                }
+                if (tag == tag_and) {
+                    return varlisp::LogicAnd(std::move(conditions));
+                }
+                return varlisp::LogicOr(std::move(conditions));
+            }
+
+        case tag_define:
+            {
+                varlisp::symbol name(this->get_string().to_string());
+                Object value = this->decode();
+                Object force = this->decode();
+                if (force.which() != 0) {
+                    return varlisp::Define(std::move(name), std::move(value),
+                                           std::move(force));
+                }
+                return varlisp::Define(std::move(name), std::move(value));
+            }
+
+        case tag_lambda:
+            {
+                std::vector<std::string> args;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    args.push_back(this->get_string().to_string());
+                }
+                varlisp::string_t help_msg;
+                auto msg = this->get_string();
+                if (!msg.empty()) {
+                    help_msg = varlisp::string_t(msg.to_string());
+                }
+                std::vector<Object> body;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    body.push_back(this->decode());
+                }
+                return varlisp::Lambda(std::move(args), std::move(help_msg),
+                                       std::move(body));
+            }
+
+        case tag_environment:
+            {
+                varlisp::Environment env;
+                for (uint32_t i = 0, cnt = this->get_u32(); i < cnt; ++i) {
+                    std::string name = this->get_string().to_string();
+                    bool is_const = this->get_u8() != 0;
+                    env.insert(std::move(name), this->decode(), is_const);
+                }
+                return std::move(env);
+            }
+
+        case tag_builtin:
+            return varlisp::Builtin(
+                builtin_type_by_name(this->get_string().to_string()));
+
+        case tag_dict:
+            {
+                varlisp::Dict dict;
+                uint32_t cnt = this->get_u32();
+                dict.reserve(cnt);
+                for (uint32_t i = 0; i < cnt; ++i) {
+                    varlisp::string_t key(this->get_string().to_string());
+                    dict.insert(std::move(key), this->decode());
+                }
+                return std::move(dict);
+            }
+
+        default:
+            SSS_POSITION_THROW(std::runtime_error, "codec: unknown tag ",
+                               int(tag));
+    }
+}
+
+uint64_t build_fingerprint()
+{
+    static const uint64_t fingerprint = [] {
+        std::string seed = "varlisp-codec:" + std::to_string(format_version);
+#ifdef __VERSION__
+        seed += ":" __VERSION__;
+#endif
+        seed += ":" + std::to_string(sizeof(void*));
+        for (const auto& info : varlisp::detail::get_builtin_infos()) {
+            seed += ':';
+            seed += info.name;
+        }
+        return hash(seed);
+    }();
+    return fingerprint;
+}
+
+uint64_t hash(sss::string_view s)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < s.size(); ++i) {
+        h ^= static_cast<unsigned char>(s.data()[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+} // namespace varlisp::detail::codec
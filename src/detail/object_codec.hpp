@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "../object.hpp"
+
+namespace varlisp::detail::codec {
+
+// Object的二进制编码；字节序为本机序，仅供本机缓存用。
+//
+// 支持Parser可能产生的类型：字面值、regex(pattern及flags)、symbol、keyword、
+// List、if/cond/and/or、define、lambda、{}；以及builtin(按名字)、dict；
+// 其余类型(gumbo节点、lazy-seq等)，encode时抛出std::runtime_error。
+
+// 编码格式的版本；tag、字段的编码方式有变化时递增
+const uint32_t format_version = 2;
+
+// 字节序标记；按本机序写入，读出的值不同，即是别的字节序的机器写的
+const uint32_t endian_marker = 0x01020304U;
+
+// 构建指纹：format_version、编译器、指针宽度，以及内建函数表(按名字编码)；
+// 任何一项不同，旧的缓存、镜像都不可信
+uint64_t build_fingerprint();
+
+void put_u8(std::string& out, uint8_t v);
+void put_u32(std::string& out, uint32_t v);
+void put_u64(std::string& out, uint64_t v);
+void put_string(std::string& out, sss::string_view s);
+
+void encode(std::string& out, const Object& obj);
+
+// 从头部读取，并前移in；数据不完整时，抛出std::runtime_error
+class reader_t
+{
+public:
+    explicit reader_t(sss::string_view in) : m_in(in) {}
+
+    uint8_t          get_u8();
+    uint32_t         get_u32();
+    uint64_t         get_u64();
+    sss::string_view get_string();
+
+    Object           decode();
+
+    bool empty() const
+    {
+        return m_in.empty();
+    }
+
+private:
+    const char * take(size_t n);
+
+    sss::string_view m_in;
+};
+
+// FNV-1a 64
+uint64_t hash(sss::string_view s);
+
+} // namespace varlisp::detail::codec
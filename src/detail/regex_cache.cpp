@@ -0,0 +1,176 @@
+#include "regex_cache.hpp"
+
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace varlisp::detail::regex_cache {
+
+namespace {
+
+const size_t default_capacity = 256;
+
+struct cache_t
+{
+    using item_t = std::pair<std::string, regex_t>;
+
+    std::mutex                                                  m_mutex;
+    size_t                                                      m_capacity = default_capacity;
+    std::list<item_t>                                           m_items;  // 头部为最近使用
+    std::unordered_map<std::string, std::list<item_t>::iterator> m_index;
+    stat_t                                                      m_stat;
+
+    // 调用时须持有m_mutex
+    void shrink_to(size_t capacity)
+    {
+        while (m_items.size() > capacity) {
+            m_index.erase(m_items.back().first);
+            m_items.pop_back();
+            m_stat.evictions++;
+        }
+    }
+};
+
+cache_t& get_cache()
+{
+    // NOTE 不析构；避免退出时，与其他静态对象的析构顺序问题
+    static auto* p_cache = new cache_t;
+    return *p_cache;
+}
+
+// flags放在pattern之前，作为key的第一个字节
+std::string make_key(sss::string_view pattern, uint32_t flags)
+{
+    std::string key;
+    key.reserve(pattern.size() + 1);
+    key.push_back(char(flags));
+    key.append(pattern.data(), pattern.size());
+    return key;
+}
+
+regex_t compile(sss::string_view pattern, uint32_t flags)
+{
+    return std::make_shared<RE2>(re2::StringPiece(pattern.data(), pattern.size()),
+                                 make_options(flags));
+}
+
+}  // namespace
+
+RE2::Options make_options(uint32_t flags)
+{
+    RE2::Options opt;
+    opt.set_log_errors(false);
+    opt.set_case_sensitive((flags & flag_case_insensitive) == 0);
+    opt.set_dot_nl((flags & flag_dot_nl) != 0);
+    opt.set_literal((flags & flag_literal) != 0);
+    opt.set_longest_match((flags & flag_longest_match) != 0);
+    return opt;
+}
+
+uint32_t flags_of(const RE2::Options& opt)
+{
+    uint32_t flags = flag_none;
+    if (!opt.case_sensitive()) {
+        flags |= flag_case_insensitive;
+    }
+    if (opt.dot_nl()) {
+        flags |= flag_dot_nl;
+    }
+    if (opt.literal()) {
+        flags |= flag_literal;
+    }
+    if (opt.longest_match()) {
+        flags |= flag_longest_match;
+    }
+    return flags;
+}
+
+bool parse_flags(sss::string_view s, uint32_t& flags)
+{
+    flags = flag_none;
+    for (char c : s) {
+        switch (c) {
+            case 'i': flags |= flag_case_insensitive; break;
+            case 's': flags |= flag_dot_nl;           break;
+            case 'l': flags |= flag_literal;          break;
+            case 'L': flags |= flag_longest_match;    break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+regex_t get(sss::string_view pattern, uint32_t flags)
+{
+    auto& cache = get_cache();
+    std::string key = make_key(pattern, flags);
+    {
+        std::lock_guard<std::mutex> lock(cache.m_mutex);
+        auto it = cache.m_index.find(key);
+        if (it != cache.m_index.end()) {
+            cache.m_items.splice(cache.m_items.begin(), cache.m_items, it->second);
+            cache.m_stat.hits++;
+            return it->second->second;
+        }
+        cache.m_stat.misses++;
+    }
+
+    // NOTE 编译不持锁；并发编译同一pattern时，后到者直接使用已缓存的对象
+    regex_t reg = compile(pattern, flags);
+    if (!reg->ok()) {
+        {
+            std::lock_guard<std::mutex> lock(cache.m_mutex);
+            cache.m_stat.errors++;
+        }
+        throw std::runtime_error("regex `" + std::string(pattern.data(), pattern.size()) +
+                                 "`: " + reg->error());
+    }
+
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    if (cache.m_capacity == 0) {
+        return reg;
+    }
+    auto it = cache.m_index.find(key);
+    if (it != cache.m_index.end()) {
+        return it->second->second;
+    }
+    cache.m_items.emplace_front(key, reg);
+    cache.m_index.emplace(std::move(key), cache.m_items.begin());
+    cache.shrink_to(cache.m_capacity);
+    return reg;
+}
+
+stat_t get_stat()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_stat;
+}
+
+size_t size()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_items.size();
+}
+
+size_t get_capacity()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_capacity;
+}
+
+void set_capacity(size_t capacity)
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    cache.m_capacity = capacity;
+    cache.shrink_to(capacity);
+}
+
+} // namespace varlisp::detail::regex_cache
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <sss/string_view.hpp>
+
+#include "../regex_t.hpp"
+
+namespace varlisp::detail::regex_cache {
+
+// 编译选项；对应 (regex "pattern" "flags") 中的flags字符
+enum flag_t : uint32_t {
+    flag_none             = 0,
+    flag_case_insensitive = 1U << 0,  // i
+    flag_dot_nl           = 1U << 1,  // s  '.'匹配'\n'
+    flag_literal          = 1U << 2,  // l  pattern按字面值匹配
+    flag_longest_match    = 1U << 3,  // L  最左最长匹配
+};
+
+// 解析flags字符串；遇到未知字符，返回false
+bool parse_flags(sss::string_view s, uint32_t& flags);
+
+// flags对应的RE2编译选项；regex-set等也使用
+RE2::Options make_options(uint32_t flags);
+
+// RE2编译选项对应的flags；make_options()的逆；其余选项忽略
+uint32_t flags_of(const RE2::Options& opt);
+
+struct stat_t
+{
+    int64_t hits      = 0;
+    int64_t misses    = 0;   // 需要编译RE2的次数
+    int64_t evictions = 0;   // 因超出容量而淘汰的条目数
+    int64_t errors    = 0;   // 编译失败的次数；失败的不缓存
+};
+
+// 进程级的LRU缓存：按 pattern+flags 复用已编译的RE2对象。
+// RE2的const方法线程安全，缓存出去的对象可以被多处同时使用；
+// 被淘汰的条目，只要还有regex_t引用着，就不会析构。
+//
+// 编译失败时，抛出std::runtime_error(含RE2的错误信息)。
+regex_t get(sss::string_view pattern, uint32_t flags = flag_none);
+
+stat_t get_stat();
+size_t size();
+
+// 容量为0时，不缓存(每次都重新编译)；缩小时，立即淘汰多余的条目
+size_t get_capacity();
+void   set_capacity(size_t capacity);
+
+} // namespace varlisp::detail::regex_cache
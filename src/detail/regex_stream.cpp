@@ -0,0 +1,146 @@
+#include "regex_stream.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "file.hpp"
+#include "string_kernel.hpp"
+
+namespace varlisp::detail {
+
+namespace {
+
+// 读满缓冲区，或者读到文件结尾；返回是否到达文件结尾
+bool read_full(int fd, std::vector<char>& buf, size_t& end)
+{
+    while (end < buf.size()) {
+        ssize_t ec = file::read_fd(fd, buf.data() + end, buf.size() - end);
+        if (ec == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("regex-stream read: ") + std::strerror(errno));
+        }
+        if (ec == 0) {
+            return true;
+        }
+        end += size_t(ec);
+    }
+    return false;
+}
+
+}  // namespace
+
+int64_t regex_stream_scan(
+    int fd, const RE2& re, size_t sub_count, const regex_stream_option_t& opt,
+    const std::function<void(sss::string_view)>& on_text,
+    const std::function<void(const re2::StringPiece* subs, size_t n)>& on_match)
+{
+    const size_t max_match = std::max<size_t>(opt.max_match, 1);
+    const size_t window = std::max<size_t>(opt.chunk_size, 1) + max_match;
+    std::vector<char> buf(window + 1);
+    std::vector<re2::StringPiece> subs(std::max<size_t>(sub_count, 1));
+
+    size_t pos = 0;         // 尚未处理的数据开头
+    size_t end = 0;
+    size_t last_end = size_t(-1); // 上一个匹配的结尾；用于忽略紧随其后的空匹配
+    bool eof = false;
+    int64_t count = 0;
+
+    auto flush_to = [&](size_t upto) {
+        if (upto > pos) {
+            if (on_text) {
+                on_text(sss::string_view(buf.data() + pos, upto - pos));
+            }
+            pos = upto;
+        }
+    };
+
+    while (true) {
+        // 未处理的数据不足max_match，或者pos已过缓冲区一半时，才整理并续读；
+        // 否则每个匹配之后都要搬移整个缓冲区，扫描变成 O(匹配数 × chunk_size)
+        if (!eof && (end - pos <= max_match || pos > window / 2)) {
+            // NOTE 保留pos之前的1字节，供^、\b等判断上下文
+            const size_t keep_from = pos > 0 ? pos - 1 : 0;
+            std::memmove(buf.data(), buf.data() + keep_from, end - keep_from);
+            end -= keep_from;
+            pos -= keep_from;
+            if (last_end != size_t(-1)) {
+                last_end = last_end >= keep_from ? last_end - keep_from : size_t(-1);
+            }
+            eof = read_full(fd, buf, end);
+        }
+        // NOTE pos==end时，也要匹配一次：可能有位于结尾的空匹配
+        const re2::StringPiece text(buf.data(), end);
+        if (!re.Match(text, pos, end, RE2::UNANCHORED, subs.data(), int(subs.size()))) {
+            if (eof) {
+                flush_to(end);
+                break;
+            }
+            // 起始于end-max_match之前的匹配，长度必然超过max_match
+            flush_to(end > max_match ? std::max(pos, end - max_match) : pos);
+            continue;
+        }
+
+        const size_t m_beg = subs[0].data() - buf.data();
+        const size_t m_end = m_beg + subs[0].size();
+        if (!eof && m_beg + max_match > end) {
+            // 匹配可能延伸到下一块；读入更多数据后重新匹配
+            flush_to(m_beg);
+            continue;
+        }
+
+        if (m_beg == m_end) {
+            const size_t len = m_beg < end
+                ? std::max<size_t>(1, strkernel::utf8_seq_len(buf.data() + m_beg, end - m_beg))
+                : 0;
+            flush_to(m_beg);
+            if (m_beg != last_end) {
+                on_match(subs.data(), subs.size());
+                ++count;
+            }
+            last_end = size_t(-1);
+            if (len == 0) {
+                // 空匹配位于数据结尾
+                if (eof) {
+                    break;
+                }
+                continue;
+            }
+            flush_to(m_beg + len);
+            continue;
+        }
+
+        flush_to(m_beg);
+        on_match(subs.data(), subs.size());
+        ++count;
+        pos = m_end;
+        last_end = m_end;
+    }
+    return count;
+}
+
+void fd_writer_t::flush()
+{
+    size_t offset = 0;
+    while (offset < m_buf.size()) {
+        ssize_t ec = ::write(m_fd, m_buf.data() + offset, m_buf.size() - offset);
+        if (ec == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("fd_writer write: ") + std::strerror(errno));
+        }
+        offset += size_t(ec);
+    }
+    m_written += int64_t(m_buf.size());
+    m_buf.clear();
+}
+
+} // namespace varlisp::detail
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include <re2/re2.h>
+
+namespace varlisp::detail {
+
+// 在fd上流式地执行正则匹配；内存占用为 chunk_size + max_match，与输入大小无关。
+//
+// 跨块的匹配：起始位置之后还剩不足max_match字节、且尚未读到文件结尾时，
+// 先读入更多数据再匹配；因此长度不超过max_match的匹配，结果与整体载入后
+// 匹配相同。更长的匹配，可能被截断，或者错过。
+//
+// 空匹配的处理同RE2::GlobalReplace：紧接在上一个匹配之后的空匹配被忽略；
+// 空匹配之后，前进一个utf8字符。
+struct regex_stream_option_t
+{
+    size_t chunk_size = 1024 * 1024;
+    size_t max_match  = 64 * 1024;
+};
+
+// on_text: 两个匹配之间(以及首尾)未匹配的文本；可能分多次给出；可以为空
+// on_match: 匹配到的各个子匹配；subs引用内部缓冲区，仅在回调期间有效
+//
+// 返回匹配次数；读取出错时，抛出std::runtime_error
+int64_t regex_stream_scan(
+    int fd, const RE2& re, size_t sub_count, const regex_stream_option_t& opt,
+    const std::function<void(sss::string_view)>& on_text,
+    const std::function<void(const re2::StringPiece* subs, size_t n)>& on_match);
+
+// 缓冲写出到fd；析构时不自动flush(flush可能抛异常)
+class fd_writer_t
+{
+public:
+    explicit fd_writer_t(int fd, size_t buf_size = 1024 * 1024)
+        : m_fd(fd), m_buf_size(buf_size)
+    {
+        m_buf.reserve(buf_size);
+    }
+
+public:
+    void write(sss::string_view s)
+    {
+        m_buf.append(s.data(), s.size());
+        if (m_buf.size() >= m_buf_size) {
+            this->flush();
+        }
+    }
+
+    // 写出出错时，抛出std::runtime_error
+    void flush();
+
+    int64_t written() const
+    {
+        return m_written;
+    }
+
+private:
+    int         m_fd;
+    size_t      m_buf_size;
+    std::string m_buf;
+    int64_t     m_written = 0;
+};
+
+} // namespace varlisp::detail
@@ -0,0 +1,117 @@
+#include "selector_cache.hpp"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <gq/Parser.h>
+#include <gq/Selector.h>
+
+namespace varlisp::detail::selector_cache {
+
+namespace {
+
+const size_t default_capacity = 256;
+
+struct cache_t
+{
+    using item_t = std::pair<std::string, std::shared_ptr<CSelector>>;
+
+    std::mutex                                                  m_mutex;
+    size_t                                                      m_capacity = default_capacity;
+    std::list<item_t>                                           m_items;  // 头部为最近使用
+    std::unordered_map<std::string, std::list<item_t>::iterator> m_index;
+    stat_t                                                      m_stat;
+
+    // 调用时须持有m_mutex
+    void shrink_to(size_t capacity)
+    {
+        while (m_items.size() > capacity) {
+            m_index.erase(m_items.back().first);
+            m_items.pop_back();
+            m_stat.evictions++;
+        }
+    }
+};
+
+cache_t& get_cache()
+{
+    // NOTE 不析构；避免退出时，与其他静态对象的析构顺序问题
+    static auto* p_cache = new cache_t;
+    return *p_cache;
+}
+
+// CSelector 是CObject的引用计数；交给shared_ptr管理时，最后release()
+struct selector_release_t
+{
+    void operator()(CSelector* p) const
+    {
+        if (p != nullptr) {
+            p->release();
+        }
+    }
+};
+
+}  // namespace
+
+std::shared_ptr<CSelector> get(const std::string& selector)
+{
+    auto& cache = get_cache();
+    {
+        std::lock_guard<std::mutex> lock(cache.m_mutex);
+        auto it = cache.m_index.find(selector);
+        if (it != cache.m_index.end()) {
+            cache.m_items.splice(cache.m_items.begin(), cache.m_items, it->second);
+            cache.m_stat.hits++;
+            return it->second->second;
+        }
+        cache.m_stat.misses++;
+    }
+
+    std::shared_ptr<CSelector> sel(CParser::create(selector), selector_release_t{});
+
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    if (cache.m_capacity == 0) {
+        return sel;
+    }
+    auto it = cache.m_index.find(selector);
+    if (it != cache.m_index.end()) {
+        return it->second->second;
+    }
+    cache.m_items.emplace_front(selector, sel);
+    cache.m_index.emplace(selector, cache.m_items.begin());
+    cache.shrink_to(cache.m_capacity);
+    return sel;
+}
+
+stat_t get_stat()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_stat;
+}
+
+size_t size()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_items.size();
+}
+
+size_t get_capacity()
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    return cache.m_capacity;
+}
+
+void set_capacity(size_t capacity)
+{
+    auto& cache = get_cache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    cache.m_capacity = capacity;
+    cache.shrink_to(capacity);
+}
+
+} // namespace varlisp::detail::selector_cache
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class CSelector;
+
+namespace varlisp::detail::selector_cache {
+
+struct stat_t
+{
+    int64_t hits      = 0;
+    int64_t misses    = 0;   // 需要CParser解析的次数
+    int64_t evictions = 0;
+};
+
+// 进程级的LRU缓存：按选择器字符串，复用CParser::create()的解析结果。
+// 解析失败时，同CParser，抛出std::string
+std::shared_ptr<CSelector> get(const std::string& selector);
+
+stat_t get_stat();
+size_t size();
+
+// 容量为0时，不缓存
+size_t get_capacity();
+void   set_capacity(size_t capacity);
+
+} // namespace varlisp::detail::selector_cache
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../object.hpp"
+#include "../builtin_helper.hpp"
+
+namespace varlisp::detail {
+
+// 顺序取出s-list或lazy-seq的元素；供map、filter、reduce、is-any等共用。
+// lazy-seq 逐个向生成器取值，不物化整个序列；提前结束遍历，也就不再读取。
+//
+// NOTE 内部持有参数求值的临时结果；不可拷贝、移动
+class seq_cursor_t
+{
+public:
+    // arg 求值后，既不是s-list，也不是lazy-seq时，is_valid()为false
+    seq_cursor_t(varlisp::Environment& env, const Object& arg)
+    {
+        const Object& ref = varlisp::getAtomicValue(env, arg, m_tmp);
+        if (const auto* p_seq = boost::get<varlisp::LazySeq>(&ref)) {
+            m_seq    = *p_seq;
+            m_is_seq = true;
+            return;
+        }
+        m_list = varlisp::getQuotedList(env, ref, m_tmpList);
+        if (m_list != nullptr) {
+            m_it = m_list->begin();
+        }
+    }
+
+    seq_cursor_t(const seq_cursor_t&) = delete;
+    seq_cursor_t& operator=(const seq_cursor_t&) = delete;
+
+public:
+    bool is_valid() const
+    {
+        return m_is_seq || m_list != nullptr;
+    }
+
+    // 取下一个元素；已耗尽返回false
+    bool next(Object& out)
+    {
+        if (m_is_seq) {
+            return m_seq.next(out);
+        }
+        if (m_list == nullptr || m_it == m_list->end()) {
+            return false;
+        }
+        out = *m_it++;
+        return true;
+    }
+
+private:
+    Object                      m_tmp;
+    Object                      m_tmpList;
+    const varlisp::List*        m_list = nullptr;
+    varlisp::List::const_iterator m_it;
+    varlisp::LazySeq            m_seq;
+    bool                        m_is_seq = false;
+};
+
+} // namespace varlisp::detail
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/path.hpp>
+#include <sss/util/PostionThrow.hpp>
+
+#include "../object.hpp"
+#include "../builtin_helper.hpp"
+
+#include "file.hpp"
+
+namespace varlisp::detail {
+
+// 流式函数的输入、输出：fd，或者路径；路径由本对象打开，析构时关闭
+class stream_fd_t
+{
+public:
+    stream_fd_t(const Object& ref, bool is_output, const char* funcName, size_t index)
+    {
+        if (const auto* p_fd = boost::get<int64_t>(&ref)) {
+            m_fd = int(*p_fd);
+            // NOTE 之前read-line等读入、未消费的数据，不能被跳过
+            file::sync_reader(m_fd);
+            return;
+        }
+        const auto* p_path = boost::get<varlisp::string_t>(&ref);
+        if (p_path == nullptr) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": require fd:int or path:string as ",
+                               readableIndex(index), " argument; but ", ref, ")");
+        }
+        std::string full_path = sss::path::full_of_copy(*p_path->gen_shared());
+        if (is_output) {
+            sss::path::mkpath(sss::path::dirname(full_path));
+            m_fd = ::open(full_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+        else {
+            m_fd = ::open(full_path.c_str(), O_RDONLY);
+        }
+        if (m_fd == -1) {
+            SSS_POSITION_THROW(std::runtime_error, "(", funcName, ": failed open `", *p_path,
+                               "`; ", std::strerror(errno), ")");
+        }
+        m_owned = true;
+    }
+    ~stream_fd_t()
+    {
+        if (m_owned) {
+            ::close(m_fd);
+        }
+    }
+
+    stream_fd_t(const stream_fd_t&) = delete;
+    stream_fd_t& operator=(const stream_fd_t&) = delete;
+
+    int fd() const { return m_fd; }
+
+private:
+    int  m_fd    = -1;
+    bool m_owned = false;
+};
+
+} // namespace varlisp::detail
@@ -0,0 +1,590 @@
+#include "string_kernel.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VARLISP_STRKERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace varlisp::detail::strkernel {
+
+namespace {
+
+inline bool is_space(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return u == ' ' || static_cast<unsigned char>(u - '\t') <= 4;
+}
+
+inline bool is_cont(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xC0U) == 0x80U;
+}
+
+inline std::string_view sv(const char* p, size_t n)
+{
+    return {p, n};
+}
+
+// scalar
+
+size_t find_char_scalar(const char* p, size_t n, char c)
+{
+    return sv(p, n).find(c);
+}
+
+size_t find_scalar(const char* p, size_t n, const char* q, size_t k)
+{
+    return sv(p, n).find(sv(q, k));
+}
+
+size_t rfind_scalar(const char* p, size_t n, const char* q, size_t k)
+{
+    return sv(p, n).rfind(sv(q, k));
+}
+
+size_t space_prefix_scalar(const char* p, size_t n)
+{
+    size_t i = 0;
+    while (i < n && is_space(p[i])) {
+        ++i;
+    }
+    return i;
+}
+
+size_t space_suffix_scalar(const char* p, size_t n)
+{
+    size_t e = n;
+    while (e > 0 && is_space(p[e - 1])) {
+        --e;
+    }
+    return n - e;
+}
+
+size_t ascii_prefix_scalar(const char* p, size_t n)
+{
+    size_t i = 0;
+    while (i < n && static_cast<unsigned char>(p[i]) < 0x80U) {
+        ++i;
+    }
+    return i;
+}
+
+size_t utf8_count_scalar(const char* p, size_t n)
+{
+    size_t cnt = 0;
+    for (size_t i = 0; i < n; ++i) {
+        cnt += is_cont(p[i]) ? 0 : 1;
+    }
+    return cnt;
+}
+
+#ifdef VARLISP_STRKERNEL_X86
+
+// 连续skip_after字节都没有首字节时，交给memchr跳到下一个首字节；
+// 首字节罕见时，glibc的memchr比首尾字节过滤更快；
+// 首字节常见时，memchr每次只跳几个字节，反而更慢。
+const unsigned skip_after = 128;
+
+// memchr跳过的距离不足skip_after时，说明首字节不够罕见，加倍等待的块数
+inline unsigned next_limit(unsigned limit, size_t skipped, unsigned width)
+{
+    if (skipped >= skip_after) {
+        return skip_after / width;
+    }
+    return limit < 1024U ? limit * 2 : limit;
+}
+
+// 返回下一个候选起点；不存在时返回n - k + 1
+inline size_t skip_to_first(const char* p, size_t n, const char* q, size_t k, size_t from)
+{
+    const size_t end = n - k + 1;
+    if (from >= end) {
+        return end;
+    }
+    const void* hit = std::memchr(p + from, q[0], end - from);
+    return hit ? size_t(static_cast<const char*>(hit) - p) : end;
+}
+
+// sse2
+
+__attribute__((target("sse2")))
+size_t find_char_sse2(const char* p, size_t n, char c)
+{
+    const __m128i vc = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(v, vc));
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    const size_t pos = find_char_scalar(p + i, n - i, c);
+    return pos == npos ? npos : i + pos;
+}
+
+// 首尾字节同时匹配的位置，才比较中间部分
+__attribute__((target("sse2")))
+size_t find_sse2(const char* p, size_t n, const char* q, size_t k)
+{
+    const __m128i first = _mm_set1_epi8(q[0]);
+    const __m128i last = _mm_set1_epi8(q[k - 1]);
+    size_t i = 0;
+    unsigned misses = 0;
+    unsigned limit = skip_after / 16;
+    while (i + k - 1 + 16 <= n) {
+        const __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i ef = _mm_cmpeq_epi8(first, bf);
+        const __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + k - 1));
+        unsigned m = _mm_movemask_epi8(_mm_and_si128(ef, _mm_cmpeq_epi8(last, bl)));
+        while (m != 0U) {
+            const unsigned b = __builtin_ctz(m);
+            if (std::memcmp(p + i + b + 1, q + 1, k - 2) == 0) {
+                return i + b;
+            }
+            m &= m - 1;
+        }
+        misses = (misses + 1) * unsigned(_mm_movemask_epi8(ef) == 0);
+        i += 16;
+        if (misses >= limit) {
+            misses = 0;
+            const size_t from = i;
+            i = skip_to_first(p, n, q, k, i);
+            limit = next_limit(limit, i - from, 16);
+        }
+    }
+    if (i > n - k) {
+        return npos;
+    }
+    const size_t pos = find_scalar(p + i, n - i, q, k);
+    return pos == npos ? npos : i + pos;
+}
+
+__attribute__((target("sse2")))
+size_t rfind_sse2(const char* p, size_t n, const char* q, size_t k)
+{
+    const __m128i first = _mm_set1_epi8(q[0]);
+    const __m128i last = _mm_set1_epi8(q[k - 1]);
+    // [0, top) 为尚未检查的起始位置
+    size_t top = n - k + 1;
+    for (; top >= 16; top -= 16) {
+        const size_t base = top - 16;
+        const __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + base));
+        const __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + base + k - 1));
+        unsigned m = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, bf), _mm_cmpeq_epi8(last, bl)));
+        while (m != 0U) {
+            const unsigned b = 31 - __builtin_clz(m);
+            if (std::memcmp(p + base + b + 1, q + 1, k - 2) == 0) {
+                return base + b;
+            }
+            m &= ~(1U << b);
+        }
+    }
+    return rfind_scalar(p, top + k - 1, q, k);
+}
+
+__attribute__((target("sse2")))
+inline unsigned space_mask_sse2(__m128i v)
+{
+    const __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    const __m128i is_ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+    const __m128i is_sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    return _mm_movemask_epi8(_mm_or_si128(is_ctl, is_sp));
+}
+
+__attribute__((target("sse2")))
+size_t space_prefix_sse2(const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const unsigned m = ~space_mask_sse2(v) & 0xFFFFU;
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return i + space_prefix_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse2")))
+size_t space_suffix_sse2(const char* p, size_t n)
+{
+    size_t e = n;
+    for (; e >= 16; e -= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + e - 16));
+        const unsigned m = ~space_mask_sse2(v) & 0xFFFFU;
+        if (m != 0U) {
+            return n - (e - 16 + (31 - __builtin_clz(m)) + 1);
+        }
+    }
+    return n - e + space_suffix_scalar(p, e);
+}
+
+__attribute__((target("sse2")))
+size_t ascii_prefix_sse2(const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const unsigned m = _mm_movemask_epi8(v);
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return i + ascii_prefix_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse2,popcnt")))
+size_t utf8_count_sse2(const char* p, size_t n)
+{
+    // 有符号比较：大于-65(0xBF)的，即非后续字节
+    const __m128i bound = _mm_set1_epi8(-65);
+    size_t cnt = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        cnt += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(v, bound)));
+    }
+    return cnt + utf8_count_scalar(p + i, n - i);
+}
+
+// avx2
+
+__attribute__((target("avx2")))
+size_t find_char_avx2(const char* p, size_t n, char c)
+{
+    const __m256i vc = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const auto m = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc)));
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    const size_t pos = find_char_scalar(p + i, n - i, c);
+    return pos == npos ? npos : i + pos;
+}
+
+__attribute__((target("avx2")))
+size_t find_avx2(const char* p, size_t n, const char* q, size_t k)
+{
+    const __m256i first = _mm256_set1_epi8(q[0]);
+    const __m256i last = _mm256_set1_epi8(q[k - 1]);
+    size_t i = 0;
+    unsigned misses = 0;
+    unsigned limit = skip_after / 32;
+    while (i + k - 1 + 32 <= n) {
+        const __m256i bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i ef = _mm256_cmpeq_epi8(first, bf);
+        const __m256i bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + k - 1));
+        auto m = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_and_si256(ef, _mm256_cmpeq_epi8(last, bl))));
+        while (m != 0U) {
+            const unsigned b = __builtin_ctz(m);
+            if (std::memcmp(p + i + b + 1, q + 1, k - 2) == 0) {
+                return i + b;
+            }
+            m &= m - 1;
+        }
+        misses = (misses + 1) * unsigned(_mm256_movemask_epi8(ef) == 0);
+        i += 32;
+        if (misses >= limit) {
+            misses = 0;
+            const size_t from = i;
+            i = skip_to_first(p, n, q, k, i);
+            limit = next_limit(limit, i - from, 32);
+        }
+    }
+    if (i > n - k) {
+        return npos;
+    }
+    const size_t pos = find_scalar(p + i, n - i, q, k);
+    return pos == npos ? npos : i + pos;
+}
+
+__attribute__((target("avx2")))
+size_t rfind_avx2(const char* p, size_t n, const char* q, size_t k)
+{
+    const __m256i first = _mm256_set1_epi8(q[0]);
+    const __m256i last = _mm256_set1_epi8(q[k - 1]);
+    size_t top = n - k + 1;
+    for (; top >= 32; top -= 32) {
+        const size_t base = top - 32;
+        const __m256i bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + base));
+        const __m256i bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + base + k - 1));
+        auto m = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, bf), _mm256_cmpeq_epi8(last, bl))));
+        while (m != 0U) {
+            const unsigned b = 31 - __builtin_clz(m);
+            if (std::memcmp(p + base + b + 1, q + 1, k - 2) == 0) {
+                return base + b;
+            }
+            m &= ~(1U << b);
+        }
+    }
+    return rfind_scalar(p, top + k - 1, q, k);
+}
+
+__attribute__((target("avx2")))
+inline unsigned space_mask_avx2(__m256i v)
+{
+    const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    const __m256i is_ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+    const __m256i is_sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(is_ctl, is_sp)));
+}
+
+__attribute__((target("avx2")))
+size_t space_prefix_avx2(const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const unsigned m = ~space_mask_avx2(v);
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return i + space_prefix_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t space_suffix_avx2(const char* p, size_t n)
+{
+    size_t e = n;
+    for (; e >= 32; e -= 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + e - 32));
+        const unsigned m = ~space_mask_avx2(v);
+        if (m != 0U) {
+            return n - (e - 32 + (31 - __builtin_clz(m)) + 1);
+        }
+    }
+    return n - e + space_suffix_scalar(p, e);
+}
+
+__attribute__((target("avx2")))
+size_t ascii_prefix_avx2(const char* p, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const auto m = static_cast<unsigned>(_mm256_movemask_epi8(v));
+        if (m != 0U) {
+            return i + __builtin_ctz(m);
+        }
+    }
+    return i + ascii_prefix_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+size_t utf8_count_avx2(const char* p, size_t n)
+{
+    const __m256i bound = _mm256_set1_epi8(-65);
+    size_t cnt = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        cnt += __builtin_popcount(
+            static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, bound))));
+    }
+    return cnt + utf8_count_scalar(p + i, n - i);
+}
+
+#endif // VARLISP_STRKERNEL_X86
+
+isa_t detect_isa()
+{
+#ifdef VARLISP_STRKERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return isa_avx2;
+    }
+    if (__builtin_cpu_supports("sse2") && __builtin_cpu_supports("popcnt")) {
+        return isa_sse2;
+    }
+#endif
+    return isa_scalar;
+}
+
+std::atomic<int>& current_isa()
+{
+    static std::atomic<int> isa{best_isa()};
+    return isa;
+}
+
+}  // namespace
+
+isa_t best_isa()
+{
+    static const isa_t isa = detect_isa();
+    return isa;
+}
+
+isa_t get_isa()
+{
+    return static_cast<isa_t>(current_isa().load(std::memory_order_relaxed));
+}
+
+void set_isa(isa_t isa)
+{
+    if (isa > best_isa()) {
+        isa = best_isa();
+    }
+    current_isa().store(isa, std::memory_order_relaxed);
+}
+
+const char* isa_name(isa_t isa)
+{
+    switch (isa) {
+        case isa_avx2:
+            return "avx2";
+        case isa_sse2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+#ifdef VARLISP_STRKERNEL_X86
+#define VARLISP_STRKERNEL_DISPATCH(func, ...)       \
+    switch (get_isa()) {                            \
+        case isa_avx2:                              \
+            return func##_avx2(__VA_ARGS__);        \
+        case isa_sse2:                              \
+            return func##_sse2(__VA_ARGS__);        \
+        default:                                    \
+            return func##_scalar(__VA_ARGS__);      \
+    }
+#else
+#define VARLISP_STRKERNEL_DISPATCH(func, ...)       \
+    return func##_scalar(__VA_ARGS__);
+#endif
+
+// 候选起点不足64个(两个avx2块)时，向量化的准备开销超过收益
+const size_t small_haystack = 64;
+
+size_t find_char(sss::string_view s, char c)
+{
+    VARLISP_STRKERNEL_DISPATCH(find_char, s.data(), s.size(), c);
+}
+
+size_t find(sss::string_view s, sss::string_view needle)
+{
+    const size_t k = needle.size();
+    if (k == 0) {
+        return 0;
+    }
+    if (k > s.size()) {
+        return npos;
+    }
+    if (k == 1) {
+        return find_char(s, needle.data()[0]);
+    }
+    if (s.size() < k + small_haystack) {
+        return find_scalar(s.data(), s.size(), needle.data(), k);
+    }
+    VARLISP_STRKERNEL_DISPATCH(find, s.data(), s.size(), needle.data(), k);
+}
+
+size_t rfind(sss::string_view s, sss::string_view needle)
+{
+    const size_t k = needle.size();
+    if (k == 0) {
+        return s.size();
+    }
+    if (k > s.size()) {
+        return npos;
+    }
+    if (k == 1) {
+        return std::string_view(s.data(), s.size()).rfind(needle.data()[0]);
+    }
+    if (s.size() < k + small_haystack) {
+        return rfind_scalar(s.data(), s.size(), needle.data(), k);
+    }
+    VARLISP_STRKERNEL_DISPATCH(rfind, s.data(), s.size(), needle.data(), k);
+}
+
+size_t space_prefix(sss::string_view s)
+{
+    VARLISP_STRKERNEL_DISPATCH(space_prefix, s.data(), s.size());
+}
+
+size_t space_suffix(sss::string_view s)
+{
+    VARLISP_STRKERNEL_DISPATCH(space_suffix, s.data(), s.size());
+}
+
+size_t ascii_prefix(sss::string_view s)
+{
+    VARLISP_STRKERNEL_DISPATCH(ascii_prefix, s.data(), s.size());
+}
+
+size_t utf8_count(sss::string_view s)
+{
+    VARLISP_STRKERNEL_DISPATCH(utf8_count, s.data(), s.size());
+}
+
+size_t utf8_seq_len(const char* p, size_t n)
+{
+    const auto c = static_cast<unsigned char>(p[0]);
+    if (c < 0x80U) {
+        return 1;
+    }
+    // 后续字节，或者2字节的超长编码
+    if (c < 0xC2U) {
+        return 0;
+    }
+    const auto c1 = n >= 2 ? static_cast<unsigned char>(p[1]) : 0U;
+    if (c < 0xE0U) {
+        return (n >= 2 && is_cont(p[1])) ? 2 : 0;
+    }
+    if (c < 0xF0U) {
+        if (n < 3 || !is_cont(p[1]) || !is_cont(p[2])) {
+            return 0;
+        }
+        if ((c == 0xE0U && c1 < 0xA0U) || (c == 0xEDU && c1 > 0x9FU)) {
+            return 0;
+        }
+        return 3;
+    }
+    if (c < 0xF5U) {
+        if (n < 4 || !is_cont(p[1]) || !is_cont(p[2]) || !is_cont(p[3])) {
+            return 0;
+        }
+        if ((c == 0xF0U && c1 < 0x90U) || (c == 0xF4U && c1 > 0x8FU)) {
+            return 0;
+        }
+        return 4;
+    }
+    return 0;
+}
+
+bool utf8_valid(sss::string_view s)
+{
+    const char * p = s.data();
+    const size_t n = s.size();
+    size_t i = 0;
+    while (i < n) {
+        i += ascii_prefix(sss::string_view(p + i, n - i));
+        // 非ASCII区段逐字符校验；遇到ASCII字节再回到向量化扫描
+        while (i < n && static_cast<unsigned char>(p[i]) >= 0x80U) {
+            const size_t len = utf8_seq_len(p + i, n - i);
+            if (len == 0) {
+                return false;
+            }
+            i += len;
+        }
+    }
+    return true;
+}
+
+#undef VARLISP_STRKERNEL_DISPATCH
+
+} // namespace varlisp::detail::strkernel
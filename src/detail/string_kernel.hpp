@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+#include <sss/string_view.hpp>
+
+namespace varlisp::detail::strkernel {
+
+// 字符串热点操作的向量化实现；按CPU运行时选择：
+//  avx2   - 每次处理32字节；
+//  sse2   - 每次处理16字节(x86_64的基线指令集)；
+//  scalar - 逐字节；非x86平台只有此实现。
+// 各实现结果完全一致；set_isa() 仅用于对比测试(varlisp-bench string)。
+enum isa_t {
+    isa_scalar = 0,
+    isa_sse2   = 1,
+    isa_avx2   = 2,
+};
+
+isa_t       best_isa();
+isa_t       get_isa();
+// 超出best_isa()的，降为best_isa()
+void        set_isa(isa_t isa);
+const char* isa_name(isa_t isa);
+
+const size_t npos = size_t(-1);
+
+// 首个c的偏移；不存在返回npos
+size_t find_char(sss::string_view s, char c);
+
+// 子串位置；同std::string_view::find()/rfind()
+size_t find(sss::string_view s, sss::string_view needle);
+size_t rfind(sss::string_view s, sss::string_view needle);
+
+// 开头/结尾的空白字节数；空白同C locale的isspace：" \t\n\v\f\r"
+size_t space_prefix(sss::string_view s);
+size_t space_suffix(sss::string_view s);
+
+// 开头的ASCII字节数
+size_t ascii_prefix(sss::string_view s);
+
+// utf8字符数；不校验，只统计非后续字节(10xxxxxx)
+size_t utf8_count(sss::string_view s);
+
+// 是否合法utf8：拒绝超长编码、代理区(U+D800~U+DFFF)、超出U+10FFFF
+bool   utf8_valid(sss::string_view s);
+
+// 以p开头的合法utf8序列的长度；非法(规则同utf8_valid)返回0
+size_t utf8_seq_len(const char* p, size_t n);
+
+} // namespace varlisp::detail::strkernel
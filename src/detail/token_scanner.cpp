@@ -0,0 +1,459 @@
+#include "token_scanner.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/util/PostionThrow.hpp>
+
+namespace varlisp::detail {
+
+namespace {
+
+inline bool is_space(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_xdigit(char c)
+{
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+inline bool is_alpha(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) != 0;
+}
+
+inline bool is_alnum(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+inline bool is_parenthese(char c)
+{
+    switch (c) {
+        case '(': case ')':
+        case '[': case ']':
+        case '{': case '}':
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 同 Tokenizer::TokenEnd_p
+inline bool is_token_end(const char * p, const char * end)
+{
+    return p == end || is_space(*p) || is_parenthese(*p);
+}
+
+inline bool starts_with(const char * p, const char * end, const char * prefix)
+{
+    size_t len = std::strlen(prefix);
+    return size_t(end - p) >= len && std::memcmp(p, prefix, len) == 0;
+}
+
+inline uint8_t hex2int(char ch)
+{
+    return is_digit(ch) ? (ch - '0') : ((ch % 16) + 9);
+}
+
+// utf8_range_p("一", "龥")；即 U+4E00 ~ U+9FA5，utf8编码都是3字节
+inline size_t cjk_length(const char * p, const char * end)
+{
+    if (end - p < 3) {
+        return 0;
+    }
+    const auto b0 = static_cast<unsigned char>(p[0]);
+    const auto b1 = static_cast<unsigned char>(p[1]);
+    const auto b2 = static_cast<unsigned char>(p[2]);
+    if ((b0 & 0xF0U) != 0xE0U || (b1 & 0xC0U) != 0x80U || (b2 & 0xC0U) != 0x80U) {
+        return 0;
+    }
+    uint32_t ucode = ((b0 & 0x0FU) << 12U) | ((b1 & 0x3FU) << 6U) | (b2 & 0x3FU);
+    return (ucode >= 0x4E00U && ucode <= 0x9FA5U) ? 3 : 0;
+}
+
+void append_utf8(std::string& out, uint32_t ucode)
+{
+    if (ucode < 0x80U) {
+        out += char(ucode);
+    }
+    else if (ucode < 0x800U) {
+        out += char(0xC0U | (ucode >> 6U));
+        out += char(0x80U | (ucode & 0x3FU));
+    }
+    else {
+        out += char(0xE0U | (ucode >> 12U));
+        out += char(0x80U | ((ucode >> 6U) & 0x3FU));
+        out += char(0x80U | (ucode & 0x3FU));
+    }
+}
+
+[[noreturn]] void throw_unrecognise(const char * p, const char * end)
+{
+    const char * q = p;
+    while (q != end && !is_space(*q)) {
+        ++q;
+    }
+    SSS_POSITION_THROW(std::runtime_error, "Un-recongnise string `",
+                       std::string(p, q), "`");
+}
+
+// 跳过空白、单行注释 ;...、多行注释 ;#...#;
+void skip_space_comment(const char *& p, const char * end)
+{
+    while (p != end) {
+        if (is_space(*p)) {
+            ++p;
+        }
+        else if (starts_with(p, end, ";#")) {
+            const char * q = p + 2;
+            while (q != end && !starts_with(q, end, "#;")) {
+                ++q;
+            }
+            if (q == end) {
+                SSS_POSITION_THROW(std::runtime_error, "expect `#;`");
+            }
+            p = q + 2;
+        }
+        else if (*p == ';') {
+            while (p != end && *p != '\n') {
+                ++p;
+            }
+        }
+        else {
+            break;
+        }
+    }
+}
+
+// "..." 字符串；不含转义字符时，整段拷贝一次
+void scan_string(const char *& p, const char * end, varlisp::Token& tok)
+{
+    std::string str;
+    const char * q = p + 1;
+    const char * run = q;
+    while (q != end && *q != '"') {
+        if (*q != '\\') {
+            ++q;
+            continue;
+        }
+        str.append(run, q);
+        ++q;
+        if (q == end) {
+            break;
+        }
+        char c = *q++;
+        switch (c) {
+            case '\\': str += '\\'; break;
+            case 'a':  str += '\a'; break;
+            case 'b':  str += '\b'; break;
+            case 'f':  str += '\f'; break;
+            case 'n':  str += '\n'; break;
+            case 'r':  str += '\r'; break;
+            case 't':  str += '\t'; break;
+            case 'v':  str += '\v'; break;
+            case '\'': str += '\''; break;
+            case '"':  str += '"';  break;
+
+            case 'x':
+                {
+                    if (q == end || !is_xdigit(*q)) {
+                        SSS_POSITION_THROW(std::runtime_error,
+                                           "expect hex digit after `\\x`");
+                    }
+                    uint8_t ch = 0U;
+                    for (int i = 0; i < 2 && q != end && is_xdigit(*q); ++i, ++q) {
+                        ch = ch * 16U + hex2int(*q);
+                    }
+                    str += char(ch);
+                }
+                break;
+
+            case 'u':
+                {
+                    uint32_t ucode = 0;
+                    for (int i = 0; i < 4; ++i, ++q) {
+                        if (q == end || !is_xdigit(*q)) {
+                            SSS_POSITION_THROW(std::runtime_error,
+                                               "expect 4 hex digits after `\\u`");
+                        }
+                        ucode = ucode * 16U + hex2int(*q);
+                    }
+                    append_utf8(str, ucode);
+                }
+                break;
+
+            default:
+                if (c >= '0' && c <= '7') {
+                    // [0-3][0-7][0-7] 或者 [0-7]{1,2}
+                    size_t max_len = (c <= '3') ? 3 : 2;
+                    uint8_t ch = c - '0';
+                    for (size_t i = 1; i < max_len && q != end && *q >= '0' && *q <= '7'; ++i, ++q) {
+                        ch = ch * 8U + (*q - '0');
+                    }
+                    str += char(ch);
+                }
+                else {
+                    str += c;
+                }
+                break;
+        }
+        run = q;
+    }
+    if (q == end) {
+        SSS_POSITION_THROW(std::runtime_error, "expect `\"`");
+    }
+    str.append(run, q);
+    ++q;
+    if (!is_token_end(q, end)) {
+        throw_unrecognise(p, end);
+    }
+    tok = std::move(str);
+    p = q;
+}
+
+// 0b..., 0x..., 整数, 浮点数；都要求紧跟TokenEnd
+bool scan_number(const char *& p, const char * end, varlisp::Token& tok)
+{
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'b' || p[1] == 'B' || p[1] == 'x' || p[1] == 'X')) {
+        const bool is_bin = (p[1] == 'b' || p[1] == 'B');
+        const char * q = p + 2;
+        int64_t h = 0;
+        while (q != end && (is_bin ? (*q == '0' || *q == '1') : is_xdigit(*q))) {
+            h = is_bin ? ((h << 1) + (*q - '0')) : ((h << 4) + hex2int(*q));
+            ++q;
+        }
+        if (q != p + 2 && is_token_end(q, end)) {
+            tok = h;
+            p = q;
+            return true;
+        }
+        return false;
+    }
+
+    const char * q = p;
+    bool is_negative = false;
+    if (q != end && (*q == '-' || *q == '+')) {
+        is_negative = (*q == '-');
+        ++q;
+    }
+    const char * digit_beg = q;
+    uint64_t u = 0;
+    while (q != end && is_digit(*q)) {
+        u = u * 10 + (*q - '0');
+        ++q;
+    }
+    const bool has_int_part = q != digit_beg;
+    if (has_int_part && is_token_end(q, end)) {
+        tok = is_negative ? -int64_t(u) : int64_t(u);
+        p = q;
+        return true;
+    }
+
+    bool has_frac_part = false;
+    if (q != end && *q == '.') {
+        ++q;
+        while (q != end && is_digit(*q)) {
+            ++q;
+            has_frac_part = true;
+        }
+    }
+    if (!has_int_part && !has_frac_part) {
+        return false;
+    }
+    if (q != end && (*q == 'e' || *q == 'E')) {
+        const char * e = q + 1;
+        if (e != end && (*e == '-' || *e == '+')) {
+            ++e;
+        }
+        if (e == end || !is_digit(*e)) {
+            return false;
+        }
+        while (e != end && is_digit(*e)) {
+            ++e;
+        }
+        q = e;
+    }
+    if (!is_token_end(q, end)) {
+        return false;
+    }
+    double d = 0.0;
+    // NOTE from_chars不接受前导的'+'
+    auto res = std::from_chars(digit_beg, q, d);
+    if (res.ec != std::errc() || res.ptr != q) {
+        return false;
+    }
+    tok = is_negative ? -d : d;
+    p = q;
+    return true;
+}
+
+// /regex/；同 Tokenizer::Regex_p
+// 与规则中的期望点('>')一致：'/'后已有正则字符，却缺少结尾的'/'，或者结尾'/'后
+// 不是TokenEnd，都直接报错，而不是回退为符号。
+bool scan_regex(const char *& p, const char * end, varlisp::Token& tok)
+{
+    const char * q = p + 1;
+    if (q == end || *q != '/') {
+        while (q != end && *q != ' ' && *q != '/') {
+            if (*q == '\\' && q + 1 != end && (q[1] == ' ' || q[1] == '/')) {
+                ++q;
+            }
+            ++q;
+        }
+        if (q == p + 1) {
+            return false;
+        }
+        if (q == end || *q != '/') {
+            throw_unrecognise(p, end);
+        }
+    }
+    ++q;
+    if (!is_token_end(q, end)) {
+        throw_unrecognise(p, end);
+    }
+
+    std::string regstr;
+    for (const char * it = p + 1; it < q - 1; ++it) {
+        if (*it == '\\' && it + 1 < q - 1) {
+            switch (*(it + 1)) {
+                case ' ': regstr += ' '; break;
+                case 'a': regstr += '\a'; break;
+                case 'f': regstr += '\f'; break;
+                case 't': regstr += '\t'; break;
+                case 'n': regstr += '\n'; break;
+                case 'r': regstr += '\r'; break;
+                case 'v': regstr += '\v'; break;
+                default: regstr += '\\', regstr += *(it + 1); break;
+            }
+            ++it;
+        }
+        else {
+            regstr += *it;
+        }
+    }
+    tok = std::make_shared<RE2>(regstr);
+    p = q;
+    return true;
+}
+
+// 同 Tokenizer::Symbol_p
+bool scan_symbol(const char *& p, const char * end, varlisp::Token& tok)
+{
+    const char * q = p;
+    auto is_op_char = [](char c) {
+        return std::ispunct(static_cast<unsigned char>(c)) != 0 &&
+               std::strchr("@#()[]{}$\"'", c) == nullptr;
+    };
+    if (is_op_char(*q)) {
+        while (q != end && is_op_char(*q)) {
+            ++q;
+        }
+    }
+    else {
+        size_t len = cjk_length(q, end);
+        if (len != 0U) {
+            q += len;
+        }
+        else if (is_alpha(*q) || *q == '@' || *q == '$') {
+            ++q;
+        }
+        else {
+            return false;
+        }
+        while (q != end) {
+            if ((len = cjk_length(q, end)) != 0U) {
+                q += len;
+            }
+            else if (is_alnum(*q) || *q == '_' || *q == '-' || *q == '?' ||
+                     *q == ':' || *q == '!') {
+                ++q;
+            }
+            else {
+                break;
+            }
+        }
+        if (!is_token_end(q, end)) {
+            throw_unrecognise(p, end);
+        }
+    }
+    std::string name(p, q);
+    if (varlisp::keywords_t::is_keyword(name)) {
+        tok = varlisp::keywords_t(name);
+    }
+    else {
+        tok = varlisp::symbol(std::move(name));
+    }
+    p = q;
+    return true;
+}
+
+} // namespace
+
+bool scan_token(sss::string_view& s, varlisp::Token& tok)
+{
+    const char * p = s.data();
+    const char * end = s.data() + s.size();
+
+    skip_space_comment(p, end);
+    if (p == end) {
+        s = sss::string_view(p, 0);
+        return false;
+    }
+
+    const char c = *p;
+    if (starts_with(p, end, "'\"(")) {
+        const char * q = p + 3;
+        while (q != end && !starts_with(q, end, ")\"'")) {
+            ++q;
+        }
+        if (q == end) {
+            SSS_POSITION_THROW(std::runtime_error, "expect `)\"'`");
+        }
+        tok = std::string(p + 3, q);
+        p = q + 3;
+    }
+    else if (c == '\'') {
+        tok = varlisp::quote_sign_t{};
+        ++p;
+    }
+    else if (is_parenthese(c)) {
+        tok = varlisp::parenthese_t(c);
+        ++p;
+    }
+    else if (c == '"') {
+        scan_string(p, end, tok);
+    }
+    else if (c == '#') {
+        const bool is_bool =
+            end - p >= 2 &&
+            (p[1] == 'T' || p[1] == 't' || p[1] == 'F' || p[1] == 'f');
+        if (!is_bool ||
+            (end - p > 2 && (is_alnum(p[2]) || p[2] == '-')))
+        {
+            throw_unrecognise(p, end);
+        }
+        tok = (p[1] == 'T' || p[1] == 't');
+        p += 2;
+    }
+    else if (!scan_number(p, end, tok) &&
+             !(c == '/' && scan_regex(p, end, tok)) &&
+             !scan_symbol(p, end, tok))
+    {
+        throw_unrecognise(p, end);
+    }
+
+    s = sss::string_view(p, end - p);
+    return true;
+}
+
+} // namespace varlisp::detail
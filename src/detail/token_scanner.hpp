@@ -0,0 +1,20 @@
+#pragma once
+
+#include <sss/string_view.hpp>
+
+#include "../tokenizer.hpp"
+
+namespace varlisp::detail {
+
+// 手写的词法扫描器；直接在只读的sss::string_view上工作(比如mmap得到的文件内容)，
+// 不需要像ss1x规则那样，先把源码拷贝进std::string。
+//
+// 识别的记号，与Tokenizer::Token_p一致；仅在生成Token时，为字符串、符号
+// 分配一次内存；括号、数字、布尔等，不分配。
+//
+// 跳过空白与注释后，从s头部取出一个记号，并前移s；
+// 没有更多记号时，返回false；
+// 无法识别时，抛出std::runtime_error。
+bool scan_token(sss::string_view& s, varlisp::Token& tok);
+
+} // namespace varlisp::detail
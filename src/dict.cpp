@@ -0,0 +1,224 @@
+#include "dict.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include "print_visitor.hpp"
+
+namespace varlisp {
+
+namespace {
+
+inline bool key_equal(const String& lhs, sss::string_view rhs)
+{
+    return lhs.size() == rhs.size() &&
+           (lhs.data() == rhs.data() || std::memcmp(lhs.data(), rhs.data(), rhs.size()) == 0);
+}
+
+inline std::string_view key_view(const String& key)
+{
+    return std::string_view(key.data(), key.size());
+}
+
+}  // namespace
+
+uint64_t Dict::hash(sss::string_view key)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size(); ++i) {
+        h ^= static_cast<unsigned char>(key.data()[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+size_t Dict::lookup(sss::string_view key) const
+{
+    if (m_slots.empty()) {
+        for (size_t i = 0; i < m_items.size(); ++i) {
+            if (key_equal(m_items[i].first, key)) {
+                return i;
+            }
+        }
+        return npos;
+    }
+    const size_t mask = m_slots.size() - 1;
+    for (size_t pos = hash(key) & mask;; pos = (pos + 1) & mask) {
+        const uint32_t slot = m_slots[pos];
+        if (slot == 0) {
+            return npos;
+        }
+        if (key_equal(m_items[slot - 1].first, key)) {
+            return slot - 1;
+        }
+    }
+}
+
+void Dict::index_append(size_t idx)
+{
+    if (m_slots.empty()) {
+        if (m_items.size() <= linear_limit) {
+            return;
+        }
+        this->rebuild_index();
+        return;
+    }
+    // 负载因子不超过1/2
+    if (m_items.size() * 2 > m_slots.size()) {
+        this->rebuild_index();
+        return;
+    }
+    const size_t mask = m_slots.size() - 1;
+    size_t pos = hash(m_items[idx].first.to_string_view()) & mask;
+    while (m_slots[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    m_slots[pos] = static_cast<uint32_t>(idx + 1);
+}
+
+void Dict::rebuild_index()
+{
+    m_slots.clear();
+    if (m_items.size() <= linear_limit) {
+        return;
+    }
+    size_t cap = 16;
+    while (cap < m_items.size() * 2) {
+        cap *= 2;
+    }
+    m_slots.assign(cap, 0);
+    const size_t mask = cap - 1;
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        size_t pos = hash(m_items[i].first.to_string_view()) & mask;
+        while (m_slots[pos] != 0) {
+            pos = (pos + 1) & mask;
+        }
+        m_slots[pos] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+const Object* Dict::find(sss::string_view key) const
+{
+    size_t idx = this->lookup(key);
+    return idx == npos ? nullptr : &m_items[idx].second;
+}
+
+Object* Dict::find(sss::string_view key)
+{
+    return const_cast<Object*>(const_cast<const Dict*>(this)->find(key));
+}
+
+Object& Dict::operator[](sss::string_view key)
+{
+    size_t idx = this->lookup(key);
+    if (idx == npos) {
+        idx = m_items.size();
+        m_items.emplace_back(String(key.to_string()), Nill{});
+        this->index_append(idx);
+    }
+    return m_items[idx].second;
+}
+
+bool Dict::insert(String key, Object value)
+{
+    size_t idx = this->lookup(key.to_string_view());
+    if (idx != npos) {
+        m_items[idx].second = std::move(value);
+        return false;
+    }
+    idx = m_items.size();
+    m_items.emplace_back(std::move(key), std::move(value));
+    this->index_append(idx);
+    return true;
+}
+
+bool Dict::erase(sss::string_view key)
+{
+    size_t idx = this->lookup(key);
+    if (idx == npos) {
+        return false;
+    }
+    // NOTE 保持插入顺序；后续元素下标变动，需重建索引
+    m_items.erase(m_items.begin() + idx);
+    if (!m_slots.empty()) {
+        this->rebuild_index();
+    }
+    return true;
+}
+
+void Dict::reserve(size_t n)
+{
+    m_items.reserve(n);
+}
+
+size_t Dict::clear()
+{
+    size_t cnt = m_items.size();
+    m_items.clear();
+    m_slots.clear();
+    return cnt;
+}
+
+void Dict::print(std::ostream& o) const
+{
+    o << '{';
+    for (const auto& item : m_items) {
+        o << '(' << item.first << ' ';
+        boost::apply_visitor(print_visitor(o), item.second);
+        o << ')';
+    }
+    o << '}';
+}
+
+bool Dict::operator==(const Dict& rhs) const
+{
+    if (this->size() != rhs.size()) {
+        return false;
+    }
+    for (const auto& item : m_items) {
+        const Object* p_val = rhs.find(item.first.to_string_view());
+        if (p_val == nullptr || !(item.second == *p_val)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Dict::operator<(const Dict& rhs) const
+{
+    if (this->size() != rhs.size()) {
+        return this->size() < rhs.size();
+    }
+    // 按键排序之后，再逐个比较；以保证与operator==一致
+    auto sorted = [](const Dict& d) {
+        std::vector<const value_type*> vec;
+        vec.reserve(d.size());
+        for (const auto& item : d.m_items) {
+            vec.push_back(&item);
+        }
+        std::sort(vec.begin(), vec.end(),
+                  [](const value_type* a, const value_type* b) {
+                      return key_view(a->first) < key_view(b->first);
+                  });
+        return vec;
+    };
+    auto lhs_vec = sorted(*this);
+    auto rhs_vec = sorted(rhs);
+    for (size_t i = 0; i < lhs_vec.size(); ++i) {
+        if (lhs_vec[i]->first != rhs_vec[i]->first) {
+            return key_view(lhs_vec[i]->first) < key_view(rhs_vec[i]->first);
+        }
+        if (lhs_vec[i]->second < rhs_vec[i]->second) {
+            return true;
+        }
+        if (rhs_vec[i]->second < lhs_vec[i]->second) {
+            return false;
+        }
+    }
+    return false;
+}
+
+}  // namespace varlisp
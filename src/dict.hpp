@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "object.hpp"
+
+namespace varlisp {
+
+struct Environment;
+
+// Dict 紧凑的键值表；json-parse 解析出来的json对象，即此类型。
+//
+// 元素按插入顺序，连续存放在vector中；
+// 元素不多于 linear_limit 个时，直接线性查找；
+// 超过之后，额外建立开放寻址(线性探测)的哈希索引，索引中只保存元素下标。
+//
+// NOTE 与Environment不同：没有parent，没有const属性，
+// 键名也不按 "a:b" 的json_accessor语法解释——键名就是键名。
+// 键为String：json-parse 的驻留模式下，各对象的同名长键共享同一缓冲区。
+struct Dict {
+    using value_type     = std::pair<String, Object>;
+    using storage_t      = std::vector<value_type>;
+    using iterator       = storage_t::iterator;
+    using const_iterator = storage_t::const_iterator;
+
+    static constexpr size_t linear_limit = 8;
+
+    Dict() = default;
+    ~Dict() = default;
+
+    Dict(const Dict&) = default;
+    Dict& operator=(const Dict&) = default;
+
+    Dict(Dict&&) = default;
+    Dict& operator=(Dict&&) = default;
+
+public:
+    const Object* find(sss::string_view key) const;
+    Object* find(sss::string_view key);
+
+    // 不存在，则插入nil
+    Object& operator[](sss::string_view key);
+
+    // 已存在则覆盖；返回是否新插入
+    bool insert(String key, Object value);
+
+    bool erase(sss::string_view key);
+
+    void reserve(size_t n);
+    size_t clear();
+
+    size_t size() const { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+
+    iterator begin() { return m_items.begin(); }
+    iterator end() { return m_items.end(); }
+    const_iterator begin() const { return m_items.begin(); }
+    const_iterator end() const { return m_items.end(); }
+
+    Object eval(Environment& /*env*/) const
+    {
+        return *this;
+    }
+
+    void print(std::ostream& o) const;
+
+    // 与键的顺序无关
+    bool operator==(const Dict& rhs) const;
+    bool operator<(const Dict& rhs) const;
+
+private:
+    static uint64_t hash(sss::string_view key);
+
+    // 返回元素下标；不存在返回npos
+    size_t lookup(sss::string_view key) const;
+    void   index_append(size_t idx);
+    void   rebuild_index();
+
+    static constexpr size_t npos = size_t(-1);
+
+private:
+    storage_t             m_items;
+    // 0表示空槽；否则为元素下标+1；大小为2的幂
+    std::vector<uint32_t> m_slots;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const Dict& d)
+{
+    d.print(o);
+    return o;
+}
+
+}  // namespace varlisp
@@ -9,6 +9,7 @@
 #include <sss/debug/value_msg.hpp>
 
 #include "eval_visitor.hpp"
+#include "detail/buitin_info_t.hpp"
 #include "detail/json_accessor.hpp"
 
 namespace varlisp {
@@ -86,6 +87,10 @@ const Object* Environment::deep_find(const std::string& name) const
             pe = pe->m_parent;
         } while (pe && !ret);
 
+        // NOTE 内建函数不在map中；用户定义的同名变量优先
+        if (!ret) {
+            ret = detail::find_builtin_object(name);
+        }
         return ret;
     }
     else {
@@ -95,7 +100,16 @@ const Object* Environment::deep_find(const std::string& name) const
 
 Object* Environment::deep_find(const std::string& name)
 {
-    return const_cast<Object*>(const_cast<const Environment*>(this)->deep_find(name));
+    const Object* ret = const_cast<const Environment*>(this)->deep_find(name);
+    // NOTE 内建函数对象表只读；可写访问时，在根环境中放一份常量条目，
+    // 同以前启动时逐个insert的效果；之后的修改，只作用于本环境链
+    const int idx = detail::builtin_object_index(ret);
+    if (idx >= 0) {
+        auto res = this->ceiling()->BaseT::emplace(
+            detail::get_builtin_infos()[idx].name, std::make_pair(*ret, property_t(true)));
+        return &res.first->second.first;
+    }
+    return const_cast<Object*>(ret);
 }
 
 const Object* Environment::find(const std::string& name) const
@@ -133,6 +147,10 @@ bool Environment::erase(const std::string& name)
         }
         pe = pe->m_parent;
     } while (pe && !erased);
+    if (!erased && detail::find_builtin(name) >= 0) {
+        SSS_POSITION_THROW(std::runtime_error,
+                           "cannot erase const Object ", *detail::find_builtin_object(name));
+    }
     return erased;
 }
 
@@ -1,47 +1,54 @@
 #include "gumboNode.hpp"
 
+#include <cstring>
 #include <sstream>
 
 #include <gq/QueryUtil.h>
+#include <gq/Selector.h>
 
 #include "detail/html.hpp"
+#include "detail/selector_cache.hpp"
 
 #include <sss/colorlog.hpp>
 
 namespace varlisp {
 
+gumbo_document_t::gumbo_document_t(const String& html) : source(html)
+{
+    this->text = this->source.gen_shared();
+    if (this->text->data() != this->source.data()) {
+        // NOTE 只是缓冲区的一部分：复制一份，使源文本与解析的串，共享同一缓冲区
+        this->source = String(*this->text);
+        this->text = this->source.gen_shared();
+    }
+    this->document.parse(*this->text);
+}
+
 gumboNode::gumboNode() {}
 
-gumboNode::gumboNode(const CNode& n,
-                     const std::shared_ptr<CDocument>& d,
-                     const std::shared_ptr<std::string>& r)
-    : mNode(n), mDocument(d), mRefer(r)
+gumboNode::gumboNode(const CNode& n, const std::shared_ptr<gumbo_document_t>& d)
+    : mNode(n), mDocument(d)
 {
 }
 
 gumboNode::gumboNode(std::string&& html)
 {
-    this->reset(std::make_shared<std::string>(std::move(html)));
+    this->reset(String(std::move(html)));
 }
 
-gumboNode::gumboNode(std::shared_ptr<std::string> html)
+gumboNode::gumboNode(const String& html)
 {
     this->reset(html);
 }
 
-void gumboNode::reset(std::shared_ptr<std::string> html)
+void gumboNode::reset(const String& html)
 {
-    if (!html) {
-        return;
-    }
-    auto document = std::make_shared<CDocument>();
-    document->parse(html->c_str());
+    auto document = std::make_shared<gumbo_document_t>(html);
 
-    if (document->isOK()) {
-        CSelection s = document->find("html");
+    if (document->document.isOK()) {
+        CSelection s = document->document.find("html");
         if (s.nodeNum()) {
             mNode = s.nodeAt(0);
-            mRefer = html;
             mDocument = document;
         }
     }
@@ -140,14 +147,137 @@ std::string gumboNode::outerHtml() const
     return "";
 }
 
+namespace {
+
+// p位于源文本中时，返回其视图
+bool source_view_of(const String& source, const char * p, size_t len, String& view)
+{
+    if (p == nullptr || p < source.data() || p + len > source.data() + source.size()) {
+        return false;
+    }
+    view = source.substr(sss::string_view(p, len));
+    return true;
+}
+
+// 统计文本类节点，最多数到2；只有一个时，记录在p_text中
+void count_text_nodes(GumboNode * p_node, size_t& count, GumboNode *& p_text)
+{
+    switch (p_node->type) {
+        case GUMBO_NODE_TEXT:
+        case GUMBO_NODE_CDATA:
+        case GUMBO_NODE_WHITESPACE:
+            if (++count == 1) {
+                p_text = p_node;
+            }
+            break;
+
+        case GUMBO_NODE_ELEMENT:
+            for (unsigned int i = 0; i < p_node->v.element.children.length && count < 2; ++i) {
+                count_text_nodes(static_cast<GumboNode*>(p_node->v.element.children.data[i]),
+                                 count, p_text);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+String gumboNode::textView() const
+{
+    if (!this->valid()) {
+        return String{};
+    }
+    auto * p_node = reinterpret_cast<GumboNode*>(mNode.get());
+    size_t count = 0;
+    GumboNode * p_text = nullptr;
+    count_text_nodes(p_node, count, p_text);
+    if (count == 0) {
+        return String{};
+    }
+    // NOTE 只有一个文本节点，且源文本中没有实体等需要转换的内容时，
+    // 解码后的文本，就是源文本中的一段
+    if (count == 1 && p_text->type == GUMBO_NODE_TEXT) {
+        const GumboStringPiece& original = p_text->v.text.original_text;
+        String view;
+        if (std::strlen(p_text->v.text.text) == original.length &&
+            std::memcmp(p_text->v.text.text, original.data, original.length) == 0 &&
+            source_view_of(mDocument->source, original.data, original.length, view))
+        {
+            return view;
+        }
+    }
+    return String(this->text());
+}
+
+String gumboNode::innerSource() const
+{
+    if (!this->valid()) {
+        return String{};
+    }
+    auto * p_node = reinterpret_cast<GumboNode*>(mNode.get());
+    if (p_node->type == GUMBO_NODE_ELEMENT) {
+        const GumboElement& e = p_node->v.element;
+        String view;
+        if (e.original_tag.length != 0 && e.original_end_tag.length != 0 &&
+            e.original_end_tag.data >= e.original_tag.data + e.original_tag.length &&
+            source_view_of(mDocument->source, e.original_tag.data + e.original_tag.length,
+                           e.original_end_tag.data - (e.original_tag.data + e.original_tag.length),
+                           view))
+        {
+            return view;
+        }
+    }
+    return String(this->innerHtml());
+}
+
+String gumboNode::outerSource() const
+{
+    if (!this->valid()) {
+        return String{};
+    }
+    auto * p_node = reinterpret_cast<GumboNode*>(mNode.get());
+    String view;
+    if (p_node->type == GUMBO_NODE_ELEMENT) {
+        const GumboElement& e = p_node->v.element;
+        if (e.original_tag.length != 0) {
+            if (e.original_end_tag.length != 0 &&
+                e.original_end_tag.data >= e.original_tag.data + e.original_tag.length &&
+                source_view_of(mDocument->source, e.original_tag.data,
+                               e.original_end_tag.data + e.original_end_tag.length - e.original_tag.data,
+                               view))
+            {
+                return view;
+            }
+            // 没有子节点的空元素，如<img ...>、<br/>
+            if (e.children.length == 0 &&
+                source_view_of(mDocument->source, e.original_tag.data, e.original_tag.length, view)) {
+                return view;
+            }
+        }
+    }
+    else if (p_node->type == GUMBO_NODE_TEXT || p_node->type == GUMBO_NODE_WHITESPACE ||
+             p_node->type == GUMBO_NODE_CDATA || p_node->type == GUMBO_NODE_COMMENT) {
+        const GumboStringPiece& original = p_node->v.text.original_text;
+        if (source_view_of(mDocument->source, original.data, original.length, view)) {
+            return view;
+        }
+    }
+    return String(this->outerHtml());
+}
+
 std::vector<gumboNode> gumboNode::find(const std::string& query) const
 {
     try {
         std::vector<gumboNode> ret;
         if (this->valid()) {
-            CSelection s = mNode.find(query);
-            for (size_t i = 0; i < s.nodeNum(); ++i) {
-                ret.emplace_back(s.nodeAt(i), mDocument, mRefer);
+            // NOTE 同CNode::find()，只是选择器取自缓存，不必每次重新解析
+            auto sel = detail::selector_cache::get(query);
+            auto * p_root = reinterpret_cast<GumboNode*>(mNode.get());
+            for (GumboNode * p_node : sel->matchAll(p_root)) {
+                ret.emplace_back(CNode(p_node), mDocument);
             }
         }
         return ret;
@@ -158,12 +288,53 @@ std::vector<gumboNode> gumboNode::find(const std::string& query) const
     }
 }
 
+namespace {
+// 先序遍历，与CSelector::matchAll()的顺序一致
+void match_batch(GumboNode * p_node, std::vector<std::shared_ptr<CSelector>>& sels,
+                 std::vector<std::vector<GumboNode*>>& matched)
+{
+    for (size_t i = 0; i < sels.size(); ++i) {
+        if (sels[i]->match(p_node)) {
+            matched[i].push_back(p_node);
+        }
+    }
+    if (p_node->type != GUMBO_NODE_ELEMENT) {
+        return;
+    }
+    for (unsigned int i = 0; i < p_node->v.element.children.length; ++i) {
+        match_batch(static_cast<GumboNode*>(p_node->v.element.children.data[i]), sels, matched);
+    }
+}
+} // namespace
+
+std::vector<std::vector<gumboNode>> gumboNode::find_batch(const std::vector<std::string>& queries) const
+{
+    std::vector<std::vector<gumboNode>> ret(queries.size());
+    if (!this->valid()) {
+        return ret;
+    }
+    std::vector<std::shared_ptr<CSelector>> sels;
+    sels.reserve(queries.size());
+    for (const auto& query : queries) {
+        sels.push_back(detail::selector_cache::get(query));
+    }
+    std::vector<std::vector<GumboNode*>> matched(queries.size());
+    match_batch(reinterpret_cast<GumboNode*>(mNode.get()), sels, matched);
+    for (size_t i = 0; i < matched.size(); ++i) {
+        ret[i].reserve(matched[i].size());
+        for (GumboNode * p_node : matched[i]) {
+            ret[i].emplace_back(CNode(p_node), mDocument);
+        }
+    }
+    return ret;
+}
+
 std::vector<gumboNode> gumboNode::children() const
 {
     std::vector<gumboNode> ret;
     if (this->valid()) {
         for (size_t i = 0; i != mNode.childNum(); ++i) {
-            ret.emplace_back(mNode.childAt(i), mDocument, mRefer);
+            ret.emplace_back(mNode.childAt(i), mDocument);
         }
     }
     return ret;
@@ -33,16 +33,27 @@ namespace varlisp {
 struct Environment;
 struct List;
 
+// 同一html文档的各个节点，共享的源文本及其解析结果；
+// 节点只需持有一个引用计数。
+struct gumbo_document_t
+{
+    explicit gumbo_document_t(const String& html);
+
+    gumbo_document_t(const gumbo_document_t& ) = delete;
+    gumbo_document_t& operator = (const gumbo_document_t& ) = delete;
+
+    String                       source;    // 节点的文本视图，共享其缓冲区
+    std::shared_ptr<std::string> text;      // 同source；交给gumbo解析的串
+    CDocument                    document;
+};
+
 class gumboNode
 {
 public:
     gumboNode();
-    gumboNode(const CNode& n,
-              const std::shared_ptr<CDocument>& d,
-              const std::shared_ptr<std::string>& r);
-    // explicit gumboNode(const std::string& html);
+    gumboNode(const CNode& n, const std::shared_ptr<gumbo_document_t>& d);
     explicit gumboNode(std::string&& html);
-    explicit gumboNode(std::shared_ptr<std::string> html);
+    explicit gumboNode(const String& html);
     ~gumboNode() = default;
 
 public:
@@ -54,7 +65,7 @@ public:
     gumboNode& operator = (const gumboNode& ) = default;
 
 public:
-    void reset(std::shared_ptr<std::string> html);
+    void reset(const String& html);
     void print(std::ostream& ) const;
 
     std::string attribute(const std::string& key) const;
@@ -69,6 +80,15 @@ public:
     std::string innerHtml() const;
     std::string outerHtml() const;
 
+    // 以下返回源文本的视图(共享其缓冲区，不复制)；
+    // 所需内容在源文本中不连续，或与源文本不同(如含有实体)时，才另外生成。
+    // 同text()
+    String      textView() const;
+    // 源文本中，节点标签之间的部分；标签是解析时补全的，则同innerHtml()
+    String      innerSource() const;
+    // 源文本中，节点的完整文本；标签是解析时补全的，则同outerHtml()
+    String      outerSource() const;
+
     bool operator == (const gumboNode& ref) const
     {
         return mNode.get() == ref.mNode.get();
@@ -92,12 +112,14 @@ public:
     }
 
     std::vector<gumboNode> find(const std::string& query) const;
+    // 一次遍历，同时执行多个选择器；结果与各自find()相同，按queries顺序返回；
+    // 选择器解析失败时，抛出std::string(同CParser)
+    std::vector<std::vector<gumboNode>> find_batch(const std::vector<std::string>& queries) const;
     std::vector<gumboNode> children() const;
 
 private:
     CNode mNode;
-    std::shared_ptr<CDocument> mDocument;
-    std::shared_ptr<std::string> mRefer;
+    std::shared_ptr<gumbo_document_t> mDocument;
 };
 
 inline std::ostream& operator<<(std::ostream& o, const gumboNode& g)
@@ -1,6 +1,7 @@
 #include "interpreter.hpp"
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include <sss/log.hpp>
@@ -10,6 +11,9 @@
 #include "builtin.hpp"
 #include "parser.hpp"
 
+#include "detail/ast_cache.hpp"
+#include "detail/buitin_info_t.hpp"
+
 namespace varlisp {
 Interpreter::Interpreter() : m_status(status_OK)
 {
@@ -54,14 +58,21 @@ void Interpreter::load(const std::string& path, bool echo)
     std::string full_path = sss::path::full_of_copy(path);
     if (!sss::path::filereadable(full_path)) {
         std::cerr << "load " << path << " failed." << std::endl;
-    }
-    std::string content;
-    sss::path::file2string(full_path, content);
-    if (content.empty()) {
         return;
     }
     std::cout << "loading " << full_path << " ...";
-    this->eval(content, !echo);
+    try {
+        // NOTE 脚本直接mmap解析；或者命中ast缓存，跳过解析
+        int ec = varlisp::detail::ast_cache::load(m_parser, this->m_env,
+                                                  full_path, !echo);
+        if (ec < 0 && m_status != status_QUIT) {
+            m_status = status_ERROR;
+        }
+    }
+    catch (Object& exception) {
+        COLOG_ERROR("unhandled exception: ", exception);
+        m_status = status_ERROR;
+    }
     std::cout << " succeed." << std::endl;
 }
 
@@ -71,6 +82,11 @@ int Interpreter::retrieve_symbols(std::vector<std::string>& symbols) const
     for (auto it = m_env.begin(); it != m_env.end(); ++cnt, ++it) {
         symbols.push_back(it->first);
     }
+    // 内建函数不在m_env中
+    for (const auto& info : varlisp::detail::get_builtin_infos()) {
+        symbols.push_back(info.name);
+        ++cnt;
+    }
     return cnt;
 }
 
@@ -85,6 +101,12 @@ int Interpreter::retrieve_symbols(std::vector<std::string>& symbols,
             ++cnt;
         }
     }
+    for (const auto& info : varlisp::detail::get_builtin_infos()) {
+        if (std::strncmp(info.name, prefix, std::strlen(prefix)) == 0) {
+            symbols.push_back(info.name);
+            ++cnt;
+        }
+    }
     std::sort(symbols.begin(), symbols.end());
     auto last = std::unique(symbols.begin(), symbols.end());
     symbols.erase(last, symbols.end());
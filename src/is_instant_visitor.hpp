@@ -14,6 +14,10 @@ struct List;
 struct Empty;
 struct Nill;
 struct Builtin;
+struct LazySeq;
+struct Dict;
+struct StringBuilder;
+struct RegexSet;
 
 class gumboNode;
 // 判断是否是立即值；
@@ -40,6 +44,10 @@ struct is_instant_visitor : public boost::static_visitor<bool> {
     bool operator()(double                    ) const { return true; }
     bool operator()(const std::string         ) const { return true; }
     bool operator()(const varlisp::Builtin&   ) const { return true; }
+    bool operator()(const varlisp::LazySeq&   ) const { return true; }
+    bool operator()(const varlisp::Dict&      ) const { return true; }
+    bool operator()(const varlisp::StringBuilder&) const { return true; }
+    bool operator()(const varlisp::RegexSet&) const { return true; }
 };
 }  // namespace varlisp
 
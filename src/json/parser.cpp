@@ -1,5 +1,6 @@
 #include "parser.hpp"
 
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
 
@@ -96,16 +97,16 @@ struct LispHandle
     {
         if (m_stack_obj.empty()) {
             m_stack_obj.push_back(&m_result);
-            (*m_stack_obj.back()) = varlisp::Environment();
+            (*m_stack_obj.back()) = varlisp::Dict();
         }
         else {
             if (m_kv_value != nullptr) {
-                *m_kv_value = varlisp::Environment();
+                *m_kv_value = varlisp::Dict();
                 m_stack_obj.push_back(m_kv_value);
                 m_kv_value = nullptr;
             }
             else if (m_list != nullptr){
-                m_list->append(varlisp::Environment());
+                m_list->append(varlisp::Dict());
                 m_stack_obj.push_back(&m_list->nth(m_list->size() - 1));
             }
             else {
@@ -117,9 +118,9 @@ struct LispHandle
     bool Key(sss::string_view s)
     {
         std::string name = s.to_string();
-        auto *p_env = boost::get<varlisp::Environment>(m_stack_obj.back());
-        p_env->operator[](name) = Nill{};
-        m_kv_value = &p_env->operator[](name);
+        auto *p_dict = boost::get<varlisp::Dict>(m_stack_obj.back());
+        m_kv_value = &p_dict->operator[](name);
+        *m_kv_value = Nill{};
         return true;
     }
 
@@ -163,7 +164,13 @@ struct LispHandle
 struct JParser
 {
     sss::json::Parser m_p;
-    JParser(sss::string_view s, Object& ret)
+    const std::vector<std::string>* m_fields = nullptr;
+    int m_depth = 0;
+    bool m_intern = false;
+
+    JParser(sss::string_view s, Object& ret, const std::vector<std::string>* fields = nullptr,
+            bool intern = false)
+        : m_fields(fields), m_intern(intern)
     {
         sss::string_view s_bak = s;
         try {
@@ -221,7 +228,14 @@ struct JParser
             {
                 std::string str;
                 this->parse_string(s, str);
-                ret = varlisp::string_t(str);
+                varlisp::string_t value;
+                if (m_intern) {
+                    value = varlisp::string_t::intern(str);
+                }
+                else {
+                    value = std::move(str);
+                }
+                ret = std::move(value);
             }
             break;
 
@@ -251,10 +265,78 @@ struct JParser
         m_p.consumeWhiteSpace(s);
     }
 
+    bool is_projected(const std::string& key) const
+    {
+        return m_depth != 1 || m_fields == nullptr ||
+               std::find(m_fields->begin(), m_fields->end(), key) != m_fields->end();
+    }
+
+    // 跳过一个json值(含嵌套的{}、[])；不做完整性校验
+    void skip_value(sss::string_view& s)
+    {
+        int depth = 0;
+        while (!s.empty()) {
+            switch (s.front()) {
+                case '"':
+                    this->skip_string(s);
+                    if (depth == 0) {
+                        return;
+                    }
+                    continue;
+
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+
+                case '}':
+                case ']':
+                    if (depth == 0) {
+                        return;
+                    }
+                    --depth;
+                    if (depth == 0) {
+                        s.pop_front();
+                        return;
+                    }
+                    break;
+
+                case ',':
+                    if (depth == 0) {
+                        return;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+            s.pop_front();
+        }
+    }
+
+    void skip_string(sss::string_view& s)
+    {
+        this->consume_or_throw(s, '"', "expect '\"'");
+        while (!s.empty()) {
+            char c = s.front();
+            s.pop_front();
+            if (c == '\\') {
+                if (!s.empty()) {
+                    s.pop_front();
+                }
+            }
+            else if (c == '"') {
+                return;
+            }
+        }
+        SSS_POSITION_THROW(std::runtime_error, "enconter: eof; expect '\"'");
+    }
+
     void parse_object(sss::string_view& s, Object& ret)
     {
         this->consume_or_throw(s, '{', "expect '{'");
-        varlisp::Environment env;
+        ++m_depth;
+        varlisp::Dict dict;
         bool is_first = true;
         while (!s.empty() && s.front() != '}') {
             if (is_first) {
@@ -269,19 +351,29 @@ struct JParser
             this->parse_string(s, key);
             this->skip_white_space(s);
             this->consume_or_throw(s, ':', "expect ':'");
-            Object val;
             this->skip_white_space(s);
+            if (!this->is_projected(key)) {
+                this->skip_value(s);
+                this->skip_white_space(s);
+                continue;
+            }
+            Object val;
             this->parse_value(s, val);
-            env[key] = std::move(val);
+            // NOTE 驻留模式下，键也取自驻留池：大量同构对象的长键名共享同一缓冲区
+            dict.insert(m_intern ? varlisp::string_t::intern(key)
+                                 : varlisp::string_t(std::move(key)),
+                        std::move(val));
             this->skip_white_space(s);
         }
         this->consume_or_throw(s, '}', "expect '}'");
-        ret = std::move(env);
+        --m_depth;
+        ret = std::move(dict);
     }
 
     void parse_array(sss::string_view& s, Object& ret)
     {
         this->consume_or_throw(s, '[', "expect '['");
+        ++m_depth;
         varlisp::List list = varlisp::List::makeSQuoteList();
         auto back_it = varlisp::detail::list_back_inserter<varlisp::Object>(list);
         bool is_first = true;
@@ -301,6 +393,7 @@ struct JParser
             this->skip_white_space(s);
         }
         this->consume_or_throw(s, ']', "expect ']'");
+        --m_depth;
         ret = std::move(list);
     }
 
@@ -370,10 +463,17 @@ struct JParser
     }
 };
 
-Object parse(sss::string_view s)
+Object parse(sss::string_view s, bool intern)
+{
+    Object ret;
+    JParser jp(s, ret, nullptr, intern);
+    return ret;
+}
+
+Object parse(sss::string_view s, const std::vector<std::string>& fields)
 {
     Object ret;
-    JParser jp(s, ret);
+    JParser jp(s, ret, &fields);
     return ret;
 }
 
@@ -1,15 +1,23 @@
 #pragma once
 
 // 目的，从sss::string_view中，解析出来，并构造成varlisp中的对象；
-// 入口有两个，分别是env和list；
+// 入口有两个，分别是dict和list；
 //
 
+#include <string>
+#include <vector>
+
 #include "../object.hpp"
 
 #include <sss/string_view.hpp>
 
 namespace varlisp {
 namespace json {
-Object parse(sss::string_view s);
+// intern为true时，字符串值取自String的驻留池；适合大量重复的枚举值
+Object parse(sss::string_view s, bool intern = false);
+
+// 投影解析：仅针对最外层的对象，只解码fields中列出的键；
+// 其余键对应的值，只做词法上的跳过，不构造对象。
+Object parse(sss::string_view s, const std::vector<std::string>& fields);
 } // namespace json
 } // namespace varlisp
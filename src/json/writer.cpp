@@ -0,0 +1,386 @@
+#include "writer.hpp"
+
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <sss/util/PostionThrow.hpp>
+
+#include "../String.hpp"
+#include "../dict.hpp"
+#include "../environment.hpp"
+#include "../list.hpp"
+#include "../symbol.hpp"
+#include "../detail/json.hpp"
+
+namespace varlisp {
+namespace json {
+
+namespace {
+
+// 需要转义的字节：控制字符、'"'、'\\'；
+// 其余(包括utf8多字节序列)原样输出
+struct escape_table_t
+{
+    std::array<char, 256> m_tab{};
+    escape_table_t()
+    {
+        for (int i = 0; i < 0x20; ++i) {
+            m_tab[i] = 'u';
+        }
+        m_tab['\b'] = 'b';
+        m_tab['\f'] = 'f';
+        m_tab['\n'] = 'n';
+        m_tab['\r'] = 'r';
+        m_tab['\t'] = 't';
+        m_tab['"']  = '"';
+        m_tab['\\'] = '\\';
+    }
+    char operator[](char c) const
+    {
+        return m_tab[static_cast<unsigned char>(c)];
+    }
+};
+
+const escape_table_t& escape_table()
+{
+    static escape_table_t tab;
+    return tab;
+}
+
+struct estimate_visitor : public boost::static_visitor<size_t>
+{
+    size_t m_indent_width;
+    int    m_depth;
+    estimate_visitor(size_t indent_width, int depth)
+        : m_indent_width(indent_width), m_depth(depth)
+    {
+    }
+
+    template <typename T>
+    size_t operator()(const T& /*v*/) const
+    {
+        return 16;
+    }
+
+    size_t operator()(const Empty&) const { return 0; }
+    size_t operator()(const Nill&) const { return 4; }
+    size_t operator()(bool) const { return 5; }
+    size_t operator()(int64_t) const { return 8; }
+    size_t operator()(double) const { return 16; }
+    size_t operator()(const string_t& v) const
+    {
+        // 引号，外加少量转义余量
+        return v.size() + v.size() / 16 + 2;
+    }
+    size_t operator()(const varlisp::symbol& s) const
+    {
+        return s.name().size() + 2;
+    }
+    size_t operator()(const varlisp::List& s) const
+    {
+        const List * p_tail = &s;
+        if (s.is_quoted()) {
+            p_tail = boost::get<varlisp::List>(&s.nth(1));
+            if (!p_tail) {
+                return boost::apply_visitor(*this, s.nth(1));
+            }
+        }
+        size_t sum = 2;
+        estimate_visitor inner(m_indent_width, m_depth + 1);
+        for (auto it = p_tail->begin(); it != p_tail->end(); ++it) {
+            sum += 1 + this->item_overhead() + boost::apply_visitor(inner, *it);
+        }
+        return sum;
+    }
+    size_t operator()(const varlisp::Environment& s) const
+    {
+        size_t sum = 2;
+        estimate_visitor inner(m_indent_width, m_depth + 1);
+        for (auto it = s.begin(); it != s.end(); ++it) {
+            sum += 4 + it->first.size() + this->item_overhead() +
+                   boost::apply_visitor(inner, it->second.first);
+        }
+        return sum;
+    }
+    size_t operator()(const varlisp::Dict& s) const
+    {
+        size_t sum = 2;
+        estimate_visitor inner(m_indent_width, m_depth + 1);
+        for (auto it = s.begin(); it != s.end(); ++it) {
+            sum += 4 + it->first.size() + this->item_overhead() +
+                   boost::apply_visitor(inner, it->second);
+        }
+        return sum;
+    }
+    size_t item_overhead() const
+    {
+        return m_indent_width != 0U ? 1 + m_indent_width * (m_depth + 1) : 0;
+    }
+};
+
+// Environment的值，带有property_t；Dict则没有
+const Object& item_value(const Object& v)
+{
+    return v;
+}
+
+const Object& item_value(const std::pair<Object, property_t>& v)
+{
+    return v.first;
+}
+
+}  // namespace
+
+size_t& Writer::default_chunk_size()
+{
+    static size_t chunk_size = 64 * 1024;
+    return chunk_size;
+}
+
+Writer::Writer(bool indent)
+    : m_indent(indent)
+{
+}
+
+Writer::Writer(int fd, bool indent, size_t chunk_size)
+    : m_fd(fd),
+      m_chunk_size(chunk_size != 0U ? chunk_size : default_chunk_size()),
+      m_indent(indent)
+{
+    // NOTE 单个字符串可能超出chunk_size；故多留一些余量
+    m_buf.reserve(m_chunk_size + m_chunk_size / 4);
+}
+
+void Writer::write(const Object& obj)
+{
+    if (m_fd < 0) {
+        m_buf.reserve(m_buf.size() + estimate_size(obj, m_indent));
+    }
+    boost::apply_visitor(*this, obj);
+}
+
+void Writer::flush()
+{
+    if (m_fd < 0) {
+        return;
+    }
+    const char * p_data = m_buf.data();
+    size_t left = m_buf.size();
+    while (left != 0U) {
+        auto ec = ::write(m_fd, p_data, left);
+        if (ec == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SSS_POSITION_THROW(std::runtime_error,
+                               "json write fd ", m_fd, " failed: ",
+                               std::strerror(errno));
+        }
+        p_data += ec;
+        left -= ec;
+        m_written += ec;
+    }
+    m_buf.clear();
+}
+
+void Writer::may_flush()
+{
+    if (m_fd >= 0 && m_buf.size() >= m_chunk_size) {
+        this->flush();
+    }
+}
+
+void Writer::write_newline_indent()
+{
+    if (!m_indent) {
+        return;
+    }
+    m_buf += '\n';
+    const std::string& indent = varlisp::detail::json::get_json_indent();
+    for (int i = 0; i < m_depth; ++i) {
+        m_buf += indent;
+    }
+}
+
+void Writer::write_string(sss::string_view s)
+{
+    const auto& tab = escape_table();
+    m_buf += '"';
+    const char * p_run = s.data();
+    const char * p_end = s.data() + s.size();
+    for (const char * p = p_run; p != p_end; ++p) {
+        const char esc = tab[*p];
+        if (esc == 0) {
+            continue;
+        }
+        m_buf.append(p_run, p - p_run);
+        m_buf += '\\';
+        if (esc == 'u') {
+            static const char * hex = "0123456789abcdef";
+            const auto c = static_cast<unsigned char>(*p);
+            m_buf += "u00";
+            m_buf += hex[c >> 4];
+            m_buf += hex[c & 0x0F];
+        }
+        else {
+            m_buf += esc;
+        }
+        p_run = p + 1;
+    }
+    m_buf.append(p_run, p_end - p_run);
+    m_buf += '"';
+    this->may_flush();
+}
+
+void Writer::operator()(const Nill&)
+{
+    m_buf += "null";
+}
+
+void Writer::operator()(bool v)
+{
+    m_buf += (v ? "true" : "false");
+}
+
+void Writer::operator()(int64_t v)
+{
+    char digits[24];
+    auto res = std::to_chars(digits, digits + sizeof(digits), v);
+    m_buf.append(digits, res.ptr - digits);
+}
+
+void Writer::operator()(double v)
+{
+    // NOTE json不支持inf,nan
+    if (!std::isfinite(v)) {
+        m_buf += "null";
+        return;
+    }
+    // 与json_print_visitor(std::ostream默认精度)一致：%g，6位有效数字
+    char digits[32];
+    auto res = std::to_chars(digits, digits + sizeof(digits), v,
+                             std::chars_format::general, 6);
+    m_buf.append(digits, res.ptr - digits);
+}
+
+void Writer::operator()(const varlisp::regex_t& reg)
+{
+    if (!reg) {
+        SSS_POSITION_THROW(std::runtime_error, "null regex-obj");
+    }
+    m_buf += '/';
+    m_buf += reg->pattern();
+    m_buf += '/';
+}
+
+void Writer::operator()(const string_t& v)
+{
+    this->write_string(v.to_string_view());
+}
+
+void Writer::operator()(const varlisp::symbol& s)
+{
+    this->write_string(s.name());
+}
+
+void Writer::operator()(const varlisp::List& s)
+{
+    const List * p_tail = &s;
+    if (s.is_quoted()) {
+        p_tail = boost::get<varlisp::List>(&s.nth(1));
+        if (!p_tail) {
+            // (quote 字面值)
+            boost::apply_visitor(*this, s.nth(1));
+            return;
+        }
+    }
+    m_buf += '[';
+    if (p_tail->size()) {
+        bool is_first = true;
+        ++m_depth;
+        for (auto it = p_tail->begin(); it != p_tail->end(); ++it) {
+            if (is_first) {
+                is_first = false;
+            }
+            else {
+                m_buf += ',';
+            }
+            this->write_newline_indent();
+            boost::apply_visitor(*this, *it);
+        }
+        --m_depth;
+        this->write_newline_indent();
+    }
+    m_buf += ']';
+    this->may_flush();
+}
+
+template <typename IterT>
+void Writer::write_object(IterT beg, IterT end, bool is_empty)
+{
+    m_buf += '{';
+    if (!is_empty) {
+        bool is_first = true;
+        ++m_depth;
+        for (auto it = beg; it != end; ++it) {
+            if (is_first) {
+                is_first = false;
+            }
+            else {
+                m_buf += ',';
+            }
+            this->write_newline_indent();
+            this->write_string(it->first);
+            m_buf += ':';
+            if (m_indent) {
+                m_buf += ' ';
+            }
+            boost::apply_visitor(*this, item_value(it->second));
+        }
+        --m_depth;
+        this->write_newline_indent();
+    }
+    m_buf += '}';
+    this->may_flush();
+}
+
+void Writer::operator()(const varlisp::Environment& s)
+{
+    this->write_object(s.begin(), s.end(), s.empty());
+}
+
+void Writer::operator()(const varlisp::Dict& s)
+{
+    this->write_object(s.begin(), s.end(), s.empty());
+}
+
+size_t estimate_size(const Object& obj, bool indent)
+{
+    const size_t indent_width =
+        indent ? varlisp::detail::json::get_json_indent().size() : 0;
+    return boost::apply_visitor(estimate_visitor(indent_width, 0), obj);
+}
+
+std::string to_string(const Object& obj, bool indent)
+{
+    Writer w(indent);
+    w.write(obj);
+    return std::move(w.buffer());
+}
+
+int64_t write_fd(int fd, const Object& obj, bool indent)
+{
+    Writer w(fd, indent);
+    w.write(obj);
+    w.flush();
+    return w.written();
+}
+
+} // namespace json
+} // namespace varlisp
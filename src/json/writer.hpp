@@ -0,0 +1,100 @@
+#pragma once
+
+// 直接写入内存缓冲区的json序列化器；
+// 与json_print_visitor输出格式一致，但不经过std::ostream：
+//  - 数值用std::to_chars格式化；
+//  - 字符串按"无需转义"的连续区间，整段追加；
+//  - 事先估算输出大小，一次性reserve；
+//  - 可指定fd，缓冲区满chunk_size字节即写出，用于超大输出。
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include <boost/variant.hpp>
+
+#include <sss/string_view.hpp>
+
+#include "../object.hpp"
+
+namespace varlisp {
+namespace json {
+
+class Writer : public boost::static_visitor<void>
+{
+public:
+    explicit Writer(bool indent = false);
+    Writer(int fd, bool indent, size_t chunk_size = default_chunk_size());
+    ~Writer() = default;
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+public:
+    void write(const Object& obj);
+
+    // fd模式下，写出缓冲区中剩余的数据；内存模式下，什么也不做
+    void flush();
+
+    std::string& buffer()
+    {
+        return m_buf;
+    }
+
+    // fd模式下，已经写出到fd的字节数
+    int64_t written() const
+    {
+        return m_written;
+    }
+
+    static size_t& default_chunk_size();
+
+public:
+    template <typename T>
+    void operator()(const T& v)
+    {
+        // NOTE 针对无法与json格式一一对应的类型，全部转换为字符串。
+        std::ostringstream oss;
+        oss << v;
+        this->write_string(oss.str());
+    }
+
+    void operator()(const Empty&                  ) { }
+    void operator()(const Nill&                   );
+    void operator()(bool v                        );
+    void operator()(int64_t v                     );
+    void operator()(double v                      );
+    void operator()(const varlisp::regex_t& reg   );
+    void operator()(const string_t& v             );
+    void operator()(const varlisp::symbol& s      );
+    void operator()(const varlisp::List& s        );
+    void operator()(const varlisp::Environment& s );
+    void operator()(const varlisp::Dict& s        );
+
+private:
+    template <typename IterT>
+    void write_object(IterT beg, IterT end, bool is_empty);
+    void write_string(sss::string_view s);
+    void write_newline_indent();
+    void may_flush();
+
+private:
+    std::string m_buf;
+    int         m_fd = -1;
+    size_t      m_chunk_size = 0;
+    int64_t     m_written = 0;
+    bool        m_indent = false;
+    int         m_depth = 0;
+};
+
+// 估算序列化之后的字节数；仅用于预分配，不保证精确
+size_t estimate_size(const Object& obj, bool indent);
+
+std::string to_string(const Object& obj, bool indent = false);
+
+// 分块写出到fd；返回写出的字节数
+int64_t write_fd(int fd, const Object& obj, bool indent = false);
+
+} // namespace json
+} // namespace varlisp
@@ -8,6 +8,7 @@
 #include "symbol.hpp"
 #include "list.hpp"
 #include "environment.hpp"
+#include "dict.hpp"
 #include "print_visitor.hpp"
 #include "detail/list_iterator.hpp"
 #include "detail/json.hpp"
@@ -125,4 +126,30 @@ void json_print_visitor::operator()(const varlisp::Environment& s) const
     m_o << '}';
 }
 
+void json_print_visitor::operator()(const varlisp::Dict& s) const
+{
+    m_o << '{';
+    if (!s.empty()) {
+        bool is_first = true;
+        Indent inner(m_indent);
+        IndentHelper ind(inner);
+        for (const auto& item : s) {
+            if (is_first) {
+                is_first = false;
+            }
+            else {
+                m_o << ",";
+            }
+            m_o << m_indent.endl() << inner;
+            m_o << sss::raw_string(item.first.to_string()) << ":";
+            if (m_indent.enable()) {
+                m_o <<" ";
+            }
+            boost::apply_visitor(json_print_visitor(m_o, inner), item.second);
+        }
+        m_o << m_indent.endl() << m_indent;
+    }
+    m_o << '}';
+}
+
 } // namespace varlisp
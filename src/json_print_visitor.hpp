@@ -13,6 +13,7 @@ struct symbol;
 struct List;
 struct String;
 struct Environment;
+struct Dict;
 typedef String string_t;
 
 struct json_print_visitor : public boost::static_visitor<void> {
@@ -95,6 +96,7 @@ struct json_print_visitor : public boost::static_visitor<void> {
     void operator()(const varlisp::symbol& s      ) const ;
     void operator()(const varlisp::List& s        ) const ;
     void operator()(const varlisp::Environment& s ) const ;
+    void operator()(const varlisp::Dict& s        ) const ;
 };
 
 inline std::ostream& operator << (std::ostream& o, const json_print_visitor::Indent& i)
@@ -52,6 +52,14 @@ public:
     {
         return this->m_help_doc;
     }
+    const std::vector<std::string>& args() const
+    {
+        return this->m_args;
+    }
+    const std::vector<Object>& body() const
+    {
+        return this->m_body;
+    }
 
     varlisp::string_t gen_help_msg(const std::string& name) const;
 };
@@ -0,0 +1,33 @@
+#include "lazy_seq.hpp"
+
+#include <iostream>
+
+namespace varlisp {
+
+bool LazySeq::next(Object& out) const
+{
+    if (this->is_done()) {
+        return false;
+    }
+    if (!m_gen->next(out)) {
+        // NOTE 生成器耗尽之后，不再调用它；以免底层fd已经被关闭的情况下，
+        // 再次读取。
+        *m_done = true;
+        return false;
+    }
+    return true;
+}
+
+void LazySeq::print(std::ostream& o) const
+{
+    o << "#<lazy-seq:";
+    if (m_gen) {
+        m_gen->print(o);
+    }
+    if (this->is_done()) {
+        o << ":done";
+    }
+    o << ">";
+}
+
+}  // namespace varlisp
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+
+#include "object.hpp"
+
+namespace varlisp {
+
+struct Environment;
+
+// LazySeq 惰性序列
+// 元素由内部的生成器，按需逐个产生；用于遍历大文件等无法(或不必)一次性
+// 物化为List的数据源。
+//
+// NOTE 只能遍历一遍；拷贝LazySeq对象，只是共享同一个生成器——也就共享了
+// 遍历进度。这与List的"值"语义不同。
+struct LazySeq {
+    struct generator_t {
+        virtual ~generator_t() = default;
+        // 产生下一个元素；返回false表示已经耗尽
+        virtual bool next(Object& out) = 0;
+        virtual void print(std::ostream& o) const = 0;
+    };
+
+    LazySeq() = default;
+    explicit LazySeq(std::shared_ptr<generator_t> gen)
+        : m_gen(std::move(gen)), m_done(std::make_shared<bool>(false))
+    {
+    }
+    ~LazySeq() = default;
+
+    LazySeq(const LazySeq&) = default;
+    LazySeq& operator=(const LazySeq&) = default;
+
+    LazySeq(LazySeq&&) = default;
+    LazySeq& operator=(LazySeq&&) = default;
+
+public:
+    bool next(Object& out) const;
+
+    bool is_done() const
+    {
+        return !m_gen || *m_done;
+    }
+
+    Object eval(Environment& /*env*/) const
+    {
+        return *this;
+    }
+
+    void print(std::ostream& o) const;
+
+    bool operator==(const LazySeq& rhs) const
+    {
+        return this->m_gen == rhs.m_gen;
+    }
+
+    bool operator<(const LazySeq& rhs) const
+    {
+        return this->m_gen < rhs.m_gen;
+    }
+
+private:
+    std::shared_ptr<generator_t>  m_gen;
+    std::shared_ptr<bool>         m_done;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const LazySeq& s)
+{
+    s.print(o);
+    return o;
+}
+
+}  // namespace varlisp
@@ -42,6 +42,10 @@ struct Cond;
 struct LogicAnd;
 struct LogicOr;
 struct Environment;
+struct LazySeq;
+struct Dict;
+struct StringBuilder;
+struct RegexSet;
 
 // struct String;
 using string_t = ::varlisp::String;
@@ -69,7 +73,11 @@ using Object = boost::variant<
     // NOTE
     // quote-list只是作为一种函数存在！
     boost::recursive_wrapper<Lambda>,       // 17
-    boost::recursive_wrapper<Environment>   // 18
+    boost::recursive_wrapper<Environment>,  // 18
+    boost::recursive_wrapper<LazySeq>,      // 19
+    boost::recursive_wrapper<Dict>,         // 20
+    boost::recursive_wrapper<StringBuilder>,// 21
+    boost::recursive_wrapper<RegexSet>      // 22
     >;
 
 Object apply(Environment& env, const Object& funcObj, const List& args);
@@ -79,12 +87,16 @@ Object apply(Environment& env, const Object& funcObj, const List& args);
 #include "Define.hpp"
 #include "builtin.hpp"
 #include "condition.hpp"
+#include "dict.hpp"
 #include "environment.hpp"
 #include "ifexpr.hpp"
 #include "lambda.hpp"
+#include "lazy_seq.hpp"
 #include "list.hpp"
 #include "logic_and.hpp"
 #include "logic_or.hpp"
+#include "regex_set.hpp"
+#include "string_builder.hpp"
 
 #include "print_visitor.hpp"
 
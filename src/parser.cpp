@@ -100,7 +100,6 @@ int Parser::parse(varlisp::Environment& env, const std::string& raw_scripts,
         // std::cout << "Parser::" << __func__ << "(\"" << scripts << "\")" <<
         // std::endl;
 
-        bool is_balance = true;
         bool do_echo = true;
         sss::string_view ss {raw_scripts};
         sss::trim(ss);
@@ -119,6 +118,77 @@ int Parser::parse(varlisp::Environment& env, const std::string& raw_scripts,
         // std::string scripts = "(list 12.5 abc 1.2 #f #t xy-z \"123\" )";
         m_toknizer.append(scripts);
 
+        return this->parse_loop(env, is_silent, do_echo, parsed_hook_t());
+    }
+    catch (const ss1x::parser::ErrorPosition& e) {
+        std::cout << e.what() << std::endl;
+        this->m_toknizer.clear();
+        return -1;
+    }
+}
+
+int Parser::parse_view(varlisp::Environment& env, sss::string_view scripts,
+                       bool is_silent, const parsed_hook_t& on_parsed)
+{
+    SSS_LOG_FUNC_TRACE(sss::log::log_DEBUG);
+    SSS_LOG_EXPRESSION(sss::log::log_DEBUG, scripts.size());
+
+    bool do_echo = true;
+    sss::trim(scripts);
+    if (scripts.empty()) {
+        return 1;
+    }
+    if (scripts.front() == '@') {
+        do_echo = false;
+        scripts.pop_front();
+    }
+
+    // NOTE 独立的一帧；嵌套load时，互不干扰；残留的不完整语句，随帧丢弃
+    struct view_frame_guard_t {
+        Tokenizer& m_tz;
+        view_frame_guard_t(Tokenizer& tz, sss::string_view data) : m_tz(tz)
+        {
+            m_tz.push_view(data);
+        }
+        ~view_frame_guard_t() { m_tz.pop(); }
+    } guard(m_toknizer, scripts);
+
+    return this->parse_loop(env, is_silent, do_echo, on_parsed);
+}
+
+int Parser::eval_exprs(varlisp::Environment& env,
+                       const std::vector<Object>& exprs, bool is_silent,
+                       bool do_echo)
+{
+    for (const auto& expr : exprs) {
+        try {
+            this->eval_expr(env, expr, is_silent, do_echo);
+        }
+        catch (std::runtime_error& e) {
+            std::cout << e.what() << std::endl;
+            return -1;
+        }
+    }
+    return 1;
+}
+
+void Parser::eval_expr(varlisp::Environment& env, const Object& expr,
+                       bool is_silent, bool do_echo)
+{
+    Object result;
+    const Object& res = varlisp::getAtomicValue(env, expr, result); // varlisp::getAtomicValueUnquote(env, expr, result);
+    if (!is_silent && do_echo) {
+        boost::apply_visitor(print_visitor(std::cout), res);
+        std::cout << std::endl;
+    }
+    env["_"] = result;
+}
+
+int Parser::parse_loop(varlisp::Environment& env, bool is_silent, bool do_echo,
+                       const parsed_hook_t& on_parsed)
+{
+    try {
+        bool is_balance = true;
         while (is_balance && m_toknizer.top().which() != 0) {
             try {
                 if (!this->balance_preread()) {
@@ -137,13 +207,10 @@ int Parser::parse(varlisp::Environment& env, const std::string& raw_scripts,
                 // 这个需求来说，我只需要特化eval_eval函数即可，不用特意修改。
                 COLOG_TRIGER_DEBUG(expr);
 
-                Object result;
-                const Object& res = varlisp::getAtomicValue(env, expr, result); // varlisp::getAtomicValueUnquote(env, expr, result);
-                if (!is_silent && do_echo) {
-                    boost::apply_visitor(print_visitor(std::cout), res);
-                    std::cout << std::endl;
+                if (on_parsed) {
+                    on_parsed(expr);
                 }
-                env["_"] = result;
+                this->eval_expr(env, expr, is_silent, do_echo);
             }
             catch (std::runtime_error& e) {
                 std::cout << e.what() << std::endl;
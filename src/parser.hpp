@@ -1,8 +1,10 @@
 #ifndef __PARSER_HPP_1457164471__
 #define __PARSER_HPP_1457164471__
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tokenizer.hpp"
 #include "object.hpp"
@@ -40,6 +42,18 @@ public:
     int parse(varlisp::Environment& env, const std::string& scripts,
               bool is_silent = false);
 
+    // 同parse()；不过scripts以只读视图的方式，压入独立的Tokenizer帧，
+    // 解析完毕后弹出；scripts须在调用期间有效(比如mmap的脚本文件)。
+    // on_parsed非空时，每解析出一条语句，先回调它，再求值(供ast缓存用)。
+    typedef std::function<void(const Object&)> parsed_hook_t;
+    int parse_view(varlisp::Environment& env, sss::string_view scripts,
+                   bool is_silent = false,
+                   const parsed_hook_t& on_parsed = parsed_hook_t());
+
+    // 依次求值已经解析好的语句；不经过Tokenizer
+    int eval_exprs(varlisp::Environment& env, const std::vector<Object>& exprs,
+                   bool is_silent = false, bool do_echo = true);
+
     int retrieve_symbols(std::vector<std::string>& symbols,
                          const char* prefix) const;
 
@@ -51,6 +65,11 @@ public:
     bool balance_preread();
 
 protected:
+    int parse_loop(varlisp::Environment& env, bool is_silent, bool do_echo,
+                   const parsed_hook_t& on_parsed);
+    void eval_expr(varlisp::Environment& env, const Object& expr,
+                   bool is_silent, bool do_echo);
+
     // 空白和括弧，是不纳入结构的！
     // 所谓的Token，不包括空白和括弧；
     // 它包括：
@@ -0,0 +1,52 @@
+#include "regex_set.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "detail/regex_cache.hpp"
+
+namespace varlisp {
+
+RegexSet::RegexSet(const std::vector<std::string>& patterns, uint32_t flags)
+{
+    auto set = std::make_shared<RE2::Set>(detail::regex_cache::make_options(flags),
+                                          RE2::UNANCHORED);
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        std::string error;
+        if (set->Add(patterns[i], &error) < 0) {
+            throw std::runtime_error("regex-set pattern " + std::to_string(i) + " `" +
+                                     patterns[i] + "`: " + error);
+        }
+    }
+    if (!set->Compile()) {
+        throw std::runtime_error("regex-set: compile failed; out of memory");
+    }
+    m_set = std::move(set);
+    m_patterns = std::make_shared<const std::vector<std::string>>(patterns);
+}
+
+bool RegexSet::match(sss::string_view text, std::vector<int>& ids) const
+{
+    ids.clear();
+    if (!m_set || m_patterns->empty()) {
+        return false;
+    }
+    if (!m_set->Match(re2::StringPiece(text.data(), text.size()), &ids)) {
+        return false;
+    }
+    // NOTE RE2::Set::Match()返回的下标无序
+    std::sort(ids.begin(), ids.end());
+    return true;
+}
+
+void RegexSet::print(std::ostream& o) const
+{
+    o << "#<regex-set";
+    for (size_t i = 0; i < this->size(); ++i) {
+        o << " /" << (*m_patterns)[i] << '/';
+    }
+    o << '>';
+}
+
+}  // namespace varlisp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sss/string_view.hpp>
+
+#include <re2/set.h>
+
+#include "object.hpp"
+
+namespace varlisp {
+
+struct Environment;
+
+// RegexSet 多个正则组成的集合；基于RE2::Set，一次扫描得到所有匹配的pattern。
+//
+// 编译后不可修改；Object的各个副本共享同一个RE2::Set。
+struct RegexSet {
+    RegexSet() = default;
+    // 编译失败时，抛出std::runtime_error，并指明是第几个pattern
+    RegexSet(const std::vector<std::string>& patterns, uint32_t flags);
+
+    ~RegexSet() = default;
+
+    RegexSet(const RegexSet&) = default;
+    RegexSet& operator=(const RegexSet&) = default;
+
+    RegexSet(RegexSet&&) = default;
+    RegexSet& operator=(RegexSet&&) = default;
+
+public:
+    size_t size() const { return m_patterns ? m_patterns->size() : 0; }
+
+    const std::string& pattern(size_t i) const { return m_patterns->at(i); }
+
+    // 匹配的pattern下标，升序；结果放入ids(先清空)
+    bool match(sss::string_view text, std::vector<int>& ids) const;
+
+    Object eval(Environment& /*env*/) const
+    {
+        return *this;
+    }
+
+    void print(std::ostream& o) const;
+
+    // 按身份比较
+    bool operator==(const RegexSet& rhs) const
+    {
+        return m_set == rhs.m_set;
+    }
+    bool operator<(const RegexSet& rhs) const
+    {
+        return std::owner_less<std::shared_ptr<const RE2::Set>>()(m_set, rhs.m_set);
+    }
+
+private:
+    std::shared_ptr<const RE2::Set>                 m_set;
+    std::shared_ptr<const std::vector<std::string>> m_patterns;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const RegexSet& rs)
+{
+    rs.print(o);
+    return o;
+}
+
+}  // namespace varlisp
@@ -0,0 +1,36 @@
+#include "string_builder.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace varlisp {
+
+StringBuilder::StringBuilder(size_t capacity)
+    : m_buf(std::make_shared<std::string>())
+{
+    m_buf->reserve(capacity);
+}
+
+void StringBuilder::reserve_more(size_t n) const
+{
+    const size_t need = m_buf->size() + n;
+    if (need > m_buf->capacity()) {
+        m_buf->reserve(std::max(need, m_buf->capacity() * 2));
+    }
+}
+
+string_t StringBuilder::freeze() const
+{
+    // NOTE String::operator=(std::string&&) 移动缓冲区，内容不复制
+    string_t ret;
+    ret = std::move(*m_buf);
+    m_buf->clear();
+    return ret;
+}
+
+void StringBuilder::print(std::ostream& o) const
+{
+    o.write(m_buf->data(), m_buf->size());
+}
+
+}  // namespace varlisp
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+#include <sss/string_view.hpp>
+
+#include "object.hpp"
+
+namespace varlisp {
+
+struct Environment;
+
+// StringBuilder 可变字符串；用于拼接大段输出(报表等)。
+//
+// 缓冲区由shared_ptr持有，Object的各个副本共享同一缓冲区——即引用语义，
+// sb-append 修改的就是 define 出来的那个对象；追加按几何增长分摊。
+// freeze() 将缓冲区整体移交给String(不复制内容)，之后builder变为空。
+struct StringBuilder {
+    StringBuilder() : m_buf(std::make_shared<std::string>()) {}
+    explicit StringBuilder(size_t capacity);
+
+    ~StringBuilder() = default;
+
+    StringBuilder(const StringBuilder&) = default;
+    StringBuilder& operator=(const StringBuilder&) = default;
+
+    StringBuilder(StringBuilder&&) = default;
+    StringBuilder& operator=(StringBuilder&&) = default;
+
+public:
+    std::string& buffer() const { return *m_buf; }
+
+    size_t size() const { return m_buf->size(); }
+    bool empty() const { return m_buf->empty(); }
+
+    sss::string_view to_string_view() const
+    {
+        return {m_buf->data(), m_buf->size()};
+    }
+
+    void append(sss::string_view s) const
+    {
+        m_buf->append(s.data(), s.size());
+    }
+
+    // 确保还能再容纳n字节；不足时至少翻倍，避免逐次按需reserve导致的反复复制
+    void reserve_more(size_t n) const;
+
+    string_t freeze() const;
+
+    Object eval(Environment& /*env*/) const
+    {
+        return *this;
+    }
+
+    // 原样输出内容
+    void print(std::ostream& o) const;
+
+    // 按身份比较：是否同一个缓冲区
+    bool operator==(const StringBuilder& rhs) const
+    {
+        return m_buf == rhs.m_buf;
+    }
+    bool operator<(const StringBuilder& rhs) const
+    {
+        return std::owner_less<std::shared_ptr<std::string>>()(m_buf, rhs.m_buf);
+    }
+
+private:
+    std::shared_ptr<std::string> m_buf;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const StringBuilder& sb)
+{
+    sb.print(o);
+    return o;
+}
+
+namespace detail {
+
+// 直接追加到std::string末尾的streambuf；
+// 供format、io-print等，不经过std::ostringstream，直接输出到builder
+class string_append_buf : public std::streambuf
+{
+public:
+    explicit string_append_buf(std::string& out) : m_out(out) {}
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            m_out += traits_type::to_char_type(ch);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override
+    {
+        m_out.append(s, n);
+        return n;
+    }
+
+private:
+    std::string& m_out;
+};
+
+} // namespace detail
+
+}  // namespace varlisp
@@ -55,6 +55,8 @@ bool & tokenizer_colog_switch()
 #include <ss1x/parser/oparser.hpp>
 #include <ss1x/parser/util.hpp>
 
+#include "detail/token_scanner.hpp"
+
 namespace varlisp {
 Tokenizer::Tokenizer() { this->init(""); }
 Tokenizer::Tokenizer(const std::string& data) { this->init(data); }
@@ -359,6 +361,9 @@ void Tokenizer::init(const std::string& data)
 
     this->Token_p =
         (refer(Spaces_p) | refer(CommentMulty_p) | refer(Comment_p) |
+         // NOTE RawString_p 以'开头，须放在Quote_p之前，否则永远匹配不到；
+         // detail::scan_token 同此顺序。
+         refer(RawString_p) |
          refer(Quote_p) |
          refer(Binary_p) |
          refer(Hex_p) |
@@ -370,7 +375,6 @@ void Tokenizer::init(const std::string& data)
          refer(Regex_p) |
          refer(Parenthese_p) |
          refer(String_p) |
-         refer(RawString_p) |
          refer(Symbol_p) |
          refer(BoolTrue_p) | refer(BoolFalse_p) | refer(FallthrowError_p));
 
@@ -404,7 +408,7 @@ Token Tokenizer::lookahead_nothrow(int index)
         return Token();
     }
 
-    while (this->m_beg < this->m_end &&
+    while (!this->is_eof() &&
            int(this->m_tokens.back().size()) < index + 1) {
         if (!this->parse()) {
             break;
@@ -494,6 +498,13 @@ void Tokenizer::append(const std::string& scripts)
     if (scripts.empty()) {
         return;
     }
+    if (this->m_is_view.back()) {
+        // 视图帧追加内容，只能转为普通的字符串帧
+        this->m_data.back() = this->m_views.back().to_string();
+        this->m_views.back() = sss::string_view();
+        this->m_is_view.back() = false;
+        m_beg.back() = this->m_data.back().cbegin();
+    }
     if (!this->m_data.back().empty()) {
         size_t offset =
             std::distance(this->m_data.back().cbegin(), m_beg.back());
@@ -520,7 +531,13 @@ void Tokenizer::append(const std::string& scripts)
 size_t Tokenizer::tokens_size() const { return this->m_tokens.back().size(); }
 bool Tokenizer::is_eof() const
 {
-    return this->m_beg.empty() || this->m_beg.back() >= this->m_end.back();
+    if (this->m_beg.empty()) {
+        return true;
+    }
+    if (this->m_is_view.back()) {
+        return this->m_views.back().empty();
+    }
+    return this->m_beg.back() >= this->m_end.back();
 }
 
 void Tokenizer::push(const std::string& data)
@@ -536,9 +553,19 @@ void Tokenizer::push(const std::string& data)
     this->m_data.push_back(data);
     this->m_beg.push_back(this->m_data.back().begin());
     this->m_end.push_back(this->m_data.back().end());
+    this->m_views.push_back(sss::string_view());
+    this->m_is_view.push_back(false);
     this->m_tokens.push_back(std::vector<Token>());
 }
 
+void Tokenizer::push_view(sss::string_view data)
+{
+    COLOG_TRIGER_DEBUG("view size = ", data.size());
+    this->push();
+    this->m_views.back() = data;
+    this->m_is_view.back() = true;
+}
+
 void Tokenizer::pop()
 {
     COLOG_TRIGER_DEBUG("");
@@ -546,6 +573,8 @@ void Tokenizer::pop()
     this->m_data.pop_back();
     this->m_beg.pop_back();
     this->m_end.pop_back();
+    this->m_views.pop_back();
+    this->m_is_view.pop_back();
     this->m_tokens.pop_back();
 }
 
@@ -561,6 +590,15 @@ bool Tokenizer::parse()
 
     // NOTE 不同元素(Token)之间，必须要有空白符，或者括号，作为间隔！
 
+    if (this->m_is_view.back()) {
+        if (!varlisp::detail::scan_token(this->m_views.back(), this->tok)) {
+            return false;
+        }
+        this->m_tokens.back().push_back(this->tok);
+        this->tok = varlisp::empty();
+        return true;
+    }
+
     while (m_beg.back() < m_end.back() && std::isspace(*m_beg.back())) {
         m_beg.back()++;
     }
@@ -595,6 +633,8 @@ void Tokenizer::clear()
     this->m_data.back().clear();
     this->m_beg.back() = this->m_data.back().begin();
     this->m_end.back() = this->m_data.back().end();
+    this->m_views.back() = sss::string_view();
+    this->m_is_view.back() = false;
     this->m_tokens.back().clear();
 }
 
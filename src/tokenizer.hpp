@@ -12,6 +12,7 @@
 #include <ss1x/parser/oparser.hpp>
 
 #include <sss/raw_print.hpp>
+#include <sss/string_view.hpp>
 #include <sss/util/PostionThrow.hpp>
 
 #include "regex_t.hpp"
@@ -180,6 +181,8 @@ public:
 
 //public:
     void    push(const std::string& data = "");
+    // 以只读视图压栈；data的有效期，须长于该帧(比如mmap的脚本文件)
+    void    push_view(sss::string_view data);
     void    pop();
 
 protected:
@@ -191,6 +194,9 @@ private:
     std::vector<std::string>    m_data;
     std::vector<StrIterator>    m_beg;
     std::vector<StrIterator>    m_end;
+    // 视图帧，由detail::scan_token解析，不拷贝源码
+    std::vector<sss::string_view> m_views;
+    std::vector<bool>           m_is_view;
 
     Token               tok;
     std::string         str_stack;
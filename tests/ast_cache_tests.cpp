@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "interpreter.hpp"
+#include "parser.hpp"
+#include "detail/ast_cache.hpp"
+#include "detail/object_codec.hpp"
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream ifs(path.c_str(), std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs),
+                       std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::string& content)
+{
+    std::ofstream ofs(path.c_str(), std::ios_base::binary | std::ios_base::trunc);
+    ofs.write(content.data(), content.size());
+}
+
+// 同ast_cache.cpp中的cache_file_path()
+std::string cache_file_of(const std::string& cache_dir, const std::string& script)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ast",
+                  static_cast<unsigned long long>(varlisp::detail::codec::hash(script)));
+    return cache_dir + "/" + name;
+}
+
+}  // namespace
+
+TEST(detail_ast_cache, round_trip_and_header_mismatch)
+{
+    namespace ast_cache = varlisp::detail::ast_cache;
+
+    char dir[] = "/tmp/varlisp-ast-XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    const std::string cache_dir = std::string(dir) + "/cache";
+    const std::string script = std::string(dir) + "/a.lisp";
+    write_file(script,
+               "(define ast-cache-x (+ 1 2))\n"
+               "(define ast-cache-re /a+b/)\n");
+
+    auto& env = varlisp::Interpreter::get_instance().get_env();
+    env["path-to-ast-cache"] = varlisp::string_t(cache_dir);
+    varlisp::Parser parser;
+
+    auto load_and_check = [&]() {
+        env.erase("ast-cache-x");
+        env.erase("ast-cache-re");
+        ast_cache::load(parser, env, script, true);
+        const auto * p_x = env.find("ast-cache-x");
+        ASSERT_NE(p_x, nullptr);
+        GTEST_ASSERT_EQ(boost::get<int64_t>(*p_x), 3);
+        const auto * p_re = env.find("ast-cache-re");
+        ASSERT_NE(p_re, nullptr);
+        GTEST_ASSERT_EQ(boost::get<varlisp::regex_t>(*p_re)->pattern(), "a+b");
+    };
+
+    const auto before = ast_cache::get_stat();
+    load_and_check();
+    GTEST_ASSERT_EQ(ast_cache::get_stat().misses, before.misses + 1);
+    GTEST_ASSERT_EQ(ast_cache::get_stat().stores, before.stores + 1);
+
+    // 第二次直接使用缓存
+    load_and_check();
+    GTEST_ASSERT_EQ(ast_cache::get_stat().hits, before.hits + 1);
+
+    const std::string cache_file = cache_file_of(cache_dir, script);
+    std::string head = read_file(cache_file);
+    ASSERT_GT(head.size(), 24U);
+
+    // 字节序标记不一致(magic之后的4字节)：未命中，并重写缓存
+    std::swap(head[8], head[11]);
+    write_file(cache_file, head);
+    load_and_check();
+    GTEST_ASSERT_EQ(ast_cache::get_stat().misses, before.misses + 2);
+    GTEST_ASSERT_EQ(ast_cache::get_stat().stores, before.stores + 2);
+
+    // 构建指纹不一致(magic、字节序标记、ast_version之后的8字节)：未命中
+    head = read_file(cache_file);
+    head[16] = char(~head[16]);
+    write_file(cache_file, head);
+    load_and_check();
+    GTEST_ASSERT_EQ(ast_cache::get_stat().misses, before.misses + 3);
+
+    load_and_check();
+    GTEST_ASSERT_EQ(ast_cache::get_stat().hits, before.hits + 2);
+
+    env.erase("ast-cache-x");
+    env.erase("ast-cache-re");
+    env.erase("path-to-ast-cache");
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "detail/buffered_reader.hpp"
+
+namespace {
+
+// 写入content后，返回读端fd
+int make_pipe(const std::string& content)
+{
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return -1;
+    }
+    ::write(fds[1], content.data(), content.size());
+    ::close(fds[1]);
+    return fds[0];
+}
+
+std::string to_string(sss::string_view s)
+{
+    return std::string(s.data(), s.size());
+}
+
+}  // namespace
+
+TEST(detail_buffered_reader, next_line)
+{
+    int fd = make_pipe("abc\n\nlast");
+    ASSERT_NE(fd, -1);
+    // 缓冲区小于行长，需要扩容
+    varlisp::detail::buffered_reader_t reader(fd, 2);
+    sss::string_view line;
+    ASSERT_TRUE(reader.next_line(line));
+    GTEST_ASSERT_EQ(to_string(line), "abc");
+    ASSERT_TRUE(reader.next_line(line));
+    GTEST_ASSERT_EQ(to_string(line), "");
+    ASSERT_TRUE(reader.next_line(line));
+    GTEST_ASSERT_EQ(to_string(line), "last");
+    ASSERT_FALSE(reader.next_line(line));
+    ASSERT_TRUE(reader.eof());
+    ::close(fd);
+}
+
+TEST(detail_buffered_reader, next_byte)
+{
+    int fd = make_pipe("a\nb");
+    ASSERT_NE(fd, -1);
+    varlisp::detail::buffered_reader_t reader(fd, 16);
+    GTEST_ASSERT_EQ(reader.next_byte(), 'a');
+    GTEST_ASSERT_EQ(reader.pending(), 2U);
+    sss::string_view line;
+    ASSERT_TRUE(reader.next_line(line));
+    GTEST_ASSERT_EQ(to_string(line), "");
+    GTEST_ASSERT_EQ(reader.next_byte(), 'b');
+    GTEST_ASSERT_EQ(reader.next_byte(), -1);
+    ::close(fd);
+}
+
+TEST(detail_buffered_reader, read_error_throws)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ::close(fds[0]);
+    // 写端不可读：EBADF 不能当作文件结尾
+    varlisp::detail::buffered_reader_t reader(fds[1], 16);
+    sss::string_view line;
+    EXPECT_THROW(reader.next_line(line), std::runtime_error);
+    EXPECT_THROW(reader.next_byte(), std::runtime_error);
+    ::close(fds[1]);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "builtin.hpp"
+#include "Define.hpp"
+#include "environment.hpp"
+#include "detail/buitin_info_t.hpp"
+
+TEST(detail_builtin_lookup, not_stored_in_root_env)
+{
+    varlisp::Environment env_root;
+    varlisp::Builtin::regist_builtin_function(env_root);
+    const varlisp::Environment& env = env_root;
+    // 根环境只放常量；内建函数经由完美hash表查找
+    ASSERT_EQ(env.find("car"), nullptr);
+    ASSERT_NE(env.find("O_RDONLY"), nullptr);
+
+    const varlisp::Object * p_car = env.deep_find("car");
+    ASSERT_NE(p_car, nullptr);
+    const auto * p_builtin = boost::get<varlisp::Builtin>(p_car);
+    ASSERT_NE(p_builtin, nullptr);
+    GTEST_ASSERT_EQ(p_builtin->type(), varlisp::detail::find_builtin("car"));
+    GTEST_ASSERT_EQ(env.deep_find("no-such-builtin-name"), nullptr);
+}
+
+TEST(detail_builtin_lookup, user_definition_shadows_builtin)
+{
+    varlisp::Environment env;
+    env.insert("car", int64_t(1));
+    const varlisp::Object * p_car = env.deep_find("car");
+    ASSERT_NE(p_car, nullptr);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*p_car), 1);
+
+    // 删除同名定义后，内建函数重新可见；内建函数本身不可删除
+    ASSERT_TRUE(env.erase("car"));
+    ASSERT_NE(boost::get<varlisp::Builtin>(env.deep_find("car")), nullptr);
+    EXPECT_THROW(env.erase("car"), std::runtime_error);
+}
+
+TEST(detail_builtin_lookup, writable_access_copies_into_root_env)
+{
+    varlisp::Environment root;
+    varlisp::Environment inner(&root);
+    const varlisp::Object * p_table = varlisp::detail::find_builtin_object("car");
+    ASSERT_NE(p_table, nullptr);
+
+    // 可写访问：在根环境中放一份常量条目，而不是返回只读表中的对象
+    varlisp::Object * p_car = inner.deep_find("car");
+    ASSERT_NE(p_car, nullptr);
+    ASSERT_NE(p_car, p_table);
+    GTEST_ASSERT_EQ(root.find("car"), p_car);
+    GTEST_ASSERT_EQ(inner.find("car"), nullptr);
+    EXPECT_THROW(inner.erase("car"), std::runtime_error);
+
+    // 改写只作用于该环境链
+    *p_car = int64_t(3);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*inner.deep_find("car")), 3);
+    varlisp::Environment other;
+    ASSERT_NE(boost::get<varlisp::Builtin>(other.deep_find("car")), nullptr);
+    ASSERT_NE(boost::get<varlisp::Builtin>(p_table), nullptr);
+}
+
+TEST(detail_builtin_lookup, define_needs_force_to_shadow_builtin)
+{
+    varlisp::Environment env;
+    varlisp::Define(varlisp::symbol("car"), varlisp::Object(int64_t(1))).eval(env);
+    GTEST_ASSERT_EQ(env.find("car"), nullptr);
+    ASSERT_NE(boost::get<varlisp::Builtin>(env.deep_find("car")), nullptr);
+
+    varlisp::Environment forced;
+    varlisp::Define(varlisp::symbol("car"), varlisp::Object(int64_t(1)), varlisp::Object(true))
+        .eval(forced);
+    ASSERT_NE(forced.find("car"), nullptr);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*forced.deep_find("car")), 1);
+}
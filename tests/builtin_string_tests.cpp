@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <sss/spliter.hpp>
+
+#include <string>
+#include <vector>
+
+#include "interpreter.hpp"
+#include "parser.hpp"
+
+namespace {
+
+// (split src ",") 的结果
+std::vector<std::string> split_by_builtin(const std::string& src)
+{
+    auto& env = varlisp::Interpreter::get_instance().get_env();
+    varlisp::Parser parser;
+    env["split-src"] = varlisp::string_t(src);
+    parser.parse(env, "(define split-ret (split split-src \",\"))", true);
+
+    std::vector<std::string> out;
+    const auto * p_ret = env.find("split-ret");
+    EXPECT_NE(p_ret, nullptr);
+    const auto * p_list = p_ret ? boost::get<varlisp::List>(p_ret) : nullptr;
+    const auto * p_items = p_list ? p_list->unquoteType<varlisp::List>() : nullptr;
+    EXPECT_NE(p_items, nullptr);
+    if (p_items) {
+        for (const auto& item : *p_items) {
+            out.push_back(boost::get<varlisp::string_t>(item).to_string());
+        }
+    }
+    env.erase("split-src");
+    env.erase("split-ret");
+    return out;
+}
+
+// sss::ViewSpliter::fetch_next 的结果；split 不应改变其语义
+std::vector<std::string> split_by_spliter(const std::string& src)
+{
+    std::vector<std::string> out;
+    sss::ViewSpliter<char> sp(src, ',');
+    sss::string_view stem;
+    while (sp.fetch_next(stem)) {
+        out.push_back(stem.to_string());
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(builtin_string, split_adjacent_separators)
+{
+    GTEST_ASSERT_EQ(split_by_builtin("a,b,c"), (std::vector<std::string>{"a", "b", "c"}));
+    // 连续、开头、结尾的分隔符
+    for (const char * src : {"a,,b", ",a,b", "a,b,", ",,a,,,b,,", ",", ",,", ""}) {
+        GTEST_ASSERT_EQ(split_by_builtin(src), split_by_spliter(src)) << "source: `" << src << "`";
+    }
+}
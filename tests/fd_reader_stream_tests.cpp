@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <re2/re2.h>
+
+#include "detail/digest.hpp"
+#include "detail/file.hpp"
+#include "detail/io.hpp"
+#include "detail/regex_stream.hpp"
+
+namespace {
+
+// 首行之后的内容；需大于管道缓冲，以便读写交错
+std::string make_content()
+{
+    std::string content = "line1\n";
+    for (int i = 0; i < 20000; ++i) {
+        content += "row ";
+        content += std::to_string(i);
+        content += '\n';
+    }
+    return content;
+}
+
+void write_all(int fd, const std::string& content)
+{
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t ec = ::write(fd, content.data() + offset, content.size() - offset);
+        if (ec <= 0) {
+            break;
+        }
+        offset += size_t(ec);
+    }
+}
+
+// 返回读端；写端由后台线程写完后关闭
+int make_pipe(const std::string& content, std::thread& writer)
+{
+    int fds[2];
+    if (::pipe(fds) == -1) {
+        return -1;
+    }
+    writer = std::thread([fds, &content]() {
+        write_all(fds[1], content);
+        ::close(fds[1]);
+    });
+    return fds[0];
+}
+
+int make_file(const std::string& content)
+{
+    char path[] = "/tmp/varlisp-fd-XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd == -1) {
+        return -1;
+    }
+    ::unlink(path);
+    write_all(fd, content);
+    ::lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+// 模拟 (read-line fd)：经由per-fd读缓冲读取一行
+std::string read_line(int fd)
+{
+    sss::string_view line;
+    EXPECT_TRUE(varlisp::detail::file::get_reader(fd).next_line(line));
+    return std::string(line.data(), line.size());
+}
+
+std::string scan_all(int fd)
+{
+    std::string rebuilt;
+    RE2 re("[0-9]+");
+    varlisp::detail::regex_stream_scan(
+        fd, re, 1, varlisp::detail::regex_stream_option_t{},
+        [&rebuilt](sss::string_view text) { rebuilt.append(text.data(), text.size()); },
+        [&rebuilt](const re2::StringPiece* subs, size_t) {
+            rebuilt.append(subs[0].data(), subs[0].size());
+        });
+    return rebuilt;
+}
+
+}  // namespace
+
+TEST(detail_fd_reader_stream, read_fd_drains_pending_bytes)
+{
+    const std::string content = make_content();
+    std::thread writer;
+    int fd = make_pipe(content, writer);
+    ASSERT_NE(fd, -1);
+
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    ASSERT_GT(varlisp::detail::file::get_reader(fd).pending(), 0U);
+
+    // 管道不能退回内核；sync_reader 之后，未消费的数据仍然可读
+    varlisp::detail::file::sync_reader(fd);
+    std::string rest;
+    char buf[1000];
+    int64_t ec = 0;
+    while ((ec = varlisp::detail::file::read_fd(fd, buf, sizeof(buf))) > 0) {
+        rest.append(buf, size_t(ec));
+    }
+    writer.join();
+    GTEST_ASSERT_EQ(rest, content.substr(6));
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+}
+
+TEST(detail_fd_reader_stream, readall_pipe_after_read_line)
+{
+    const std::string content = make_content();
+    std::thread writer;
+    int fd = make_pipe(content, writer);
+    ASSERT_NE(fd, -1);
+
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    varlisp::detail::file::sync_reader(fd);
+    std::string rest = varlisp::detail::readall(fd);
+    writer.join();
+    GTEST_ASSERT_EQ(rest, content.substr(6));
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+}
+
+TEST(detail_fd_reader_stream, digest_after_read_line)
+{
+    namespace digest = varlisp::detail::digest;
+    const std::string content = make_content();
+    const std::vector<digest::algo_t> algos{digest::algo_sha256};
+    const auto expect = digest::digest_view(sss::string_view(content.data() + 6, content.size() - 6), algos);
+
+    std::thread writer;
+    int fd = make_pipe(content, writer);
+    ASSERT_NE(fd, -1);
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    varlisp::detail::file::sync_reader(fd);
+    int64_t size = 0;
+    EXPECT_EQ(digest::digest_fd(fd, algos, &size), expect);
+    writer.join();
+    GTEST_ASSERT_EQ(size, int64_t(content.size() - 6));
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+
+    // 普通文件：退回偏移后，直接从fd读取
+    fd = make_file(content);
+    ASSERT_NE(fd, -1);
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    varlisp::detail::file::sync_reader(fd);
+    GTEST_ASSERT_EQ(::lseek(fd, 0, SEEK_CUR), 6);
+    EXPECT_EQ(digest::digest_fd(fd, algos), expect);
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+}
+
+TEST(detail_fd_reader_stream, regex_stream_after_read_line)
+{
+    const std::string content = make_content();
+
+    std::thread writer;
+    int fd = make_pipe(content, writer);
+    ASSERT_NE(fd, -1);
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    varlisp::detail::file::sync_reader(fd);
+    std::string rebuilt = scan_all(fd);
+    writer.join();
+    GTEST_ASSERT_EQ(rebuilt, content.substr(6));
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+
+    fd = make_file(content);
+    ASSERT_NE(fd, -1);
+    GTEST_ASSERT_EQ(read_line(fd), "line1");
+    varlisp::detail::file::sync_reader(fd);
+    GTEST_ASSERT_EQ(scan_all(fd), content.substr(6));
+    varlisp::detail::file::drop_reader(fd);
+    ::close(fd);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "environment.hpp"
+#include "list.hpp"
+#include "detail/heap_image.hpp"
+
+namespace {
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream ifs(path.c_str(), std::ios_base::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs),
+                       std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::string& content)
+{
+    std::ofstream ofs(path.c_str(), std::ios_base::binary | std::ios_base::trunc);
+    ofs.write(content.data(), content.size());
+}
+
+}  // namespace
+
+TEST(detail_heap_image, save_restore_round_trip)
+{
+    char dir[] = "/tmp/varlisp-img-XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    const std::string path = std::string(dir) + "/env.img";
+
+    varlisp::Environment env;
+    env.insert("img-x", int64_t(42));
+    env.insert("img-pi", 3.5, true);
+    env.insert("img-s", varlisp::string_t(std::string("hello")));
+    env.insert("img-l", varlisp::List::makeSQuoteList(int64_t(1), int64_t(2)));
+    GTEST_ASSERT_EQ(varlisp::detail::image::save(env, path), 4);
+
+    varlisp::Environment restored;
+    GTEST_ASSERT_EQ(varlisp::detail::image::restore(restored, path), 4);
+    GTEST_ASSERT_EQ(restored.size(), 4U);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*restored.find("img-x")), 42);
+    GTEST_ASSERT_EQ(boost::get<double>(*restored.find("img-pi")), 3.5);
+    GTEST_ASSERT_EQ(boost::get<varlisp::string_t>(*restored.find("img-s")),
+                    varlisp::string_t(std::string("hello")));
+    GTEST_ASSERT_EQ(boost::get<varlisp::List>(*restored.find("img-l")),
+                    varlisp::List::makeSQuoteList(int64_t(1), int64_t(2)));
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+}
+
+TEST(detail_heap_image, corrupt_image_leaves_env_untouched)
+{
+    char dir[] = "/tmp/varlisp-img-XXXXXX";
+    ASSERT_NE(::mkdtemp(dir), nullptr);
+    const std::string path = std::string(dir) + "/env.img";
+
+    varlisp::Environment env;
+    env.insert("img-x", int64_t(42));
+    env.insert("img-s", varlisp::string_t(std::string("hello")));
+    ASSERT_EQ(varlisp::detail::image::save(env, path), 2);
+
+    // 截断：解码到一半失败
+    std::string data = read_file(path);
+    write_file(path, data.substr(0, data.size() - 3));
+
+    varlisp::Environment restored;
+    EXPECT_THROW(varlisp::detail::image::restore(restored, path), std::runtime_error);
+    GTEST_ASSERT_EQ(restored.size(), 0U);
+
+    // 不是镜像文件
+    write_file(path, "(define x 1)");
+    EXPECT_THROW(varlisp::detail::image::restore(restored, path), std::runtime_error);
+    GTEST_ASSERT_EQ(restored.size(), 0U);
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+}
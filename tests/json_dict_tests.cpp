@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "object.hpp"
+#include "builtin_helper.hpp"
+#include "json/parser.hpp"
+
+TEST(json_dict, parse_keeps_insertion_order)
+{
+    varlisp::Object obj = varlisp::json::parse(R"({"b": 1, "a": "x", "c": [1, 2]})");
+    const auto * p_dict = boost::get<varlisp::Dict>(&obj);
+    ASSERT_NE(p_dict, nullptr);
+    std::vector<std::string> keys;
+    for (const auto& item : *p_dict) {
+        keys.push_back(item.first.to_string());
+    }
+    GTEST_ASSERT_EQ(keys, (std::vector<std::string>{"b", "a", "c"}));
+}
+
+TEST(json_dict, environment_consumers_accept_dict)
+{
+    varlisp::Environment env;
+    varlisp::Object tmp;
+    varlisp::Object obj = varlisp::json::parse(R"({"User-Agent": "varlisp", "Accept": "*/*"})");
+    const auto view = varlisp::getEnvironmentOrDict(env, obj, tmp);
+    ASSERT_TRUE(view);
+    // 直接引用dict本身，不转换为Environment
+    GTEST_ASSERT_EQ(view.p_dict, boost::get<varlisp::Dict>(&obj));
+    GTEST_ASSERT_EQ(view.p_env, nullptr);
+    const auto * p_value = view.find("User-Agent");
+    ASSERT_NE(p_value, nullptr);
+    const auto * p_str = boost::get<varlisp::string_t>(p_value);
+    ASSERT_NE(p_str, nullptr);
+    GTEST_ASSERT_EQ(p_str->to_string(), "varlisp");
+
+    std::vector<std::string> keys;
+    view.for_each([&keys](sss::string_view key, const varlisp::Object&) { keys.push_back(key.to_string()); });
+    GTEST_ASSERT_EQ(keys, (std::vector<std::string>{"User-Agent", "Accept"}));
+
+    varlisp::Environment ctx;
+    ctx["k"] = int64_t(1);
+    varlisp::Object ctx_obj{ctx};
+    const auto ctx_view = varlisp::getEnvironmentOrDict(env, ctx_obj, tmp);
+    ASSERT_NE(ctx_view.p_env, nullptr);
+    ASSERT_NE(ctx_view.find("k"), nullptr);
+
+    varlisp::Object num{int64_t(1)};
+    EXPECT_FALSE(varlisp::getEnvironmentOrDict(env, num, tmp));
+    EXPECT_THROW(varlisp::requireEnvironmentOrDict(env, num, tmp, "test", 0,
+                                                   varlisp::debug_info_t{__FILE__, __func__, __LINE__}),
+                 std::runtime_error);
+}
+
+TEST(json_dict, intern_mode_shares_long_keys)
+{
+    varlisp::Object obj = varlisp::json::parse(
+        R"([{"a-rather-long-key-name": "a-rather-long-string-value", "id": 1},
+            {"a-rather-long-key-name": "a-rather-long-string-value", "id": 2}])",
+        true);
+    const auto * p_list = boost::get<varlisp::List>(&obj);
+    ASSERT_NE(p_list, nullptr);
+    std::vector<const varlisp::Dict*> dicts;
+    for (const auto& item : *p_list->get_slist()) {
+        dicts.push_back(boost::get<varlisp::Dict>(&item));
+        ASSERT_NE(dicts.back(), nullptr);
+    }
+    ASSERT_EQ(dicts.size(), 2U);
+    const auto& lhs = *dicts[0]->begin();
+    const auto& rhs = *dicts[1]->begin();
+    EXPECT_TRUE(lhs.first.is_interned());
+    EXPECT_EQ(lhs.first.data(), rhs.first.data());
+    EXPECT_EQ(boost::get<varlisp::string_t>(lhs.second).data(),
+              boost::get<varlisp::string_t>(rhs.second).data());
+    // 短键存放在对象内部
+    EXPECT_TRUE(std::next(dicts[0]->begin())->first.is_local());
+    ASSERT_NE(dicts[1]->find("id"), nullptr);
+}
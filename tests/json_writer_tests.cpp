@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <sstream>
+
+#include "object.hpp"
+#include "json/writer.hpp"
+#include "json_print_visitor.hpp"
+
+namespace {
+
+std::string visitor_string(const varlisp::Object& obj)
+{
+    std::ostringstream oss;
+    boost::apply_visitor(varlisp::json_print_visitor(oss, false), obj);
+    return oss.str();
+}
+
+}  // namespace
+
+TEST(json_writer, double_same_as_visitor)
+{
+    for (double v : {0.0, 1.0, -2.5, 0.1 + 0.2, 1.0 / 3, 123456789.0, 1e20, 1e-7, 100000.0, 1000000.0}) {
+        varlisp::Object obj{v};
+        GTEST_ASSERT_EQ(varlisp::json::to_string(obj), visitor_string(obj));
+    }
+    GTEST_ASSERT_EQ(varlisp::json::to_string(varlisp::Object{0.1 + 0.2}), "0.3");
+    GTEST_ASSERT_EQ(varlisp::json::to_string(varlisp::Object{123456789.0}), "1.23457e+08");
+}
+
+TEST(json_writer, non_finite_double_is_null)
+{
+    GTEST_ASSERT_EQ(varlisp::json::to_string(varlisp::Object{std::numeric_limits<double>::infinity()}), "null");
+    GTEST_ASSERT_EQ(varlisp::json::to_string(varlisp::Object{std::numeric_limits<double>::quiet_NaN()}), "null");
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "object.hpp"
+#include "detail/object_codec.hpp"
+#include "detail/regex_cache.hpp"
+
+namespace {
+
+varlisp::Object round_trip(const varlisp::Object& obj)
+{
+    std::string data;
+    varlisp::detail::codec::encode(data, obj);
+    varlisp::detail::codec::reader_t reader(sss::string_view(data.data(), data.size()));
+    varlisp::Object ret = reader.decode();
+    EXPECT_TRUE(reader.empty());
+    return ret;
+}
+
+}  // namespace
+
+TEST(detail_object_codec, literals_round_trip)
+{
+    GTEST_ASSERT_EQ(boost::get<int64_t>(round_trip(int64_t(-7))), -7);
+    GTEST_ASSERT_EQ(boost::get<double>(round_trip(2.5)), 2.5);
+    GTEST_ASSERT_EQ(boost::get<bool>(round_trip(true)), true);
+    GTEST_ASSERT_EQ(boost::get<varlisp::string_t>(round_trip(varlisp::string_t(std::string("text")))),
+                    varlisp::string_t(std::string("text")));
+    GTEST_ASSERT_EQ(boost::get<varlisp::symbol>(round_trip(varlisp::symbol("sym"))).name(), "sym");
+
+    auto list = varlisp::List::makeSQuoteList(int64_t(1), varlisp::string_t(std::string("two")));
+    GTEST_ASSERT_EQ(boost::get<varlisp::List>(round_trip(list)), list);
+
+    varlisp::Dict dict;
+    dict.insert("b", int64_t(2));
+    dict.insert("a", int64_t(1));
+    auto decoded = boost::get<varlisp::Dict>(round_trip(dict));
+    GTEST_ASSERT_EQ(decoded.size(), 2U);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*decoded.find("a")), 1);
+    GTEST_ASSERT_EQ(boost::get<int64_t>(*decoded.find("b")), 2);
+}
+
+TEST(detail_object_codec, regex_keeps_flags)
+{
+    namespace regex_cache = varlisp::detail::regex_cache;
+    const uint32_t flags = regex_cache::flag_case_insensitive | regex_cache::flag_dot_nl |
+                           regex_cache::flag_longest_match;
+    varlisp::regex_t reg = regex_cache::get("a.c", flags);
+
+    auto decoded = boost::get<varlisp::regex_t>(round_trip(reg));
+    ASSERT_TRUE(decoded);
+    GTEST_ASSERT_EQ(decoded->pattern(), "a.c");
+    GTEST_ASSERT_EQ(regex_cache::flags_of(decoded->options()), flags);
+    EXPECT_TRUE(RE2::FullMatch("A\nC", *decoded));
+
+    varlisp::regex_t literal = regex_cache::get("a.c", regex_cache::flag_literal);
+    auto decoded_literal = boost::get<varlisp::regex_t>(round_trip(literal));
+    EXPECT_TRUE(RE2::FullMatch("a.c", *decoded_literal));
+    EXPECT_FALSE(RE2::FullMatch("abc", *decoded_literal));
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <re2/re2.h>
+
+#include "detail/regex_stream.hpp"
+
+namespace {
+
+// 写入临时文件后，返回读端fd
+int make_file(const std::string& content)
+{
+    char path[] = "/tmp/varlisp-rs-XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd == -1) {
+        return -1;
+    }
+    ::unlink(path);
+    size_t offset = 0;
+    while (offset < content.size()) {
+        ssize_t ec = ::write(fd, content.data() + offset, content.size() - offset);
+        if (ec <= 0) {
+            ::close(fd);
+            return -1;
+        }
+        offset += size_t(ec);
+    }
+    ::lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+struct scan_result_t
+{
+    int64_t     count = 0;
+    std::string rebuilt;    // 未匹配文本 + 匹配文本，按顺序拼接
+    std::string matches;    // 各匹配，以','分隔
+};
+
+scan_result_t scan(const std::string& content, const RE2& re,
+                   const varlisp::detail::regex_stream_option_t& opt)
+{
+    scan_result_t ret;
+    int fd = make_file(content);
+    EXPECT_NE(fd, -1);
+    ret.count = varlisp::detail::regex_stream_scan(
+        fd, re, 1, opt,
+        [&ret](sss::string_view text) { ret.rebuilt.append(text.data(), text.size()); },
+        [&ret](const re2::StringPiece* subs, size_t) {
+            ret.rebuilt.append(subs[0].data(), subs[0].size());
+            ret.matches.append(subs[0].data(), subs[0].size());
+            ret.matches += ',';
+        });
+    ::close(fd);
+    return ret;
+}
+
+}  // namespace
+
+TEST(detail_regex_stream, many_matches_across_chunks)
+{
+    // 约4MB，每行一个数字；匹配数远大于块数
+    std::string content;
+    std::string expect;
+    for (int i = 0; i < 400000; ++i) {
+        std::string num = std::to_string(i);
+        content += "row ";
+        content += num;
+        content += '\n';
+        expect += num;
+        expect += ',';
+    }
+    RE2 re("[0-9]+");
+
+    varlisp::detail::regex_stream_option_t small;
+    small.chunk_size = 4096;
+    small.max_match = 16;
+    auto ret = scan(content, re, small);
+    GTEST_ASSERT_EQ(ret.count, 400000);
+    GTEST_ASSERT_EQ(ret.rebuilt, content);
+    GTEST_ASSERT_EQ(ret.matches, expect);
+
+    // 默认块大小：大部分匹配都不触发续读
+    ret = scan(content, re, varlisp::detail::regex_stream_option_t{});
+    GTEST_ASSERT_EQ(ret.count, 400000);
+    GTEST_ASSERT_EQ(ret.rebuilt, content);
+    GTEST_ASSERT_EQ(ret.matches, expect);
+}
+
+TEST(detail_regex_stream, match_straddling_chunk_boundary)
+{
+    // 匹配跨越块边界时，须续读后再匹配，而不是被截断
+    varlisp::detail::regex_stream_option_t opt;
+    opt.chunk_size = 8;
+    opt.max_match = 8;
+    std::string content = "xxxxxxabcdefxxxxxxabcdef";
+    RE2 re("abcdef");
+    auto ret = scan(content, re, opt);
+    GTEST_ASSERT_EQ(ret.count, 2);
+    GTEST_ASSERT_EQ(ret.matches, "abcdef,abcdef,");
+    GTEST_ASSERT_EQ(ret.rebuilt, content);
+}
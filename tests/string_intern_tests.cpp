@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "String.hpp"
+
+namespace {
+
+// 两段内容相同、但偏移不同；都长于local_capacity，substr共享缓冲区
+const std::string twice = "abcdefghijklmnopqrstuvwxyz-abcdefghijklmnopqrstuvwxyz";
+
+}  // namespace
+
+TEST(string_intern, substr_of_interned_is_not_interned)
+{
+    varlisp::string_t whole = varlisp::string_t::intern(twice);
+    ASSERT_TRUE(whole.is_interned());
+
+    varlisp::string_t left = whole.substr(0, 26);
+    varlisp::string_t right = whole.substr(27, 26);
+    ASSERT_FALSE(left.is_local());
+    ASSERT_FALSE(right.is_local());
+    EXPECT_FALSE(left.is_interned());
+    EXPECT_FALSE(right.is_interned());
+
+    // 指针不同、内容相同
+    ASSERT_NE(left.data(), right.data());
+    EXPECT_TRUE(left == right);
+    EXPECT_FALSE(left != right);
+}
+
+TEST(string_intern, equality_between_interned_and_substr)
+{
+    varlisp::string_t whole = varlisp::string_t::intern(twice);
+    varlisp::string_t right = whole.substr(27, 26);
+
+    varlisp::string_t key = varlisp::string_t::intern(right.to_string_view());
+    ASSERT_TRUE(key.is_interned());
+    EXPECT_TRUE(key == right);
+    EXPECT_TRUE(right == key);
+    // 再次驻留，得到同一缓冲区
+    EXPECT_EQ(varlisp::string_t::intern(whole.substr(0, 26).to_string_view()).data(), key.data());
+
+    // 整个缓冲区上的substr，仍是驻留串
+    EXPECT_TRUE(whole.substr(0).is_interned());
+    EXPECT_TRUE(whole.substr(0) == whole);
+}
+
+TEST(string_intern, interned_strings_compare_by_pointer)
+{
+    varlisp::string_t a = varlisp::string_t::intern(twice);
+    varlisp::string_t b = varlisp::string_t::intern(std::string(twice));
+    std::string other = twice;
+    other.back() = 'Z';
+    varlisp::string_t c = varlisp::string_t::intern(other);
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_TRUE(a == b);
+    EXPECT_FALSE(a == c);
+}
+
+TEST(string_intern, short_strings_stay_local)
+{
+    // 不超过local_capacity的短串，不进驻留池，也不分配堆内存
+    varlisp::string_t a = varlisp::string_t::intern("active");
+    varlisp::string_t b = varlisp::string_t::intern(std::string("active"));
+    EXPECT_TRUE(a.is_local());
+    EXPECT_TRUE(b.is_local());
+    EXPECT_FALSE(a.is_interned());
+    EXPECT_TRUE(a == b);
+
+    const std::string edge(varlisp::string_t::local_capacity, 'x');
+    EXPECT_TRUE(varlisp::string_t::intern(edge).is_local());
+    EXPECT_TRUE(varlisp::string_t::intern(edge + "x").is_interned());
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "detail/string_kernel.hpp"
+
+namespace {
+
+namespace strkernel = varlisp::detail::strkernel;
+
+// 逐个ISA与std::string_view的结果比对
+void check_find(const std::string& text, const std::string& needle)
+{
+    const std::string_view ref(text);
+    const sss::string_view s(text.data(), text.size());
+    const sss::string_view q(needle.data(), needle.size());
+    for (int isa = strkernel::isa_scalar; isa <= strkernel::best_isa(); ++isa) {
+        strkernel::set_isa(strkernel::isa_t(isa));
+        EXPECT_EQ(strkernel::find(s, q), ref.find(needle))
+            << strkernel::isa_name(strkernel::isa_t(isa)) << " size=" << text.size() << " needle=" << needle;
+        EXPECT_EQ(strkernel::rfind(s, q), ref.rfind(needle))
+            << strkernel::isa_name(strkernel::isa_t(isa)) << " size=" << text.size() << " needle=" << needle;
+    }
+    strkernel::set_isa(strkernel::best_isa());
+}
+
+}  // namespace
+
+TEST(detail_string_kernel, find_matches_string_view)
+{
+    std::mt19937 rng(35);
+    // 小字母表，首尾字节频繁命中
+    for (size_t n : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 129, 300, 4096}) {
+        std::string text(n, 'a');
+        for (auto& c : text) {
+            c = "ab"[rng() % 2];
+        }
+        for (size_t k : {1, 2, 3, 5, 17, 40}) {
+            std::string needle(k, 'a');
+            for (auto& c : needle) {
+                c = "ab"[rng() % 2];
+            }
+            check_find(text, needle);
+            if (k <= n) {
+                check_find(text, text.substr(n - k));
+                check_find(text, text.substr(0, k));
+            }
+        }
+    }
+}
+
+TEST(detail_string_kernel, find_rare_first_byte)
+{
+    // 首字节罕见：经由memchr跳跃的路径；命中点分布在跳跃前后
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+        text += "the lazy dog ";
+    }
+    for (size_t at : {0UL, 7UL, 200UL, 1000UL, text.size() / 2, text.size() - 9}) {
+        std::string t = text;
+        t.replace(at, 9, "Zebra!Zed");
+        check_find(t, "Zebra!Zed");
+        check_find(t, "Zebra?");
+        check_find(t, "Zed");
+    }
+    check_find(text, "Zebra");
+    // 首字节常见、尾字节罕见
+    check_find(text, "the lazy cat");
+}
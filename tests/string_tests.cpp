@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+#include "String.hpp"
+
+TEST(string, construct_from_rvalue_takes_buffer)
+{
+    // 长于local_capacity，放在堆上；右值构造，不应复制内容
+    std::string html(200, 'x');
+    const char * p_data = html.data();
+    varlisp::string_t str(std::move(html));
+    EXPECT_EQ(str.data(), p_data);
+    EXPECT_EQ(str.size(), 200U);
+
+    std::string shorter = "short";
+    varlisp::string_t local(std::move(shorter));
+    EXPECT_TRUE(local.is_local());
+    EXPECT_TRUE(local == varlisp::string_t(std::string("short")));
+}
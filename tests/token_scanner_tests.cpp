@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tokenizer.hpp"
+#include "detail/token_scanner.hpp"
+
+namespace {
+
+// 记号序列的文本形式：类型序号 + 打印结果；出错时以"<error>"结尾
+std::vector<std::string> dump_tokens(varlisp::Tokenizer& t)
+{
+    std::vector<std::string> out;
+    try {
+        for (;;) {
+            varlisp::Token tok = t.top();
+            if (!tok.which()) {
+                break;
+            }
+            std::ostringstream oss;
+            oss << tok.which() << ':' << tok;
+            out.push_back(oss.str());
+            t.consume();
+        }
+    }
+    catch (std::exception&) {
+        out.push_back("<error>");
+    }
+    return out;
+}
+
+// ss1x规则(Token_p)的解析结果
+std::vector<std::string> by_rules(const std::string& src)
+{
+    varlisp::Tokenizer t(src);
+    return dump_tokens(t);
+}
+
+// detail::scan_token(视图帧)的解析结果
+std::vector<std::string> by_scanner(const std::string& src)
+{
+    varlisp::Tokenizer t;
+    t.push_view(sss::string_view(src.data(), src.size()));
+    return dump_tokens(t);
+}
+
+// 两条路径，必须得到相同的记号序列
+const char * const token_corpus[] = {
+    "(define (f x) (+ x -12 +7 3.5 1. -2.25 1.5e3 0x1F 0b101))",
+    "(1.) [2.] {0.}",
+    "#t #F #f #T",
+    "; comment\n a ;# multi\n line #; b\r\n",
+    "'(a b) '\"(raw \"str\")\"' 'sym",
+    "\"he\\\"llo\\n\\x41\\101\\u4e2d\\12\\456\\q\"",
+    "/a\\/b\\ c/ // (/ 4 2)",
+    "{k v} [1 2]",
+    "中文名 $x @y a:b:0 foo? set! <= -> - + -abc",
+    "(if #t (lambda (x) x))",
+    "",
+    "   \n\t ",
+    // 以下都应报错
+    "1.2.3",
+    "1abc",
+    "1.5x",
+    "0b",
+    "0b12",
+    "0xg",
+    "\"abc",
+    "\"a\"b",
+    "#x",
+    "a.b",
+    "/abc",
+    "//x",
+    "/a/b",
+    ";# unterminated",
+    "'\"(unterminated",
+};
+
+}  // namespace
+
+TEST(detail_token_scanner, same_as_token_rules)
+{
+    for (const char * src : token_corpus) {
+        GTEST_ASSERT_EQ(by_scanner(src), by_rules(src)) << "source: `" << src << "`";
+    }
+}
+
+TEST(detail_token_scanner, trailing_dot_double)
+{
+    std::string src = "1.";
+    sss::string_view view(src.data(), src.size());
+    varlisp::Token tok;
+    ASSERT_TRUE(varlisp::detail::scan_token(view, tok));
+    const auto * p_d = boost::get<double>(&tok);
+    ASSERT_NE(p_d, nullptr);
+    GTEST_ASSERT_EQ(*p_d, 1.0);
+    ASSERT_FALSE(varlisp::detail::scan_token(view, tok));
+}
+
+TEST(detail_token_scanner, unterminated_regex_throws)
+{
+    for (const char * src : {"/abc", "//x", "/a/b"}) {
+        std::string s = src;
+        sss::string_view view(s.data(), s.size());
+        varlisp::Token tok;
+        EXPECT_THROW(varlisp::detail::scan_token(view, tok), std::runtime_error) << src;
+    }
+}
+
+// '"(...)"' 原始字符串先于 ' 引号匹配；两条路径都应得到单个字符串记号
+TEST(detail_token_scanner, raw_string_before_quote)
+{
+    const std::string raw = "'\"(raw \"str\")\"'";
+    for (const auto& tokens : {by_rules(raw), by_scanner(raw)}) {
+        ASSERT_EQ(tokens.size(), 1U) << raw;
+        EXPECT_EQ(tokens.front(), by_rules("\"raw \\\"str\\\"\"").front());
+    }
+
+    // 非 '"( 开头时，' 仍是引号
+    for (const char * src : {"'sym", "'\"str\"", "'(a)"}) {
+        const auto tokens = by_rules(src);
+        ASSERT_GE(tokens.size(), 2U) << src;
+        EXPECT_EQ(tokens, by_scanner(src)) << src;
+        EXPECT_EQ(tokens.front(), by_rules("'").front()) << src;
+    }
+}